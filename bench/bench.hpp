@@ -0,0 +1,121 @@
+#ifndef TRIREME_BENCH_HPP
+#define TRIREME_BENCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace bench
+{
+    // A benchmark body performs its operation the given number of times.
+    using benchmark_function = std::function<void(std::size_t)>;
+
+    struct Benchmark
+    {
+        std::string name;
+        std::size_t iterations;
+        benchmark_function function;
+    };
+
+    // All benchmarks, in the order they were registered
+    std::vector<Benchmark>& registry();
+
+    inline void add(std::string name, std::size_t iterations, benchmark_function f)
+    {
+        registry().push_back({ name, iterations, f });
+    }
+
+    // Declare one of these at namespace scope to add a benchmark
+    struct Registrar
+    {
+        Registrar(std::string name, std::size_t iterations, benchmark_function f)
+        {
+            add(name, iterations, f);
+        }
+    };
+
+    /**
+     * @brief Keep the optimizer from discarding a computed value.
+     * 
+     * @param value Any value
+     */
+    template<typename T>
+    inline void do_not_optimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // Operands for the primitive benchmarks. There are a power of 2 of
+    // them, so indexing doesn't cost a division, and they're independent
+    // of each other, so we measure throughput rather than the latency of
+    // feeding one result into the next operation.
+    constexpr std::size_t operand_count { 1024 };
+    constexpr std::size_t operand_mask { operand_count - 1 };
+
+    /**
+     * @brief Pseudo-random values, evenly spread within +/- max_value.
+     * 
+     * @param max_value The largest magnitude to produce
+     * @return std::vector<int> operand_count values
+     */
+    inline std::vector<int> make_operands(int max_value)
+    {
+        std::vector<int> result;
+        std::uint32_t state { 2463534242u };
+
+        for (auto i = 0u; i < operand_count; ++i)
+        {
+            // xorshift32
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+
+            const auto span { 2 * static_cast<std::uint64_t>(max_value) + 1 };
+            result.push_back(static_cast<int>(state % span) - max_value);
+        }
+
+        return result;
+    }
+
+    // Operands within a hexad and a word, respectively
+    inline const std::vector<int>& hexad_operands()
+    {
+        static const auto operands { make_operands(364) };
+        return operands;
+    }
+
+    inline const std::vector<int>& word_operands()
+    {
+        static const auto operands { make_operands(193710244) };
+        return operands;
+    }
+
+    /**
+     * @brief Apply a unary operation n times, cycling through operands.
+     */
+    template<typename T, typename Op>
+    inline void run_unary(std::size_t n, const std::vector<T>& operands, Op op)
+    {
+        for (auto i = 0u; i < n; ++i)
+        {
+            do_not_optimize(op(operands[i & operand_mask]));
+        }
+    }
+
+    /**
+     * @brief Apply a binary operation n times. The right operand walks
+     * through the set at a different stride, so the pairs vary.
+     */
+    template<typename T, typename Op>
+    inline void run_binary(std::size_t n, const std::vector<T>& operands, Op op)
+    {
+        for (auto i = 0u; i < n; ++i)
+        {
+            do_not_optimize(op(operands[i & operand_mask], operands[(i * 7 + 3) & operand_mask]));
+        }
+    }
+}
+
+#endif /* TRIREME_BENCH_HPP */
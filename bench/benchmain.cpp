@@ -0,0 +1,109 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "bench.hpp"
+
+namespace bench
+{
+    std::vector<Benchmark>& registry()
+    {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+}
+
+namespace
+{
+    struct Measurement
+    {
+        std::string name;
+        std::size_t iterations;
+        double ns_per_op;
+    };
+
+    Measurement measure(const bench::Benchmark& b)
+    {
+        using clock = std::chrono::steady_clock;
+
+        // Warm up caches (and the emulator's decode cache) first
+        b.function(b.iterations / 10 + 1);
+
+        const auto start { clock::now() };
+        b.function(b.iterations);
+        const auto elapsed { std::chrono::duration<double>(clock::now() - start).count() };
+
+        return { b.name, b.iterations, elapsed * 1e9 / b.iterations };
+    }
+
+    void print_table(const Measurement& m)
+    {
+        std::cout << fmt::format("{0:<40} {1:>12} {2:>12.2f} ns/op {3:>14.0f} ops/s\n",
+            m.name, m.iterations, m.ns_per_op, 1e9 / m.ns_per_op);
+    }
+
+    void print_json(const std::vector<Measurement>& results)
+    {
+        std::cout << "{\n  \"benchmarks\": [\n";
+
+        for (auto i = 0u; i < results.size(); ++i)
+        {
+            const auto& m { results[i] };
+            std::cout << fmt::format(
+                "    {{ \"name\": \"{0}\", \"iterations\": {1}, \"ns_per_op\": {2:.3f}, \"ops_per_second\": {3:.0f} }}{4}\n",
+                m.name, m.iterations, m.ns_per_op, 1e9 / m.ns_per_op,
+                (i + 1 < results.size()) ? "," : "");
+        }
+
+        std::cout << "  ]\n}\n";
+    }
+}
+
+// Usage: trireme_bench [--json] [filter]
+// Runs every benchmark whose name contains the filter string. With
+// --json, the results are written as a single JSON object at the end,
+// for comparing runs across commits.
+int main(int argc, char** argv)
+{
+    auto json { false };
+    std::string filter;
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        const std::string arg { argv[i] };
+
+        if (arg == "--json")
+        {
+            json = true;
+        }
+        else
+        {
+            filter = arg;
+        }
+    }
+
+    std::vector<Measurement> results;
+
+    for (auto&& b : bench::registry())
+    {
+        if (b.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        results.push_back(measure(b));
+
+        if (!json)
+        {
+            print_table(results.back());
+        }
+    }
+
+    if (json)
+    {
+        print_json(results);
+    }
+}
@@ -0,0 +1,85 @@
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+#include "convert.hpp"
+
+// The conversions in convert.hpp, between integers, trit arrays and
+// base-27 strings. The array conversions are measured at several widths.
+
+namespace
+{
+    using bench::run_unary;
+
+    constexpr std::size_t iterations { 1000000 };
+    constexpr std::size_t string_iterations { 200000 };
+
+    template<std::size_t Size>
+    void register_width()
+    {
+        const auto suffix { "/" + std::to_string(Size) };
+
+        bench::add("convert/to_trits" + suffix, iterations, [](std::size_t n) {
+            run_unary(n, bench::word_operands(), [](int v) { return to_trits<int, Size>(v); });
+        });
+
+        bench::add("convert/to_decimal" + suffix, iterations, [](std::size_t n) {
+            static const auto arrays { [] {
+                std::vector<std::array<int, Size>> result;
+
+                for (auto v : bench::word_operands())
+                {
+                    result.push_back(to_trits<int, Size>(v));
+                }
+
+                return result;
+            }() };
+
+            run_unary(n, arrays, [](const std::array<int, Size>& a) { return to_decimal(a); });
+        });
+    }
+
+    const bool registered { [] {
+        register_width<6>();
+        register_width<12>();
+        register_width<18>();
+
+        bench::add("convert/hexad_to_trits", iterations, [](std::size_t n) {
+            run_unary(n, bench::hexad_operands(), [](int v) { return hexad_to_trits(v); });
+        });
+
+        bench::add("convert/hexad_to_string", string_iterations, [](std::size_t n) {
+            run_unary(n, bench::hexad_operands(), [](int v) { return hexad_to_string(v); });
+        });
+
+        bench::add("convert/hexad_to_trit_string", string_iterations, [](std::size_t n) {
+            run_unary(n, bench::hexad_operands(), [](int v) { return hexad_to_trit_string(v); });
+        });
+
+        bench::add("convert/triad_to_string", string_iterations, [](std::size_t n) {
+            run_unary(n, bench::hexad_operands(), [](int v) { return triad_to_string(v % 14); });
+        });
+
+        bench::add("convert/string_to_value", string_iterations, [](std::size_t n) {
+            static const auto strings { [] {
+                std::vector<std::string> result;
+
+                for (auto v : bench::hexad_operands())
+                {
+                    result.push_back(hexad_to_string(v));
+                }
+
+                return result;
+            }() };
+
+            run_unary(n, strings, [](const std::string& s) { return string_to_value(s); });
+        });
+
+        bench::add("convert/binary_to_ternary", iterations, [](std::size_t n) {
+            run_unary(n, bench::hexad_operands(), [](int v) { return binary_to_ternary(static_cast<unsigned int>(v + 364)); });
+        });
+
+        return true;
+    }() };
+}
@@ -0,0 +1,230 @@
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "cpu.hpp"
+#include "aot.hpp"
+#include "assembler/assembler.hpp"
+
+// Runs whole guest programs (see bench/guest) on the emulator, without
+// the shell, and reports how fast it retires instructions. Each program
+// is assembled, loaded at its own origin, and stepped until it executes
+// a BRK instruction.
+
+namespace
+{
+    struct GuestResult
+    {
+        std::string name;
+        unsigned long long instructions;
+        double seconds;
+        bool halted;
+
+        double mips() const { return (seconds > 0) ? instructions / seconds / 1e6 : 0; }
+    };
+
+    // Swallows everything written to it, so a program's debug output
+    // doesn't end up in the timing (or in the report)
+    class NullBuffer : public std::streambuf
+    {
+        protected:
+        int overflow(int c) override { return traits_type::not_eof(c); }
+    };
+
+    // Points a stream at another buffer until the end of the scope
+    class Redirect
+    {
+        public:
+        Redirect(std::ostream& s, std::streambuf* b): stream_(s), old_(s.rdbuf(b)) {}
+        ~Redirect() { stream_.rdbuf(old_); }
+
+        private:
+        std::ostream& stream_;
+        std::streambuf* old_;
+    };
+
+    std::string program_name(const std::string& path)
+    {
+        const auto slash { path.find_last_of("/\\") };
+        auto name { (slash == std::string::npos) ? path : path.substr(slash + 1) };
+        const auto dot { name.rfind('.') };
+
+        return (dot == std::string::npos || dot == 0) ? name : name.substr(0, dot);
+    }
+
+    // Compile a program ahead of time into the temporary directory
+    std::string build_image(const ternary::assembler::Assembler::data_map& data, const std::string& name)
+    {
+        const auto tmp { std::getenv("TMPDIR") };
+        const std::string dir { (tmp != nullptr && *tmp != '\0') ? tmp : "/tmp" };
+
+        return ternary::AotTranslator { data }.build(dir + "/trireme-aot-" + name);
+    }
+
+    GuestResult run_program(const std::string& path, unsigned long long limit, bool show_output,
+        ternary::execution_mode mode, bool compiled, ternary::architecture arch)
+    {
+        using clock = std::chrono::steady_clock;
+
+        NullBuffer null;
+        ternary::assembler::Assembler assembler {};
+        ternary::assembler::Assembler::data_map data;
+
+        {
+            // Debug builds of the assembler trace every line to the log
+            Redirect quiet { std::clog, show_output ? std::clog.rdbuf() : &null };
+            data = assembler.assemble_file(path);
+        }
+
+        if (data.empty())
+        {
+            throw std::runtime_error { "assembly failed" };
+        }
+
+        // The CPU holds all of memory, which is too big for the stack
+        auto cpu { std::make_unique<ternary::Cpu>(arch) };
+        cpu->load(data);
+        cpu->reset();
+        cpu->set_execution_mode(mode);
+
+        if (compiled)
+        {
+            cpu->load_image(build_image(data, program_name(path)));
+        }
+
+        Redirect quiet { std::cout, show_output ? std::cout.rdbuf() : &null };
+
+        const auto start { clock::now() };
+        const auto result { cpu->run_for(limit) };
+        const auto elapsed { std::chrono::duration<double>(clock::now() - start).count() };
+
+        if (result.reason == ternary::stop_reason::error)
+        {
+            throw std::runtime_error { result.error };
+        }
+
+        const auto halted { result.reason == ternary::stop_reason::halt
+            || result.reason == ternary::stop_reason::breakpoint };
+        const auto instructions { static_cast<unsigned long long>(result.retired) };
+
+        return { program_name(path), instructions, elapsed, halted };
+    }
+
+    void print_table(const GuestResult& r)
+    {
+        std::cout << fmt::format("{0:<20} {1:>12} instrs {2:>10.3f} s {3:>10.2f} MIPS{4}\n",
+            r.name, r.instructions, r.seconds, r.mips(), r.halted ? "" : " (limit reached)");
+    }
+
+    void print_json(const std::vector<GuestResult>& results)
+    {
+        std::cout << "{\n  \"programs\": [\n";
+
+        for (auto i = 0u; i < results.size(); ++i)
+        {
+            const auto& r { results[i] };
+            std::cout << fmt::format(
+                "    {{ \"name\": \"{0}\", \"instructions\": {1}, \"seconds\": {2:.6f}, \"mips\": {3:.3f}, \"halted\": {4} }}{5}\n",
+                r.name, r.instructions, r.seconds, r.mips(), r.halted ? "true" : "false",
+                (i + 1 < results.size()) ? "," : "");
+        }
+
+        std::cout << "  ]\n}\n";
+    }
+}
+
+// Usage: trireme_guest_bench [--json] [--output] [--step|--jit|--aot] [--advanced] [--limit N] program.tras...
+// With --output, the programs' debug output is shown instead of being
+// discarded. Programs run a basic block at a time, or one instruction
+// at a time with --step, or with hot blocks compiled to native code
+// with --jit. With --aot, each program is first compiled ahead of time
+// (into $TMPDIR, or /tmp) and run from the compiled image. --advanced
+// runs them with the 18-trit address space (where neither --jit nor
+// --aot compiles anything). --limit
+// stops a program that hasn't halted after N instructions (the
+// default is 100 million).
+int main(int argc, char** argv)
+{
+    auto json { false };
+    auto show_output { false };
+    auto limit { 100000000ull };
+    auto mode { ternary::execution_mode::block };
+    auto compiled { false };
+    auto arch { ternary::architecture::basic };
+    std::vector<std::string> programs;
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        const std::string arg { argv[i] };
+
+        if (arg == "--json")
+        {
+            json = true;
+        }
+        else if (arg == "--output")
+        {
+            show_output = true;
+        }
+        else if (arg == "--step")
+        {
+            mode = ternary::execution_mode::step;
+        }
+        else if (arg == "--jit")
+        {
+            mode = ternary::execution_mode::jit;
+        }
+        else if (arg == "--aot")
+        {
+            compiled = true;
+        }
+        else if (arg == "--advanced")
+        {
+            arch = ternary::architecture::advanced;
+        }
+        else if (arg == "--limit" && i + 1 < argc)
+        {
+            limit = std::stoull(argv[++i]);
+        }
+        else
+        {
+            programs.push_back(arg);
+        }
+    }
+
+    std::vector<GuestResult> results;
+    auto status { 0 };
+
+    for (auto&& p : programs)
+    {
+        try
+        {
+            results.push_back(run_program(p, limit, show_output, mode, compiled, arch));
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << p << ": " << e.what() << '\n';
+            status = 1;
+            continue;
+        }
+
+        if (!json)
+        {
+            print_table(results.back());
+        }
+    }
+
+    if (json)
+    {
+        print_json(results);
+    }
+
+    return status;
+}
@@ -0,0 +1,105 @@
+#include <vector>
+
+#include "bench.hpp"
+
+#include "hexad.hpp"
+
+// Hexad construction, arithmetic, tritwise logic and string conversion.
+
+namespace
+{
+    using ternary::Hexad;
+    using bench::run_unary;
+    using bench::run_binary;
+
+    constexpr std::size_t iterations { 2000000 };
+
+    // Conversion to strings allocates, so it gets fewer iterations
+    constexpr std::size_t string_iterations { 200000 };
+
+    const std::vector<Hexad>& operands()
+    {
+        static const std::vector<Hexad> hexads {
+            bench::hexad_operands().begin(), bench::hexad_operands().end()
+        };
+
+        return hexads;
+    }
+
+    const bool registered { [] {
+        // Construction wraps any int into the hexad range
+        bench::add("hexad/construct", iterations, [](std::size_t n) {
+            run_unary(n, bench::word_operands(), [](int v) { return Hexad { v }; });
+        });
+
+        bench::add("hexad/add", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](Hexad l, Hexad r) { return ternary::add(l, r); });
+        });
+
+        bench::add("hexad/add_with_carry", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](Hexad l, Hexad r) { return ternary::add_with_carry(l, r); });
+        });
+
+        bench::add("hexad/subtract_with_carry", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](Hexad l, Hexad r) { return ternary::subtract_with_carry(l, r); });
+        });
+
+        bench::add("hexad/left_shift", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](Hexad h) { return ternary::left_shift(h); });
+        });
+
+        bench::add("hexad/right_shift", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](Hexad h) { return ternary::right_shift(h); });
+        });
+
+        bench::add("hexad/rotate_left", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](Hexad h) { return ternary::rotate_left(h, 2); });
+        });
+
+        bench::add("hexad/rotate_right", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](Hexad h) { return ternary::rotate_right(h, 2); });
+        });
+
+        bench::add("hexad/positive_invert", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](Hexad h) { return ternary::positive_invert(h); });
+        });
+
+        bench::add("hexad/negative_invert", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](Hexad h) { return ternary::negative_invert(h); });
+        });
+
+        bench::add("hexad/trit_minimum", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](Hexad l, Hexad r) { return ternary::trit_minimum(l, r); });
+        });
+
+        bench::add("hexad/trit_maximum", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](Hexad l, Hexad r) { return ternary::trit_maximum(l, r); });
+        });
+
+        bench::add("hexad/logical_equality", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](Hexad l, Hexad r) { return ternary::logical_equality(l, r); });
+        });
+
+        bench::add("hexad/logical_multiply", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](Hexad l, Hexad r) { return ternary::logical_multiply(l, r); });
+        });
+
+        bench::add("hexad/forward_diode", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](Hexad h) { return ternary::forward_diode(h); });
+        });
+
+        bench::add("hexad/trits", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](Hexad h) { return h.trits(); });
+        });
+
+        bench::add("hexad/trit_string", string_iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](Hexad h) { return h.trit_string(); });
+        });
+
+        bench::add("hexad/value_string", string_iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](Hexad h) { return h.value_string(); });
+        });
+
+        return true;
+    }() };
+}
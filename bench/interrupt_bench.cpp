@@ -0,0 +1,93 @@
+#include "bench.hpp"
+
+#include "cpu.hpp"
+#include "opcode.hpp"
+
+// Guest programs that take an architectural interrupt on every
+// iteration of a tight loop. Each loop iteration is one op.
+
+namespace
+{
+    using ternary::Cpu;
+    using ternary::Opcode;
+
+    // The boot address, and the vector table that reset() points CR2 to
+    constexpr int origin { -265720 };       // %00zzzz
+    constexpr int vector_table { -204121 }; // %00ww0n
+    constexpr int handler { -1 };
+
+    int encode(int o, int m, int t, int x, int y, int z)
+    {
+        return Opcode { o, m, t, x, y, z }.value.value();
+    }
+
+    // Each instruction is 3 hexads long
+    constexpr int at(int index) { return origin + 3 * index; }
+
+    // Sets up a CPU with a handler that returns to the instruction
+    // after the one that raised the interrupt:
+    //      lsr rB, cr3
+    //      bri rB, 3
+    void install_handler(Cpu& cpu, int interrupt)
+    {
+        cpu.set_memory_word(vector_table + 3 * interrupt, handler);
+        cpu.set_memory_word(handler, encode(0, 1, 0, 2, 0, 3));
+        cpu.set_memory_word(handler + 3, encode(10, 2, 0, 2, 0, 3));
+    }
+
+    void run(Cpu& cpu, std::size_t instructions)
+    {
+        for (auto i = 0u; i < instructions; ++i)
+        {
+            cpu.step();
+        }
+    }
+
+    // Baseline: same loop shape, but with a NOP in place of the trap
+    //      loop: nop
+    //            lsr rB, cr3
+    //            nop
+    //            brs loop
+    bench::Registrar no_interrupt { "interrupt/none", 250000, [](std::size_t n) {
+        static Cpu cpu {};
+        cpu.reset();
+        cpu.set_memory_word(at(0), encode(0, -11, 0, 0, 0, 0));
+        cpu.set_memory_word(at(1), encode(0, 1, 0, 2, 0, 3));
+        cpu.set_memory_word(at(2), encode(0, -11, 0, 0, 0, 0));
+        cpu.set_memory_word(at(3), encode(10, -1, 0, 0, 0, -9));
+        run(cpu, n * 4);
+    }};
+
+    //      loop: und
+    //            brs loop
+    bench::Registrar invalid_opcode { "interrupt/invalid_opcode", 250000, [](std::size_t n) {
+        static Cpu cpu {};
+        cpu.reset();
+        install_handler(cpu, 4);
+        cpu.set_memory_word(at(0), encode(0, 0, 0, 0, 0, 0));
+        cpu.set_memory_word(at(1), encode(10, -1, 0, 0, 0, -3));
+        run(cpu, n * 4);
+    }};
+
+    //      loop: dvi rA, rA, 0
+    //            brs loop
+    bench::Registrar divide_by_zero { "interrupt/divide_by_zero", 250000, [](std::size_t n) {
+        static Cpu cpu {};
+        cpu.reset();
+        install_handler(cpu, 0);
+        cpu.set_memory_word(at(0), encode(2, -9, 1, 1, 0, 0));
+        cpu.set_memory_word(at(1), encode(10, -1, 0, 0, 0, -3));
+        run(cpu, n * 4);
+    }};
+
+    //      loop: brk
+    //            brs loop
+    bench::Registrar breakpoint { "interrupt/debug_breakpoint", 250000, [](std::size_t n) {
+        static Cpu cpu {};
+        cpu.reset();
+        install_handler(cpu, 1);
+        cpu.set_memory_word(at(0), encode(0, -12, 0, 0, 0, 0));
+        cpu.set_memory_word(at(1), encode(10, -1, 0, 0, 0, -3));
+        run(cpu, n * 4);
+    }};
+}
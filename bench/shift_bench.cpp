@@ -0,0 +1,53 @@
+#include <vector>
+
+#include "bench.hpp"
+
+#include "word.hpp"
+
+// Word shifts and rotates, over a spread of operands and every
+// place count from 1 to 18.
+
+namespace
+{
+    using ternary::Word;
+
+    template<typename Op>
+    void run(std::size_t n, Op op)
+    {
+        static const std::vector<Word> operands {
+            bench::word_operands().begin(), bench::word_operands().end()
+        };
+
+        for (auto i = 0u; i < n; ++i)
+        {
+            const auto places { static_cast<int>(i % 18) + 1 };
+            const auto result { op(operands[i & bench::operand_mask], places) };
+
+            bench::do_not_optimize(result);
+        }
+    }
+
+    bench::Registrar shl { "shift/shl", 1000000, [](std::size_t n) {
+        run(n, [](const Word& w, int p) { return ternary::shl(w, p); });
+    }};
+
+    bench::Registrar shr { "shift/shr", 1000000, [](std::size_t n) {
+        run(n, [](const Word& w, int p) { return ternary::shr(w, p); });
+    }};
+
+    bench::Registrar rol { "shift/rol", 1000000, [](std::size_t n) {
+        run(n, [](const Word& w, int p) { return ternary::rol(w, p); });
+    }};
+
+    bench::Registrar ror { "shift/ror", 1000000, [](std::size_t n) {
+        run(n, [](const Word& w, int p) { return ternary::ror(w, p); });
+    }};
+
+    bench::Registrar rcl { "shift/rcl", 1000000, [](std::size_t n) {
+        run(n, [](const Word& w, int p) { return ternary::rcl(w, 0, p); });
+    }};
+
+    bench::Registrar rcr { "shift/rcr", 1000000, [](std::size_t n) {
+        run(n, [](const Word& w, int p) { return ternary::rcr(w, 0, p); });
+    }};
+}
@@ -0,0 +1,71 @@
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+#include "ternary_math.hpp"
+
+// The trit primitives in ternary_math.hpp. Each fixed-width function is
+// measured next to the generic loop it replaces, at several widths.
+
+namespace
+{
+    using bench::word_operands;
+    using bench::run_unary;
+
+    constexpr std::size_t iterations { 2000000 };
+
+    template<std::size_t Places>
+    void register_shift()
+    {
+        const auto suffix { "/" + std::to_string(Places) };
+
+        bench::add("ternary_math/shift_right" + suffix, iterations, [](std::size_t n) {
+            run_unary(n, word_operands(), [](int v) { return shift_right(v, Places); });
+        });
+
+        bench::add("ternary_math/shift_right<N>" + suffix, iterations, [](std::size_t n) {
+            run_unary(n, word_operands(), [](int v) { return shift_right<Places>(v); });
+        });
+
+        bench::add("ternary_math/low_trits" + suffix, iterations, [](std::size_t n) {
+            run_unary(n, word_operands(), [](int v) { return low_trits(v, Places); });
+        });
+
+        bench::add("ternary_math/low_trits<N>" + suffix, iterations, [](std::size_t n) {
+            run_unary(n, word_operands(), [](int v) { return low_trits<Places>(v); });
+        });
+
+        bench::add("ternary_math/nth_trit" + suffix, iterations, [](std::size_t n) {
+            run_unary(n, word_operands(), [](int v) { return nth_trit(v, Places); });
+        });
+
+        bench::add("ternary_math/nth_trit<N>" + suffix, iterations, [](std::size_t n) {
+            run_unary(n, word_operands(), [](int v) { return nth_trit<Places>(v); });
+        });
+    }
+
+    const bool registered { [] {
+        bench::add("ternary_math/pow3", iterations, [](std::size_t n) {
+            for (auto i = 0u; i < n; ++i)
+            {
+                bench::do_not_optimize(pow3(static_cast<unsigned int>(i % 19)));
+            }
+        });
+
+        bench::add("ternary_math/lowest_trit", iterations, [](std::size_t n) {
+            run_unary(n, word_operands(), [](int v) { return lowest_trit(v); });
+        });
+
+        bench::add("ternary_math/clamp<6>", iterations, [](std::size_t n) {
+            run_unary(n, word_operands(), [](int v) { return clamp<int, 6>(v); });
+        });
+
+        register_shift<1>();
+        register_shift<6>();
+        register_shift<12>();
+        register_shift<17>();
+
+        return true;
+    }() };
+}
@@ -0,0 +1,175 @@
+#include <vector>
+
+#include "bench.hpp"
+
+#include "word.hpp"
+#include "double_word.hpp"
+#include "packed_word.hpp"
+
+// Word construction, arithmetic, tritwise logic and conversion. The
+// tritwise operations are measured both on Word and on PackedWord, the
+// representation the CPU uses for them. Shifts are in shift_bench.cpp.
+
+namespace
+{
+    using ternary::Word;
+    using ternary::DoubleWord;
+    using ternary::PackedWord;
+    using bench::run_unary;
+    using bench::run_binary;
+
+    constexpr std::size_t iterations { 1000000 };
+    constexpr std::size_t string_iterations { 100000 };
+
+    const std::vector<Word>& operands()
+    {
+        static const std::vector<Word> words {
+            bench::word_operands().begin(), bench::word_operands().end()
+        };
+
+        return words;
+    }
+
+    const std::vector<PackedWord>& packed_operands()
+    {
+        static const std::vector<PackedWord> packed { [] {
+            std::vector<PackedWord> result;
+
+            for (auto&& w : operands())
+            {
+                result.emplace_back(w);
+            }
+
+            return result;
+        }() };
+
+        return packed;
+    }
+
+    // Nonzero divisors, so no division traps
+    const std::vector<Word>& divisors()
+    {
+        static const std::vector<Word> words { [] {
+            std::vector<Word> result;
+
+            for (auto v : bench::hexad_operands())
+            {
+                result.emplace_back(v != 0 ? v : 1);
+            }
+
+            return result;
+        }() };
+
+        return words;
+    }
+
+    const bool registered { [] {
+        bench::add("word/construct", iterations, [](std::size_t n) {
+            run_unary(n, bench::word_operands(), [](int v) { return Word { v }; });
+        });
+
+        bench::add("word/value", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](const Word& w) { return w.value(); });
+        });
+
+        bench::add("word/add", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](const Word& l, const Word& r) { return ternary::add(l, r); });
+        });
+
+        bench::add("word/add_by_hexads", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](const Word& l, const Word& r) { return ternary::add_by_hexads(l, r); });
+        });
+
+        bench::add("word/sub", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](const Word& l, const Word& r) { return ternary::sub(l, r); });
+        });
+
+        bench::add("word/mul", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](const Word& l, const Word& r) { return ternary::mul(l, r); });
+        });
+
+        bench::add("word/div", iterations, [](std::size_t n) {
+            const auto& d { divisors() };
+            const auto& w { operands() };
+
+            for (auto i = 0u; i < n; ++i)
+            {
+                bench::do_not_optimize(ternary::div(w[i & bench::operand_mask], d[(i * 7 + 3) & bench::operand_mask]));
+            }
+        });
+
+        bench::add("word/div_double", iterations, [](std::size_t n) {
+            const auto& d { divisors() };
+            const auto& w { operands() };
+
+            for (auto i = 0u; i < n; ++i)
+            {
+                const DoubleWord dividend { w[i & bench::operand_mask], w[(i + 1) & bench::operand_mask] };
+                bench::do_not_optimize(ternary::div(dividend, d[(i * 7 + 3) & bench::operand_mask]));
+            }
+        });
+
+        bench::add("word/sti", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](const Word& w) { return ternary::sti(w); });
+        });
+
+        bench::add("word/sti_packed", iterations, [](std::size_t n) {
+            run_unary(n, packed_operands(), [](PackedWord p) { return ternary::sti(p); });
+        });
+
+        bench::add("word/pti", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](const Word& w) { return ternary::pti(w); });
+        });
+
+        bench::add("word/pti_packed", iterations, [](std::size_t n) {
+            run_unary(n, packed_operands(), [](PackedWord p) { return ternary::pti(p); });
+        });
+
+        bench::add("word/min", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](const Word& l, const Word& r) { return ternary::min(l, r); });
+        });
+
+        bench::add("word/min_packed", iterations, [](std::size_t n) {
+            run_binary(n, packed_operands(), [](PackedWord l, PackedWord r) { return ternary::min(l, r); });
+        });
+
+        bench::add("word/tem", iterations, [](std::size_t n) {
+            run_binary(n, operands(), [](const Word& l, const Word& r) { return ternary::tem(l, r); });
+        });
+
+        bench::add("word/tem_packed", iterations, [](std::size_t n) {
+            run_binary(n, packed_operands(), [](PackedWord l, PackedWord r) { return ternary::tem(l, r); });
+        });
+
+        // Packing and unpacking, which the CPU pays around each tritwise op
+        bench::add("word/pack", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](const Word& w) { return PackedWord { w }; });
+        });
+
+        bench::add("word/unpack", iterations, [](std::size_t n) {
+            run_unary(n, packed_operands(), [](PackedWord p) { return p.to_word(); });
+        });
+
+        bench::add("word/bin", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](const Word& w) { return ternary::bin(w); });
+        });
+
+        bench::add("word/tri", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](const Word& w) { return ternary::tri(w); });
+        });
+
+        bench::add("word/trits", iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](const Word& w) { return w.trits(); });
+        });
+
+        bench::add("word/trit_string", string_iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](const Word& w) { return w.trit_string(); });
+        });
+
+        bench::add("word/value_string", string_iterations, [](std::size_t n) {
+            run_unary(n, operands(), [](const Word& w) { return w.value_string(); });
+        });
+
+        return true;
+    }() };
+}
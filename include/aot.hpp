@@ -0,0 +1,170 @@
+#ifndef TRIREME_AOT_HPP
+#define TRIREME_AOT_HPP
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "hexad.hpp"
+#include "cpu_state.hpp"
+
+namespace ternary
+{
+    /**
+     * @brief Callbacks from ahead-of-time compiled code into the CPU.
+     * Like the JIT's helpers, these take the CPU as their first argument,
+     * and memory accesses take (and return) plain values. A store returns
+     * nonzero if it wrote into the compiled program, which makes the
+     * compiled code stop at once.
+     */
+    struct AotHelpers
+    {
+        using load_function = int (*)(void*, int, int);
+        using store_function = int (*)(void*, int, int);
+        using output_function = int (*)(void*, int, int);
+
+        // Indexed by hexad_select
+        load_function load[4];
+        store_function store[4];
+
+        // OUT: port, then value. The program stores the number of
+        // instructions it has run first, and stops after the OUT if this
+        // returns nonzero, because a device needs the CPU to look.
+        output_function output;
+    };
+
+    /**
+     * @brief A static recompiler from an assembled program to C++.
+     *
+     * Code is found by following control flow from the boot address, the
+     * start of the program, any handlers in the default interrupt vector
+     * table, and any code addresses loaded with LAD. Each instruction
+     * becomes a few lines of C++ working on a copy of the registers, and
+     * each block leader gets a label. Direct branches are gotos; indirect
+     * ones (BRI, CAR, RET, SYS, SRT) go through a switch over the leaders.
+     * Anything the translation doesn't cover, such as a jump to an unknown
+     * address or an instruction that isn't translated, returns to the
+     * interpreter.
+     *
+     * The output is a self-contained translation unit, which build() turns
+     * into a shared object for AotImage to load.
+     */
+    class AotTranslator
+    {
+        public:
+        using data_map = std::map<int, Hexad>;
+
+        // Bumped whenever the interface to the generated code changes
+        static constexpr int abi_version = 3;
+
+        explicit AotTranslator(const data_map& image);
+
+        /**
+         * @brief Get the C++ source for the program.
+         *
+         * @param name A name for the program, used only in a comment
+         */
+        std::string source(const std::string& name) const;
+
+        /**
+         * @brief Write the source to `stem`.cpp and compile it into
+         * `stem`.so with the system compiler.
+         *
+         * @param stem The path of the output, without an extension
+         * @param compiler The compiler command to use
+         * @return std::string The path of the shared object
+         * @throw std::runtime_error if it can't write the file, or the
+         * compiler fails
+         */
+        std::string build(const std::string& stem, const std::string& compiler = "c++") const;
+
+        // Addresses of the instructions that begin blocks
+        const std::set<int>& leaders() const noexcept { return leaders_; }
+
+        // Addresses of all translated instructions
+        const std::set<int>& code() const noexcept { return code_; }
+
+        private:
+        std::map<int, int> hexads_;
+        std::set<int> code_;
+        std::set<int> leaders_;
+
+        bool has_word(const int address) const;
+        int word_at(const int address) const;
+
+        void explore(int address);
+        std::string instruction(const int address) const;
+        std::string go_to(const int target) const;
+    };
+
+    /**
+     * @brief A program compiled by trireme-aot, loaded from a shared object.
+     *
+     * The CPU enters it at block leaders, as long as the A flag is 0 and
+     * breakpoints are off, and it runs until it reaches something it
+     * can't handle, or uses up its budget. Writing into any of its
+     * instructions makes it invalid, and the CPU goes back to
+     * interpreting the program.
+     */
+    class AotImage
+    {
+        public:
+        using entry_point = void (*)(CpuState*, void*, const AotHelpers*);
+
+        /**
+         * @brief Load a compiled program.
+         *
+         * @param path The path of the shared object
+         * @throw std::runtime_error if it can't be loaded, or was built
+         * by an incompatible version of trireme-aot
+         */
+        explicit AotImage(const std::string& path);
+        ~AotImage();
+
+        AotImage(const AotImage&) = delete;
+        AotImage& operator=(const AotImage&) = delete;
+
+        static constexpr bool supported() noexcept
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        bool valid() const noexcept { return valid_; }
+        void invalidate() noexcept { valid_ = false; }
+
+        // Whether compiled code can be entered at an address
+        bool has_entry(const int address) const { return valid_ && entries_.count(address) != 0; }
+
+        // Whether an address (in the basic memory space) holds part of
+        // a compiled instruction
+        bool covers(const int address) const noexcept
+            { return address >= low_ && address <= high_ && code_[address - low_]; }
+
+        // The number of compiled instructions, which is also the longest
+        // the program can run between two of its budget checks
+        std::size_t size() const noexcept { return size_; }
+
+        entry_point entry() const noexcept { return entry_; }
+
+        private:
+        void* handle_ { nullptr };
+        entry_point entry_ { nullptr };
+        std::unordered_set<int> entries_;
+
+        // Which hexads from low_ to high_ hold compiled instructions
+        std::vector<bool> code_;
+        int low_ { 1 };
+        int high_ { 0 };
+        std::size_t size_ { 0 };
+        bool valid_ { true };
+    };
+}
+
+#endif /* TRIREME_AOT_HPP */
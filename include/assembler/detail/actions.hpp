@@ -373,9 +373,9 @@ namespace ternary { namespace assembler {
         static void apply(const Input& in, State& s)
         {
             // Storage is little-endian
-            s.data[s.instruction_pointer] = s.y * pow3(3) + s.z;
-            s.data[s.instruction_pointer+1] = s.t * pow3(3) + s.x;
-            s.data[s.instruction_pointer+2] = s.o * pow3(3) + s.m;
+            s.data[s.instruction_pointer] = triads_to_hexad(s.y, s.z);
+            s.data[s.instruction_pointer+1] = triads_to_hexad(s.t, s.x);
+            s.data[s.instruction_pointer+2] = triads_to_hexad(s.o, s.m);
 
 #ifndef NDEBUG
             // Debugging message
@@ -8,6 +8,7 @@
 #include "instructions.hpp"
 #include "../../flags.hpp"
 #include "../../ternary_math.hpp"
+#include "../../convert.hpp"
 
 namespace ternary { namespace assembler {
     using namespace tao::pegtl;
@@ -108,6 +109,33 @@ namespace ternary { namespace assembler {
             s.m = -2;
             s.t = static_cast<int>(f);
         }
+
+        // Split immediates into triad fields, with the same table the
+        // CPU decodes them with. Anything beyond the fields' width is
+        // dropped, as it would be from the encoded hexads.
+        template<typename State>
+        inline void set_low6(State& s, int value)
+        {
+            const auto& triads { hexad_to_triads(low_trits(value, 6)) };
+            s.y = triads[0];
+            s.z = triads[1];
+        }
+
+        template<typename State>
+        inline void set_low9(State& s, int value)
+        {
+            s.x = low_trits(shift_right(value, 6), 3);
+            set_low6(s, value);
+        }
+
+        template<typename State>
+        inline void set_low12(State& s, int value)
+        {
+            const auto& triads { hexad_to_triads(low_trits(shift_right(value, 6), 6)) };
+            s.t = triads[0];
+            s.x = triads[1];
+            set_low6(s, value);
+        }
     }
 
     // Actions for assembler instructions
@@ -2178,8 +2206,7 @@ namespace ternary { namespace assembler {
             auto imm { s.operands.front() };
             s.operands.pop();
 
-            s.z = low_trits(imm, 3);
-            s.y = shift_right(imm, 3);
+            detail::set_low6(s, imm);
         }
     };
 
@@ -2196,9 +2223,7 @@ namespace ternary { namespace assembler {
             auto imm { s.operands.front() };
             s.operands.pop();
 
-            s.x = shift_right(imm, 6);
-            s.y = low_trits(shift_right(imm, 3), 3);
-            s.z = low_trits(imm, 3);
+            detail::set_low9(s, imm);
         }
     };
 
@@ -2265,8 +2290,7 @@ namespace ternary { namespace assembler {
             auto imm { s.operands.front() };
             s.operands.pop();
 
-            s.y = shift_right(imm, 3);
-            s.z = low_trits(imm, 3);
+            detail::set_low6(s, imm);
         }
     };
 
@@ -2280,13 +2304,7 @@ namespace ternary { namespace assembler {
             auto memaddr { s.operands.front() };
             s.operands.pop();
 
-            s.z = low_trits(memaddr, 3);
-            memaddr = shift_right(memaddr, 3);
-            s.y = low_trits(memaddr, 3);
-            memaddr = shift_right(memaddr, 3);
-            s.x = low_trits(memaddr, 3);
-            memaddr = shift_right(memaddr, 3);
-            s.t = memaddr;
+            detail::set_low12(s, memaddr);
 
             s.m = s.operands.front();
             s.operands.pop();
@@ -2306,8 +2324,7 @@ namespace ternary { namespace assembler {
             auto imm { s.operands.front() };
             s.operands.pop();
 
-            s.z = low_trits(imm, 3);
-            s.y = shift_right(imm, 3);
+            detail::set_low6(s, imm);
         }
     };
 
@@ -2321,8 +2338,7 @@ namespace ternary { namespace assembler {
             auto memaddr { s.operands.front() };
             s.operands.pop();
 
-            s.z = low_trits(memaddr, 3);
-            s.y = shift_right(memaddr, 3);
+            detail::set_low6(s, memaddr);
 
             s.x = s.operands.front();
             s.operands.pop();
@@ -2342,13 +2358,7 @@ namespace ternary { namespace assembler {
             auto memaddr { s.operands.front() };
             s.operands.pop();
 
-            s.z = low_trits(memaddr, 3);
-            memaddr = shift_right(memaddr, 3);
-            s.y = low_trits(memaddr, 3);
-            memaddr = shift_right(memaddr, 3);
-            s.x = low_trits(memaddr, 3);
-            memaddr = shift_right(memaddr, 3);
-            s.t = memaddr;
+            detail::set_low12(s, memaddr);
         }
     };
 
@@ -2365,8 +2375,7 @@ namespace ternary { namespace assembler {
             auto memaddr { s.operands.front() };
             s.operands.pop();
 
-            s.z = low_trits(memaddr, 3);
-            s.y = shift_right(memaddr, 3);
+            detail::set_low6(s, memaddr);
         }
     };
 
@@ -2395,8 +2404,7 @@ namespace ternary { namespace assembler {
             auto vec { s.operands.front() };
             s.operands.pop();
 
-            s.z = low_trits(vec, 3);
-            s.y = shift_right(vec, 3);
+            detail::set_low6(s, vec);
         }
     };
 
@@ -2427,9 +2435,7 @@ namespace ternary { namespace assembler {
             auto ioaddr { s.operands.front() };
             s.operands.pop();
 
-            s.x = shift_right(ioaddr, 6);
-            s.y = low_trits(shift_right(ioaddr, 3), 3);
-            s.z = low_trits(ioaddr, 3);
+            detail::set_low9(s, ioaddr);
 
             s.t = s.operands.front();
             s.operands.pop();
@@ -2450,9 +2456,7 @@ namespace ternary { namespace assembler {
             auto ioaddr { s.operands.front() };
             s.operands.pop();
 
-            s.x = shift_right(ioaddr, 6);
-            s.y = low_trits(shift_right(ioaddr, 3), 3);
-            s.z = low_trits(ioaddr, 3);
+            detail::set_low9(s, ioaddr);
         }
     };
 
@@ -2467,13 +2471,7 @@ namespace ternary { namespace assembler {
             auto memaddr { s.operands.front() };
             s.operands.pop();
 
-            s.z = low_trits(memaddr, 3);
-            memaddr = shift_right(memaddr, 3);
-            s.y = low_trits(memaddr, 3);
-            memaddr = shift_right(memaddr, 3);
-            s.x = low_trits(memaddr, 3);
-            memaddr = shift_right(memaddr, 3);
-            s.t = memaddr;
+            detail::set_low12(s, memaddr);
         }
     };
     
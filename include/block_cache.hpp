@@ -0,0 +1,215 @@
+#ifndef TRIREME_BLOCK_CACHE_HPP
+#define TRIREME_BLOCK_CACHE_HPP
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+#include "ternary_math.hpp"
+#include "decode_cache.hpp"
+
+namespace ternary
+{
+    // Native code for a block; see jit.hpp
+    struct CompiledBlock;
+
+    /**
+     * @brief One entry in a translated block: a decoded instruction, or
+     * a fused pair of instructions run by a single handler.
+     */
+    struct BlockOp
+    {
+        MicroOp op;
+
+        // Address of the first instruction, and of the last one
+        // (the same unless this is a fused pair)
+        int address { 0 };
+        int last { 0 };
+
+        // Number of guest instructions this entry covers
+        int count { 1 };
+    };
+
+    /**
+     * @brief A straight-line run of instructions, starting at a given
+     * address and ending at the first instruction that can transfer
+     * control (or when it reaches the maximum length).
+     */
+    struct Block
+    {
+        std::vector<BlockOp> ops;
+
+        // Length in instructions, counting both halves of a fused pair
+        std::size_t length { 0 };
+
+        // How many times the block has run, and its compiled form (when
+        // running with the JIT, once it has run often enough)
+        unsigned runs { 0 };
+        const CompiledBlock* native { nullptr };
+
+        bool translated() const noexcept { return length != 0; }
+    };
+
+    /**
+     * @brief A direct-mapped cache of translated blocks, keyed by their
+     * starting address. Like DecodeCache, it has one slot for each
+     * word-aligned address. It also counts how many blocks cover each
+     * word, so that writes to memory outside any block stay cheap.
+     *
+     * @tparam Address_Width The width of the memory address space, in trits
+     */
+    template<std::size_t Address_Width>
+    class BlockCache
+    {
+        public:
+        static constexpr auto range = pow3(Address_Width);
+        static constexpr auto slot_count = range / 3;
+
+        // The longest block we translate, in instructions
+        static constexpr std::size_t max_length = 32;
+
+        BlockCache(): blocks_(slot_count), coverage_(slot_count) {}
+
+        /**
+         * @brief Get the cache slot for a block starting at an address.
+         *
+         * @param address The address of the first instruction
+         * @return Block* The slot, which is empty if no block has been
+         * translated there yet, or nullptr if the address is not
+         * word-aligned.
+         */
+        Block* lookup(const int address) noexcept
+        {
+            const auto a { low_trits<Address_Width>(address) };
+
+            if (nth_trit<0>(a) != -1)
+            {
+                return nullptr;
+            }
+
+            return &blocks_[slot_index(a)];
+        }
+
+        /**
+         * @brief Get the most instructions a block starting at an address
+         * can hold. Blocks don't wrap around the end of memory.
+         *
+         * @param address The address of the first instruction, which must
+         * be word-aligned
+         */
+        std::size_t capacity(const int address) const noexcept
+        {
+            const std::size_t left { slot_count - slot_index(low_trits<Address_Width>(address)) };
+
+            return (left < max_length) ? left : std::size_t { max_length };
+        }
+
+        /**
+         * @brief Record that the block at an address has been filled in,
+         * so that writes into any of its instructions will discard it.
+         *
+         * @param address The address of the first instruction
+         */
+        void commit(const int address) noexcept
+        {
+            const auto first { slot_index(low_trits<Address_Width>(address)) };
+
+            for (auto i = 0u; i < blocks_[first].length; ++i)
+            {
+                ++coverage_[first + i];
+            }
+        }
+
+        /**
+         * @brief Discard any blocks containing a given hexad.
+         *
+         * @param address The address of a hexad that has been written
+         */
+        void invalidate(const int address) noexcept
+        {
+            const auto a { low_trits<Address_Width>(address) };
+            const auto slot { slot_index(a - (nth_trit<0>(a) + 1)) };
+
+            if (coverage_[slot] == 0)
+            {
+                return;
+            }
+
+            // Any block covering this word starts at most
+            // max_length - 1 words before it
+            const auto lowest { (slot >= max_length) ? slot - max_length + 1 : 0 };
+
+            for (auto s { slot + 1 }; s-- > lowest && coverage_[slot] != 0; )
+            {
+                if (s + blocks_[s].length > slot)
+                {
+                    drop(s);
+                }
+            }
+        }
+
+        /**
+         * @brief Discard any blocks overlapping a word.
+         *
+         * @param address The address of the low hexad of the word
+         */
+        void invalidate_word(const int address) noexcept
+        {
+            invalidate(address);
+            invalidate(address + 1);
+            invalidate(address + 2);
+        }
+
+        void clear()
+        {
+            std::fill(blocks_.begin(), blocks_.end(), Block{});
+            std::fill(coverage_.begin(), coverage_.end(), 0);
+            ++generation_;
+        }
+
+        // Drop every pointer to compiled code, keeping the blocks
+        void forget_native() noexcept
+        {
+            for (auto& block : blocks_)
+            {
+                block.native = nullptr;
+                block.runs = 0;
+            }
+        }
+
+        /**
+         * @brief A count that changes whenever a block is discarded. A
+         * caller running a block can compare it before and after each
+         * instruction to learn whether the block is still valid.
+         */
+        unsigned generation() const noexcept { return generation_; }
+
+        private:
+        static constexpr auto offset = range / 2;
+
+        static constexpr std::size_t slot_index(const int aligned) noexcept
+            { return (aligned + offset) / 3; }
+
+        void drop(const std::size_t slot) noexcept
+        {
+            auto& block { blocks_[slot] };
+
+            for (auto i = 0u; i < block.length; ++i)
+            {
+                --coverage_[slot + i];
+            }
+
+            block = {};
+            ++generation_;
+        }
+
+        std::vector<Block> blocks_;
+
+        // Number of blocks that include each word
+        std::vector<unsigned char> coverage_;
+
+        unsigned generation_ { 0 };
+    };
+}
+
+#endif /* TRIREME_BLOCK_CACHE_HPP */
@@ -0,0 +1,59 @@
+#ifndef TRIREME_BREAKPOINTS_HPP
+#define TRIREME_BREAKPOINTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ternary_math.hpp"
+
+namespace ternary
+{
+    /**
+     * @brief Marks the addresses where execution might have to stop, with
+     * one byte for each address in memory. Checking an address is a single
+     * load, so the CPU can afford to do it for every instruction.
+     *
+     * A mark is only a hint: addresses wider than memory share marks, so
+     * the CPU still has to make an exact comparison once it finds one.
+     *
+     * @tparam Address_Width The width of the memory address space, in trits
+     */
+    template<std::size_t Address_Width>
+    class BreakpointMap
+    {
+        public:
+        static constexpr auto range = pow3(Address_Width);
+
+        // Kinds of breakpoint, which can be combined
+        enum kind : std::uint8_t
+        {
+            // An address in one of DR1-4, checked after running the
+            // instruction there when the T flag is set
+            debug_register = 1,
+
+            // A breakpoint set by the host, which stops execution before
+            // the instruction there runs
+            host = 2
+        };
+
+        BreakpointMap(): marks_(range) {}
+
+        bool has(const int address, const kind k) const noexcept
+            { return (marks_[index(address)] & k) != 0; }
+
+        void mark(const int address, const kind k) noexcept
+            { marks_[index(address)] |= k; }
+
+        void unmark(const int address, const kind k) noexcept
+            { marks_[index(address)] &= static_cast<std::uint8_t>(~k); }
+
+        private:
+        static std::size_t index(const int address) noexcept
+            { return low_trits<Address_Width>(address) + range / 2; }
+
+        std::vector<std::uint8_t> marks_;
+    };
+}
+
+#endif /* TRIREME_BREAKPOINTS_HPP */
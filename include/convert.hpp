@@ -21,7 +21,15 @@
 template<typename Int, std::size_t Size>
 inline constexpr Int to_decimal(const std::array<Int, Size>& arr) noexcept
 {
-    return detail::to_decimal_impl(arr, Size-1);
+    // Horner's method, starting from the high trit
+    Int result { 0 };
+
+    for (auto i = Size; i > 0; --i)
+    {
+        result = result * 3 + arr[i-1];
+    }
+
+    return result;
 }
 
 /**
@@ -35,7 +43,70 @@ inline constexpr Int to_decimal(const std::array<Int, Size>& arr) noexcept
 template<typename Int, std::size_t Size>
 inline constexpr std::array<Int, Size> to_trits(Int value) noexcept
 {
-    return detail::to_trits_impl(value, std::make_index_sequence<Size>{});
+    return detail::to_trits_table_impl(value, std::make_index_sequence<Size>{});
+}
+
+/**
+ * @brief Gets the trits of a hexad value from a lookup table.
+ * 
+ * @param value A value in the range of a hexad (+/- 364)
+ * @return const std::array<int, 6>& The trits, low to high
+ */
+inline constexpr const detail::hexad_trits_type& hexad_to_trits(int value) noexcept
+{
+    return detail::hexad_trits[value + detail::hexad_offset];
+}
+
+/**
+ * @brief Converts a hexad value to a string of trits, high trit first,
+ * using a lookup table.
+ * 
+ * @param value A value in the range of a hexad (+/- 364)
+ * @return std::string A 6-character string of '+', '0', and '-'
+ */
+inline std::string hexad_to_trit_string(int value) noexcept
+{
+    const auto& entry { detail::hexad_strings[value + detail::hexad_offset] };
+    return { entry.data(), entry.size() };
+}
+
+/**
+ * @brief Converts a hexad value to its pair of base-27 characters
+ * (see `triad_to_string`), using a lookup table.
+ * 
+ * @param value A value in the range of a hexad (+/- 364)
+ * @return std::string A 2-character string, high triad first
+ */
+inline std::string hexad_to_string(int value) noexcept
+{
+    const auto& entry { detail::hexad_triad_pairs[value + detail::hexad_offset] };
+    return { entry.data(), entry.size() };
+}
+
+/**
+ * @brief Splits a hexad value into its two triads, using a lookup table.
+ * Instruction fields are triads, so this is how the CPU decodes them,
+ * and how the assembler encodes them.
+ * 
+ * @param value A value in the range of a hexad (+/- 364)
+ * @return const std::array<int, 2>& The triads (each +/- 13), high first
+ */
+inline constexpr const detail::triad_values_type& hexad_to_triads(int value) noexcept
+{
+    return detail::hexad_triad_values[value + detail::hexad_offset];
+}
+
+/**
+ * @brief Joins two triads into a hexad value; the reverse of
+ * `hexad_to_triads`.
+ * 
+ * @param high The high triad (+/- 13)
+ * @param low The low triad (+/- 13)
+ * @return constexpr int The hexad value
+ */
+inline constexpr int triads_to_hexad(int high, int low) noexcept
+{
+    return high * pow3(3) + low;
 }
 
 /**
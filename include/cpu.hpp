@@ -8,16 +8,33 @@
 #include <functional>
 #include <algorithm>
 #include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
 
+#include "cpu_state.hpp"
 #include "registers.hpp"
 #include "memory.hpp"
 #include "io.hpp"
 #include "flags.hpp"
 #include "opcode.hpp"
+#include "decode_cache.hpp"
+#include "block_cache.hpp"
+#include "breakpoints.hpp"
+#include "watchpoints.hpp"
+#include "jit.hpp"
+#include "aot.hpp"
+#include "device.hpp"
 #include "debug_io.hpp"
-#include "exceptions.hpp"
+#include "interrupt_controller.hpp"
+#include "scheduler.hpp"
+#include "timer.hpp"
+#include "interrupts.hpp"
 
 #include "word.hpp"
+#include "packed_word.hpp"
+#include "double_word.hpp"
 #include "hexad.hpp"
 #include "ternary_math.hpp"
 
@@ -32,101 +49,566 @@ namespace ternary
         full_word
     };
 
+    // How run() executes instructions: one at a time, a translated basic
+    // block at a time, or as blocks with the hot ones compiled to native
+    // code. All of them give the same results. (Where the JIT isn't
+    // supported, jit mode works the same as block mode.)
+    enum class execution_mode
+    {
+        step,
+        block,
+        jit
+    };
+
+    // Why execution stopped
+    enum class stop_reason
+    {
+        // Nothing stopped it (for a single block or instruction)
+        none,
+        // The program ran BRK
+        halt,
+        // IP matched a debug register, with the T flag set, or reached
+        // a host breakpoint
+        breakpoint,
+        // An access matched a watchpoint
+        watchpoint,
+        // An interrupt other than a breakpoint was delivered
+        interrupt,
+        // The instruction budget ran out
+        budget,
+        // Reached the address or condition given to run_until()
+        target,
+        // The simulator threw an exception
+        error
+    };
+
+    std::string to_string(stop_reason r);
+
+    // The outcome of running a basic block
+    struct BlockResult
+    {
+        // Number of guest instructions executed
+        std::size_t retired { 0 };
+
+        // Whether the last of them hit a debug breakpoint (including BRK)
+        bool breakpoint { false };
+
+        // Why the block ended, if it was an interrupt of some kind
+        stop_reason stop { stop_reason::none };
+    };
+
+    // The outcome of run(), run_for(), or run_until()
+    struct RunResult
+    {
+        stop_reason reason { stop_reason::none };
+
+        // Number of guest instructions executed
+        std::size_t retired { 0 };
+
+        // For stop_reason::error, what went wrong
+        std::string error {};
+    };
+
     class Cpu
     {
         public:
 
-        Cpu();
+        // The advanced architecture has an 18-trit address space, of which
+        // only the parts a program uses take up memory. Compiled code (in
+        // jit mode, or from trireme-aot) isn't used there, and decoded
+        // instructions are only kept for the basic 12-trit range.
+        explicit Cpu(const architecture a = architecture::basic);
 
         // General "control" methods
 
         void reset();
         void load(std::map<int, Hexad> data);
-        void run();
+        RunResult run();
         bool step();
+        BlockResult step_block();
         void clear_memory();
 
+        // Batched execution, which stops at a breakpoint, a BRK, or an
+        // error, and never runs more than `budget` instructions. With
+        // `stop_on_interrupt`, it also stops after delivering any other
+        // interrupt. None of these reset the CPU.
+        static constexpr std::size_t unlimited = ~std::size_t { 0 };
+
+        RunResult run_for(const std::size_t budget, const bool stop_on_interrupt = false);
+
+        // Run until IP reaches an address
+        RunResult run_until(const int address, const std::size_t budget = unlimited,
+            const bool stop_on_interrupt = false);
+
+        // Run until a condition holds. This checks the condition after
+        // every instruction, so it runs them one at a time.
+        RunResult run_until(const std::function<bool(const Cpu&)>& done, const std::size_t budget = unlimited,
+            const bool stop_on_interrupt = false);
+
+        void set_execution_mode(execution_mode m);
+        execution_mode get_execution_mode() const { return mode; }
+
+        // Run a program compiled by trireme-aot wherever possible, in
+        // any mode but step. Loading throws std::runtime_error on failure.
+        void load_image(const std::string& path);
+        void unload_image() { aot.reset(); }
+
+        // Breakpoints for the host debugger, as many as it likes. The run
+        // methods stop before running an instruction at any of these, with
+        // stop_reason::breakpoint, whatever the T flag says. (Execution
+        // that starts at one runs it.) The guest never sees them.
+        void set_breakpoint(const int address);
+        void clear_breakpoint(const int address);
+        bool has_breakpoint(const int address) const
+            { return host_breakpoints.count(memory.wrap(align(address))) != 0; }
+
+        architecture get_architecture() const noexcept
+            { return memory.advanced() ? architecture::advanced : architecture::basic; }
+
+        // Watchpoints on memory, as many as the host likes. These see the
+        // guest's loads and stores, but not instruction fetches, or the
+        // host's own access through get_memory() and the like. While any
+        // are set, compiled code isn't used. add_watchpoint() returns an
+        // ID for the watchpoint, and throws std::out_of_range if `first`
+        // and `last` aren't an address range in memory.
+        std::size_t add_watchpoint(const Watchpoint& w);
+        void remove_watchpoint(const std::size_t id);
+
+        // The hits that caused the last stop at a watchpoint
+        const std::vector<WatchHit>& watch_hits() const noexcept { return stopped_hits; }
+
+        // Devices on the I/O ports. Every CPU starts with the debug port,
+        // the interrupt controller, and the interval timer (on line 0).
+        // A device's ports must all be free, and there must be enough
+        // interrupt lines left for it, or attaching it throws
+        // std::invalid_argument. Attaching by type makes the device, and
+        // the CPU calls its methods directly; devices attached any other
+        // way go through the Device interface. load_device() throws
+        // std::runtime_error if the plugin can't be loaded.
+        template<typename T, typename... Args>
+        T& attach(Args&&... args)
+        {
+            std::unique_ptr<T> device { new T(std::forward<Args>(args)...) };
+            connect_device(*device);
+            owned_devices.push_back(std::move(device));
+
+            return static_cast<T&>(*owned_devices.back());
+        }
+
+        Device& attach(std::unique_ptr<Device> device);
+        Device& load_device(const std::string& path, const std::string& args = {});
+
+        // In the order they were attached
+        const std::vector<Device*>& get_devices() const noexcept { return devices; }
+
+        // The state of every device, in the same order, for saving and
+        // restoring along with the rest of the machine
+        std::vector<std::vector<int>> save_devices() const;
+        void restore_devices(const std::vector<std::vector<int>>& states);
+
+        // Whether a device is holding an interrupt line up. Lines are
+        // numbered from 0 across all devices, in the order they were
+        // attached.
+        bool interrupt_line(const int line) const { return interrupt_controller.level(line); }
+
+        // The interrupt controller, for masking and prioritizing lines
+        // from the host
+        InterruptController& get_interrupt_controller() noexcept { return interrupt_controller; }
+
+        IntervalTimer& get_timer() noexcept { return timer; }
+
+        // Events for devices, timed in retired instructions. The run
+        // methods end blocks early so that events happen on time.
+        Scheduler& get_scheduler() noexcept { return scheduler; }
+
         // Word alignment helpers
         static constexpr int align(int value)
-            { return (lowest_trit(value) == -1 ? value : value - (lowest_trit(value) - -1)); }
+            { return (nth_trit<0>(value) == -1 ? value : value - (nth_trit<0>(value) - -1)); }
         static constexpr Word align(Word w) { return { align(w.value())}; }
         
         // Getters and setters for various parts of the simulator
 
-        Word get_register(int reg) const { return registers.get(reg); }
-        Hexad get_memory(int address) const { return memory.get(address); }
+        Word get_register(int reg) const { return state.registers.get(reg); }
+        Hexad get_memory(int address) const { return memory.peek(address); }
         Word get_memory_word(int address) const
-            { return { memory.get_word(address) }; }
-        Word get_instruction_pointer() const { return instruction_pointer; }
-        void print_flags() const { std::clog << flag_register.to_string() << '\n'; }
-        void set_flag(flags f, const int value) { flag_register.set_flag(f, value); }
-        void set_memory(int addr, int value) { memory.set(addr, value); }
-        void set_memory_word(int address, int value) { memory.set_word(address, { value }); }
-        void set_reg(int reg, int value) { registers.set(reg, value); }
-        void set_instruction_pointer(int addr) { instruction_pointer = { align(addr) }; }
+            { return { memory.peek_word(address) }; }
+        Word get_instruction_pointer() const { return { state.ip }; }
+        // The debug port, for plugging in other sources and sinks
+        DebugIo& get_debug_io() noexcept { return debug_io; }
+        void print_flags() const { std::clog << state.flag_register.to_string() << '\n'; }
+        void set_flag(flags f, const int value) { state.flag_register.set_flag(f, value); }
+        void set_memory(int addr, int value) { poke(addr, value); }
+        void set_memory_word(int address, int value) { poke_word(address, { value }); }
+        void set_reg(int reg, int value) { state.registers.set(reg, value); }
+        void set_instruction_pointer(int addr) { state.ip = align(addr); }
 
         // Debugging methods
-        void debug_decode_instruction(Opcode& op) { decode_major(op); }
+        void debug_decode_instruction(Opcode& op) { execute(decode_major(op)); }
 
         private:
         static constexpr auto control_register_count = 4;
         static constexpr auto debug_register_count = 4;
         static constexpr auto triad = pow3(3);
 
-        Registers registers;
-        BasicMemory memory;
-        FlagRegister flag_register;
+        // Registers, flags, and IP
+        CpuState state;
+
+        using breakpoint_map = BreakpointMap<BasicMemory::address_width>;
+
+        AddressSpace memory;
+        DecodeCache<BasicMemory::address_width> decode_cache;
+        BlockCache<BasicMemory::address_width> block_cache;
+
+        // Addresses in DR1-4, and host breakpoints. The map only covers
+        // the basic address space, so host breakpoints are also kept
+        // exactly (which lets the run loop skip checking when there are
+        // none).
+        breakpoint_map breakpoints;
+        std::set<int> host_breakpoints;
+
+        // Watchpoints by ID, and hits from the current instruction
+        std::map<std::size_t, Watchpoint> watchpoints;
+        std::size_t next_watchpoint { 1 };
+        std::vector<WatchHit> pending_hits;
+        std::vector<WatchHit> stopped_hits;
+        bool watch_pending { false };
+        execution_mode mode { execution_mode::block };
+
+        // Created when first switching to jit mode
+        std::unique_ptr<Jit> jit;
+
+        // A program compiled ahead of time, if one is loaded
+        std::unique_ptr<AotImage> aot;
         Io io;
         DebugIo debug_io;
-        Word instruction_pointer;
+
+        // Devices keep pointers to these, and may still use them while
+        // they're destroyed, so they have to come first
+        Scheduler scheduler;
+
+        // Device interrupts are taken between blocks, while the I flag is
+        // +1, and only if it was at the last check too. That lets the
+        // instruction after one that sets the flag (a return from the
+        // handler, say) run first.
+        InterruptController interrupt_controller;
+        bool interrupts_were_enabled { false };
+
+        // How many instructions of the current block retired before the
+        // one running now, how many of those the devices know about,
+        // whether the block used a device, and how far off the next
+        // event was when it did
+        std::size_t block_position { 0 };
+        std::size_t devices_synced { 0 };
+        bool device_used { false };
+        Scheduler::time next_event { 0 };
+
+        IntervalTimer timer;
+
+        // All attached devices, the ones that want ticks, and the ones
+        // the CPU owns. Plugins own their devices.
+        std::vector<Device*> devices;
+        std::vector<Device*> ticking_devices;
+        std::vector<std::unique_ptr<Device>> owned_devices;
+        std::vector<std::unique_ptr<DevicePlugin>> plugins;
 
         // These are special, so handle them separately
 
         std::array<Word, control_register_count+1> control_regs;
         std::array<Word, debug_register_count> debug_regs;
 
+        // Interrupt raised by the current instruction, if any
+        bool interrupt_pending { false };
+        interrupts pending_interrupt { };
+
         private:
+        friend class Jit;
+
         using unary_function = std::function<Word(const Word&)>;
         using binary_function = std::function<Word(const Word&, const Word&)>;
 
-        static constexpr auto debug_io_base = 243;
+        // Tritwise operations work on the packed form of a word
+        using tritwise_unary_function = PackedWord (*)(PackedWord);
+        using tritwise_binary_function = PackedWord (*)(PackedWord, PackedWord);
 
         // Internal methods begin here
 
+        // Instruction fetch and dispatch
+
+        // Get the decoded instruction at an address, decoding it if necessary
+        MicroOp fetch(const int address);
+
+        // Run the handler for a decoded instruction
+        void execute(const MicroOp& op) { op.handler(*this, op); }
+
+        // Finish an instruction: check for breakpoints, deliver any pending
+        // interrupt, and move IP on if nothing else did. Returns the kind
+        // of interrupt delivered, if any.
+        stop_reason retire(const int current_ip);
+
+        // Execute one instruction
+        BlockResult step_one();
+
+        // Execute the block at IP, running no more than `limit`
+        // instructions (and at least one). A compiled program is only
+        // used with `use_image`.
+        BlockResult run_block(const std::size_t limit, const bool use_image);
+
+        // The loop behind run_for() and run_until(address)
+        RunResult run_blocks(const std::size_t budget, const bool has_target, const int target,
+            const bool stop_on_interrupt);
+
+        // The loop behind run_until(condition)
+        RunResult run_steps(const std::function<bool(const Cpu&)>& done, const std::size_t budget,
+            const bool stop_on_interrupt);
+
+        // Whether IP is at a host breakpoint
+        bool at_host_breakpoint() const noexcept
+        {
+            return !host_breakpoints.empty() && breakpoints.has(state.ip, breakpoint_map::host)
+                && host_breakpoints.count(memory.wrap(state.ip)) != 0;
+        }
+
+        // Whether the caches of decoded instructions and blocks can hold
+        // the instruction at an address. On the advanced architecture,
+        // they don't reach past the basic address space.
+        bool cacheable(const int address) const noexcept
+        {
+            constexpr auto half { BasicMemory::range / 2 };
+
+            return !memory.advanced() || (address >= -half && address <= half);
+        }
+
+        // Addresses from registers are cut down to 12 trits on the basic
+        // architecture
+        Word to_address(Word address) const noexcept
+        {
+            if (!memory.advanced())
+            {
+                address.set_high(0);
+            }
+
+            return address;
+        }
+
+        // Change one of DR1-4 (numbered from 0 here), keeping the
+        // breakpoint map up to date
+        void set_debug_register(const std::size_t index, const Word& value);
+
+        // Whether the current instruction has to end its block early
+        bool stop_pending() const noexcept { return interrupt_pending || watch_pending; }
+
+        // Called by memory for each access to a watched page
+        static void watch_access(void* context, int address, int length, bool write, int value);
+
+        // Pass the pending watchpoint hits to their callbacks, returning
+        // whether any of them stops execution
+        bool report_watch_hits(const int current_ip);
+
+        // Watch the pages of memory that any watchpoint covers
+        void update_watched_pages();
+
+        // Whether a stop reason ends a batch
+        static bool stops(const stop_reason r, const bool stop_on_interrupt) noexcept
+        {
+            return r != stop_reason::none && (r != stop_reason::interrupt || stop_on_interrupt);
+        }
+
+        // Basic block translation
+
+        // Fill in a block starting at the given address
+        void translate(const int address, Block& block);
+
+        // Whether an instruction ends a block: anything that can transfer
+        // control, or change the flags that step() checks
+        static bool ends_block(const Opcode&);
+
+        // Get a superinstruction for a pair of instructions, or a micro-op
+        // with a null handler if they don't fuse
+        static MicroOp fuse(const Opcode& first, const Opcode& second);
+
+        // Handlers for superinstructions. Each runs both instructions of a
+        // pair in order, stopping after the first if it raises an interrupt.
+        // Branch conditions are given by Target, as for branch_on_flag.
+        template<int Target>
+        static void fused_compare_branch(Cpu&, const MicroOp&);
+        template<bool Subtract, int Target>
+        static void fused_add_branch(Cpu&, const MicroOp&);
+        static void fused_load_output(Cpu&, const MicroOp&);
+        static void fused_move_shift(Cpu&, const MicroOp&);
+
+        // Native execution
+
+        // A block is compiled once it has run this many times
+        static constexpr unsigned jit_threshold = 16;
+
+        // The most instructions compiled code runs before returning, when
+        // it loops back to the start of its block
+        static constexpr int jit_budget = 1 << 16;
+
+        // Run compiled code for the block at IP, running no more than
+        // `limit` instructions. The limit must be at least the length of
+        // the block.
+        BlockResult run_native(const CompiledBlock& native, const std::size_t length, const std::size_t limit);
+
+        // Memory access for compiled code. Since the code keeps registers
+        // itself, these take and return plain values: the address, and the
+        // register being loaded (or stored). A store returns nonzero if it
+        // wrote into a translated block. Both expect the A flag to be 0.
+        template<hexad_select Select>
+        static int jit_load(Cpu* c, int address, int current);
+        template<hexad_select Select>
+        static int jit_store(Cpu* c, int address, int value);
+
+        // Run the ahead-of-time compiled program from IP, running no more
+        // than `limit` instructions. The limit must be more than the size
+        // of the program.
+        BlockResult run_image(const std::size_t limit);
+
+        // Callbacks for the compiled program
+        static const AotHelpers& aot_helpers();
+
+        // Move IP from the first instruction of a fused pair to the second
+        void enter_second_half()
+        {
+            state.ip = next_instruction(state.ip);
+            ++block_position;
+        }
+
+        // The address of the instruction after the one at an address
+        static int next_instruction(const int address) { return add(Word { address }, 3).first.value(); }
+
+        // Bind a device's ports to handlers that call its methods as a T,
+        // then add it to the device list
+        template<typename T>
+        void connect_device(T& device)
+        {
+            const auto range { check_ports(device) };
+
+            for (auto port = range.first; port < range.first + range.count; ++port)
+            {
+                io.bind(port, Io::read_function { [](void* d, int p) { return static_cast<T*>(d)->read(p); } },
+                    &device);
+                io.bind(port, Io::write_function { [](void* d, int p, int v) { static_cast<T*>(d)->write(p, v); } },
+                    &device);
+            }
+
+            add_device(device);
+        }
+
+        // A device's ports, if they're all free, and there are enough
+        // interrupt lines for it
+        PortRange check_ports(const Device& device) const;
+        void add_device(Device& device);
+
+        // Let devices know that instructions have been retired, and run
+        // any events that are due
+        void advance_devices(const std::size_t retired)
+        {
+            for (const auto d : ticking_devices)
+            {
+                d->tick(retired);
+            }
+
+            scheduler.advance(retired);
+        }
+
+        // Reset the device bookkeeping at the start of a block
+        void start_block() noexcept
+        {
+            block_position = 0;
+            devices_synced = 0;
+            device_used = false;
+        }
+
+        // Called before the instruction running now reads or writes a
+        // port. If the port belongs to a device, the devices are brought
+        // up to date with the instructions before it, so the device sees
+        // the same time it would when stepping.
+        void use_port(const int port, const RW which)
+        {
+            if (io.bound(port, which))
+            {
+                advance_devices(block_position - devices_synced);
+                devices_synced = block_position;
+                device_used = true;
+                next_event = scheduler.until_next();
+            }
+        }
+
+        // Whether the block has to end after a port access, because the
+        // device scheduled an event sooner than the block's limit allows
+        // for, or raised a line
+        bool device_needs_cpu() const noexcept
+        {
+            return device_used && (scheduler.until_next() < next_event || interrupt_controller.active());
+        }
+
+        // Let devices know about the rest of a block, then take a device
+        // interrupt if one is ready. Returns whether it did. The I flag
+        // is checked every time, whether or not a line is pending, so
+        // that the last check is never stale.
+        bool poll_devices(const std::size_t retired)
+        {
+            advance_devices(retired - devices_synced);
+            devices_synced = 0;
+
+            // This runs after every block, so read the trit directly
+            constexpr auto interrupt_trit { static_cast<std::size_t>(flags::interrupt) };
+            const auto enabled { nth_trit<interrupt_trit>(state.flag_register.others) == 1 };
+            const auto ready { enabled && interrupts_were_enabled };
+            interrupts_were_enabled = enabled;
+
+            return ready && interrupt_controller.active() && take_device_interrupt();
+        }
+
+        bool take_device_interrupt();
+
+        // Flag an interrupt, to be delivered once the current instruction is done.
+        // Handlers that raise an interrupt should return without further effects.
+        void raise(interrupts i) { interrupt_pending = true; pending_interrupt = i; }
+
+        // Jump to the handler for the pending interrupt
+        void deliver_interrupt();
+
+        // Save IP in CR3, and jump to the handler for an interrupt number
+        void vector_to(const int number);
+
         // Instruction decoding
+        // The decoders don't execute anything. Instead, they return
+        // a micro-op that can be cached and run any number of times.
 
         // Primary instruction decoder
-        void decode_major(Opcode&);
+        MicroOp decode_major(const Opcode&);
 
         // Decoding for system instructions (O field = 0)
-        void decode_minor_system(Opcode&);
+        MicroOp decode_minor_system(const Opcode&);
 
         // Decoding for tritwise instructions (O field = 1)
-        void decode_minor_tritwise(Opcode&);
+        MicroOp decode_minor_tritwise(const Opcode&);
 
         // Decoding for complex arithmetic/conversion instructions (O field = 2)
-        void decode_minor_complex(Opcode&);
+        MicroOp decode_minor_complex(const Opcode&);
 
         // Decoding for arithmetic instructions (O field = 4)
-        void decode_minor_arithmetic(Opcode&);
+        MicroOp decode_minor_arithmetic(const Opcode&);
 
         // Decoding for register instructions (O field = 8)
-        void decode_minor_register(Opcode&);
+        MicroOp decode_minor_register(const Opcode&);
 
         // Decoding for branch/skip insstructions (O field = 10)
-        void decode_minor_branch(Opcode&);
+        MicroOp decode_minor_branch(const Opcode&);
 
         // Decoding for register set instructions (O field = -6)
-        void decode_minor_set(Opcode&);
+        MicroOp decode_minor_set(const Opcode&);
 
         // Decoding for I/O instructions (O field = -8)
-        void decode_minor_io(Opcode&);
+        MicroOp decode_minor_io(const Opcode&);
 
         // Decoding for indirect memory instructions (O field = -10)
-        void decode_minor_indirect(Opcode&);
+        MicroOp decode_minor_indirect(const Opcode&);
 
         // Decoding for the tertiary operations with O field = 8 and M field = 1
-        void decode_tertiary_HA(Opcode&);
+        MicroOp decode_tertiary_HA(const Opcode&);
 
         // Instructions
         // These are not 1-to-1 with processor instructions.
@@ -149,11 +631,13 @@ namespace ternary
         void multiply_immediate(const int srcreg, const int destreg, const int immediate);
         void divide_register(const int srcreg1, const int srcreg2, const int destreg);
         void divide_immediate(const int srcreg, const int destreg, const int immediate);
+        void divide(const DoubleWord& dividend, const Word& divisor, const int destreg);
 
         void register_conversion(const int srcreg, const int destreg, unary_function fun);
+        void diode_register(const int srcreg, const int destreg, tritwise_unary_function fun);
 
-        void invert_register(const int reg, unary_function fun);
-        void logical_register(const int srcreg1, const int srcreg2, const int destreg, binary_function fun);
+        void invert_register(const int reg, tritwise_unary_function fun);
+        void logical_register(const int srcreg1, const int srcreg2, const int destreg, tritwise_binary_function fun);
 
         void compare_register(const int lreg, const int rreg);
         void compare_immediate(const int reg, const int immediate);
@@ -184,13 +668,61 @@ namespace ternary
         void io_read(const int reg, const int port, bool binary);
         void io_write(const int reg, const int port, bool binary);
 
-        void undefined_opcode(Opcode& op);
+        static void undefined_opcode(Cpu&, const MicroOp&);
 
         // Helpers to construct values from 3-trit "triads"
         int value_6(int x, int y) { return x* pow3(3) + y; }
         int value_9(int x, int y, int z) { return x * pow3(6) + y * pow3(3) + z; }
         int value_12(int x, int y, int z, int w) { return x + pow3(9) + y * pow3(6) + z * pow3(3) + w; }
 
+        // Raw memory writes, which also discard any stale decoded instructions
+        void store(const int address, const Hexad& value)
+        {
+            memory.set(address, value);
+            forget_code(address);
+        }
+        void store_word(const int address, const Word& value)
+        {
+            memory.set_word(address, value);
+            forget_code_word(address);
+        }
+
+        // The same for the host, whose writes watchpoints don't see
+        void poke(const int address, const Hexad& value)
+        {
+            memory.poke(address, value);
+            forget_code(address);
+        }
+        void poke_word(const int address, const Word& value)
+        {
+            memory.poke_word(address, value);
+            forget_code_word(address);
+        }
+
+        void forget_code(const int address)
+        {
+            decode_cache.invalidate(address);
+            block_cache.invalidate(address);
+
+            if (aot)
+            {
+                overwrite_image(address, 1);
+            }
+        }
+        void forget_code_word(const int address)
+        {
+            decode_cache.invalidate_word(address);
+            block_cache.invalidate_word(address);
+
+            if (aot)
+            {
+                overwrite_image(address, 3);
+            }
+        }
+
+        // Discard the compiled program if a write hits any of its code
+        void overwrite_image(const int address, const int length);
+
         // Memory read/write to handle absolute vs. pointer-based
         Hexad read_memory(const int ad);
         Word read_memory_word(const int ad);
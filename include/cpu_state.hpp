@@ -0,0 +1,36 @@
+#ifndef TRIREME_CPU_STATE_HPP
+#define TRIREME_CPU_STATE_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#include "registers.hpp"
+#include "flags.hpp"
+
+namespace ternary
+{
+    /**
+     * @brief The part of the CPU's state that changes from one instruction
+     * to the next: registers, flags, and IP, all as plain integers in one
+     * flat struct. Copying it is a cheap snapshot, and native code (from
+     * the JIT or trireme-aot) works on it in place, by offset.
+     */
+    struct CpuState
+    {
+        Registers registers;
+        FlagRegister flag_register;
+
+        // The address of the current instruction
+        std::int32_t ip { 0 };
+
+        // Used only by native code: instructions executed since it was
+        // entered, and the most it may execute before returning
+        std::int32_t retired { 0 };
+        std::int32_t budget { 0 };
+    };
+
+    static_assert(std::is_standard_layout<CpuState>::value,
+        "native code addresses CpuState by offset");
+}
+
+#endif /* TRIREME_CPU_STATE_HPP */
@@ -1,18 +1,174 @@
 #ifndef TRIREME_DEBUG_IO_HPP
 #define TRIREME_DEBUG_IO_HPP
 
-#include <string>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "device.hpp"
 #include "ternary_math.hpp"
 #include "word.hpp"
 
 namespace ternary
 {
-    class DebugIo
+    // Where the debug port's input comes from, a line at a time
+    class DebugSource
+    {
+        public:
+        virtual ~DebugSource() = default;
+
+        // Get the next line, without its newline, or return false at
+        // the end of the input
+        virtual bool read_line(std::string& line) = 0;
+    };
+
+    // Where the debug port's output goes, a block at a time
+    class DebugSink
+    {
+        public:
+        virtual ~DebugSink() = default;
+
+        virtual void write(const char* data, const std::size_t size) = 0;
+        virtual void flush() {}
+    };
+
+    // A C++ stream, such as std::cin or std::cout, which aren't owned
+    class StreamSource : public DebugSource
     {
         public:
-        DebugIo() = default;
+        explicit StreamSource(std::istream& in): in_(in) {}
+
+        bool read_line(std::string& line) override { return static_cast<bool>(std::getline(in_, line)); }
+
+        private:
+        std::istream& in_;
+    };
+
+    class StreamSink : public DebugSink
+    {
+        public:
+        explicit StreamSink(std::ostream& out): out_(out) {}
+
+        void write(const char* data, const std::size_t size) override
+            { out_.write(data, static_cast<std::streamsize>(size)); }
+        void flush() override { out_.flush(); }
+
+        private:
+        std::ostream& out_;
+    };
+
+    // Files, opened by path. These throw std::runtime_error if the file
+    // can't be opened.
+    class FileSource : public DebugSource
+    {
+        public:
+        explicit FileSource(const std::string& path);
+
+        bool read_line(std::string& line) override { return static_cast<bool>(std::getline(file_, line)); }
+
+        private:
+        std::ifstream file_;
+    };
+
+    class FileSink : public DebugSink
+    {
+        public:
+        explicit FileSink(const std::string& path);
+
+        void write(const char* data, const std::size_t size) override
+            { file_.write(data, static_cast<std::streamsize>(size)); }
+        void flush() override { file_.flush(); }
+
+        private:
+        std::ofstream file_;
+    };
+
+    // A C stream, such as a pipe from popen(). These don't close it.
+    class StdioSource : public DebugSource
+    {
+        public:
+        explicit StdioSource(std::FILE* in): in_(in) {}
+
+        bool read_line(std::string& line) override;
+
+        private:
+        std::FILE* in_;
+    };
+
+    class StdioSink : public DebugSink
+    {
+        public:
+        explicit StdioSink(std::FILE* out): out_(out) {}
+
+        void write(const char* data, const std::size_t size) override { std::fwrite(data, 1, size, out_); }
+        void flush() override { std::fflush(out_); }
+
+        private:
+        std::FILE* out_;
+    };
+
+    // Input from a string, and output captured in one the host owns
+    class StringSource : public DebugSource
+    {
+        public:
+        explicit StringSource(std::string input): input_(std::move(input)) {}
+
+        bool read_line(std::string& line) override;
+
+        private:
+        std::string input_;
+        std::size_t position_ { 0 };
+    };
+
+    class CaptureSink : public DebugSink
+    {
+        public:
+        explicit CaptureSink(std::string& output): output_(output) {}
+
+        void write(const char* data, const std::size_t size) override { output_.append(data, size); }
+
+        private:
+        std::string& output_;
+    };
+
+    // When buffered debug output is passed on to the sink
+    enum class flush_policy
+    {
+        // After each line, for interactive use
+        every_line,
+
+        // When the buffer fills up, or on flush()
+        when_full
+    };
+
+    /**
+     * @brief The debug port: a line of input at a time, and output of
+     * strings or numbers, a line each. Input comes from a DebugSource
+     * (std::cin by default), and output goes through a buffer to a
+     * DebugSink (std::cout by default). Whatever the flush policy, the
+     * buffer is flushed before waiting for input, and the CPU flushes it
+     * when a run or step method returns.
+     *
+     * Every CPU has one of these, on three ports: output at
+     * `base_port - 2`, input at `base_port - 1`, and control at
+     * `base_port`.
+     */
+    class DebugIo final : public Device
+    {
+        public:
+        static constexpr std::size_t default_block_size = 1u << 16;
+        static constexpr int base_port = 243;
+
+        DebugIo();
+        ~DebugIo() { flush(); }
+
+        DebugIo(const DebugIo&) = delete;
+        DebugIo& operator=(const DebugIo&) = delete;
 
         char read();
         void write(int input);
@@ -20,14 +176,34 @@ namespace ternary
         int read_control();
         void write_control(int value);
 
+        std::string name() const override { return "debug"; }
+        PortRange ports() const override { return { base_port - 2, 3 }; }
+
+        int read(int port) override;
+        void write(int port, int value) override;
+
+        // Resetting forgets the mode and any input not yet read, but
+        // keeps output for the sink
+        void reset() override;
+
+        std::vector<int> save() const override { return { request, mode }; }
+        void restore(const std::vector<int>& state) override;
+
+        // Replacing the sink flushes anything left for the old one
+        void set_source(std::unique_ptr<DebugSource> source);
+        void set_sink(std::unique_ptr<DebugSink> sink);
+
+        void set_flush_policy(const flush_policy p) { policy = p; }
+        flush_policy get_flush_policy() const noexcept { return policy; }
+
+        // The size at which a full buffer is flushed, for when_full
+        void set_block_size(const std::size_t size) { block_size = size; }
+
+        // Pass all buffered output on to the sink
+        void flush();
+
         private:
-        void get_input() { std::getline(std::cin, backing_input); }
-        void print() { std::cout << backing_output << '\n'; }
-        void print_and_clear()
-        {
-            print();
-            backing_output.clear();
-        }
+        void end_line();
 
         // Whether the debug I/O should request input
         int request = 0;
@@ -35,9 +211,21 @@ namespace ternary
         // Whether the debug I/O should output characters or integers
         int mode = 0;
 
+        // The current line of input, and how much of it has been read
         std::string backing_input;
+        std::size_t input_position { 0 };
+
+        // The line being written, which only goes in the buffer once
+        // it's ended, and output not yet passed on to the sink
+        std::string backing_line;
         std::string backing_output;
+
+        flush_policy policy { flush_policy::when_full };
+        std::size_t block_size { default_block_size };
+
+        std::unique_ptr<DebugSource> source;
+        std::unique_ptr<DebugSink> sink;
     };
 }
 
-#endif /* TRIREME_DEBUG_IO_HPP */
\ No newline at end of file
+#endif /* TRIREME_DEBUG_IO_HPP */
@@ -0,0 +1,106 @@
+#ifndef TRIREME_DECODE_CACHE_HPP
+#define TRIREME_DECODE_CACHE_HPP
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+#include "ternary_math.hpp"
+
+namespace ternary
+{
+    class Cpu;
+
+    /**
+     * @brief A predecoded instruction. The handler performs the operation,
+     * using whichever operand fields the decoder filled in. Anything that
+     * can be worked out at decode time (hexad selectors, add vs. subtract,
+     * flag targets) is baked into the choice of handler instead.
+     */
+    struct MicroOp
+    {
+        using handler_type = void (*)(Cpu&, const MicroOp&);
+
+        handler_type handler { nullptr };
+
+        int a { 0 };
+        int b { 0 };
+        int c { 0 };
+        int d { 0 };
+    };
+
+    /**
+     * @brief A direct-mapped cache of decoded instructions, with one slot
+     * for each word-aligned address in memory.
+     *
+     * @tparam Address_Width The width of the memory address space, in trits
+     */
+    template<std::size_t Address_Width>
+    class DecodeCache
+    {
+        public:
+        static constexpr auto range = pow3(Address_Width);
+        static constexpr auto slot_count = range / 3;
+
+        DecodeCache(): slots_(slot_count) {}
+
+        /**
+         * @brief Get the cache slot for an instruction address.
+         *
+         * @param address The address of the instruction
+         * @return MicroOp* The slot for that address, whose handler is null
+         * if it has not yet been decoded, or nullptr if the address is not
+         * word-aligned (we don't cache those).
+         */
+        MicroOp* lookup(const int address) noexcept
+        {
+            const auto a { low_trits<Address_Width>(address) };
+
+            if (nth_trit<0>(a) != -1)
+            {
+                return nullptr;
+            }
+
+            return &slots_[slot_index(a)];
+        }
+
+        /**
+         * @brief Discard the decoded instruction containing a given hexad.
+         *
+         * @param address The address of a hexad that has been written
+         */
+        void invalidate(const int address) noexcept
+        {
+            const auto a { low_trits<Address_Width>(address) };
+
+            // Move down to the start of the word (lowest trit -1)
+            slots_[slot_index(a - (nth_trit<0>(a) + 1))].handler = nullptr;
+        }
+
+        /**
+         * @brief Discard any decoded instructions overlapping a word.
+         *
+         * @param address The address of the low hexad of the word
+         */
+        void invalidate_word(const int address) noexcept
+        {
+            invalidate(address);
+            invalidate(address + 1);
+            invalidate(address + 2);
+        }
+
+        void clear() noexcept { std::fill(slots_.begin(), slots_.end(), MicroOp{}); }
+
+        private:
+        static constexpr auto offset = range / 2;
+
+        // Aligned addresses are spaced 3 apart, starting from the
+        // lowest address in memory, so they map to consecutive slots.
+        static constexpr std::size_t slot_index(const int aligned) noexcept
+            { return (aligned + offset) / 3; }
+
+        std::vector<MicroOp> slots_;
+    };
+}
+
+#endif /* TRIREME_DECODE_CACHE_HPP */
@@ -44,6 +44,110 @@ namespace detail
         return {{ nth_trit(value, Is)... }};
     }
 
+    // Lookup tables for conversions. The hexad tables are indexed by
+    // (value + hexad_offset), and the triad tables by (value + triad_offset).
+    constexpr std::size_t hexad_width = 6;
+    constexpr std::size_t triad_width = 3;
+    constexpr int hexad_offset = 364;
+    constexpr int triad_offset = 13;
+
+    using hexad_trits_type = std::array<int, hexad_width>;
+    using hexad_string_type = std::array<char, hexad_width>;
+    using triad_pair_type = std::array<char, 2>;
+    using triad_values_type = std::array<int, 2>;
+
+    constexpr char triad_character(int value) noexcept
+    {
+        return (value > 0)
+            ? positive[value-1]
+            : (value < 0) ? negative[-value-1] : '0';
+    }
+
+    constexpr char trit_character(int trit) noexcept
+    {
+        return (trit > 0)
+            ? '+'
+            : (trit < 0) ? '-' : '0';
+    }
+
+    template<std::size_t... Is>
+    constexpr auto generate_triad_characters(std::index_sequence<Is...>) noexcept
+        -> std::array<char, sizeof...(Is)>
+    {
+        return {{ triad_character(static_cast<int>(Is) - triad_offset)... }};
+    }
+
+    // Trit strings are written high trit first
+    template<std::size_t... Is>
+    constexpr hexad_string_type hexad_string_entry(int value, std::index_sequence<Is...>) noexcept
+    {
+        return {{ trit_character(nth_trit(value, hexad_width - 1 - Is))... }};
+    }
+
+    constexpr triad_pair_type triad_pair_entry(int value) noexcept
+    {
+        return {{
+            triad_character(shift_right(value, triad_width)),
+            triad_character(low_trits(value, triad_width))
+        }};
+    }
+
+    constexpr triad_values_type triad_values_entry(int value) noexcept
+    {
+        return {{ shift_right(value, triad_width), low_trits(value, triad_width) }};
+    }
+
+    template<std::size_t... Is>
+    constexpr auto generate_hexad_trits(std::index_sequence<Is...>) noexcept
+        -> std::array<hexad_trits_type, sizeof...(Is)>
+    {
+        return {{ to_trits_impl(static_cast<int>(Is) - hexad_offset,
+            std::make_index_sequence<hexad_width>{})... }};
+    }
+
+    template<std::size_t... Is>
+    constexpr auto generate_hexad_strings(std::index_sequence<Is...>) noexcept
+        -> std::array<hexad_string_type, sizeof...(Is)>
+    {
+        return {{ hexad_string_entry(static_cast<int>(Is) - hexad_offset,
+            std::make_index_sequence<hexad_width>{})... }};
+    }
+
+    template<std::size_t... Is>
+    constexpr auto generate_triad_pairs(std::index_sequence<Is...>) noexcept
+        -> std::array<triad_pair_type, sizeof...(Is)>
+    {
+        return {{ triad_pair_entry(static_cast<int>(Is) - hexad_offset)... }};
+    }
+
+    template<std::size_t... Is>
+    constexpr auto generate_triad_values(std::index_sequence<Is...>) noexcept
+        -> std::array<triad_values_type, sizeof...(Is)>
+    {
+        return {{ triad_values_entry(static_cast<int>(Is) - hexad_offset)... }};
+    }
+
+    constexpr auto triad_characters { generate_triad_characters(std::make_index_sequence<2*triad_offset+1>{}) };
+    constexpr auto hexad_trits { generate_hexad_trits(std::make_index_sequence<2*hexad_offset+1>{}) };
+    constexpr auto hexad_strings { generate_hexad_strings(std::make_index_sequence<2*hexad_offset+1>{}) };
+    constexpr auto hexad_triad_pairs { generate_triad_pairs(std::make_index_sequence<2*hexad_offset+1>{}) };
+    constexpr auto hexad_triad_values { generate_triad_values(std::make_index_sequence<2*hexad_offset+1>{}) };
+
+    // Trit I of a value, taken from the table row for the hexad containing it
+    template<std::size_t I, typename Int>
+    constexpr Int table_trit(Int value) noexcept
+    {
+        return hexad_trits[low_trits<hexad_width>(shift_right<hexad_width * (I / hexad_width)>(value))
+            + hexad_offset][I % hexad_width];
+    }
+
+    template<typename Int, std::size_t... Is>
+    constexpr auto to_trits_table_impl(Int value, std::index_sequence<Is...>) noexcept
+        -> std::array<Int, sizeof...(Is)>
+    {
+        return {{ table_trit<Is>(value)... }};
+    }
+
     template<typename Int = int>
     std::string triad_to_string_impl(Int value) noexcept
     {
@@ -57,18 +161,7 @@ namespace detail
         }
         else
         {
-            if (value > 0)
-            {
-                return std::string(1, positive[(value-1)]);
-            }
-            else if (value < 0)
-            {
-                return std::string(1, negative[-value-1]);
-            }
-            else
-            {
-                return {"0"};
-            }
+            return std::string(1, triad_characters[value + triad_offset]);
         }
     }
 }
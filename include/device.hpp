@@ -0,0 +1,156 @@
+#ifndef TRIREME_DEVICE_HPP
+#define TRIREME_DEVICE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "scheduler.hpp"
+
+namespace ternary
+{
+    // A range of I/O ports, `count` of them starting at `first`
+    struct PortRange
+    {
+        int first { 0 };
+        int count { 0 };
+    };
+
+    /**
+     * @brief One of the CPU's interrupt lines, as a device sees it. The
+     * CPU hands these out when a device is attached; a line that was
+     * never connected does nothing.
+     */
+    class InterruptLine
+    {
+        public:
+        using set_function = void (*)(void*, int, bool);
+
+        InterruptLine() = default;
+        InterruptLine(set_function set, void* context, int number):
+            set_(set), context_(context), number_(number) {}
+
+        void raise() const { set(true); }
+        void lower() const { set(false); }
+
+        bool connected() const noexcept { return set_ != nullptr; }
+
+        // The CPU's number for the line
+        int number() const noexcept { return number_; }
+
+        private:
+        void set(bool level) const
+        {
+            if (set_ != nullptr)
+            {
+                set_(context_, number_, level);
+            }
+        }
+
+        set_function set_ { nullptr };
+        void* context_ { nullptr };
+        int number_ { -1 };
+    };
+
+    /**
+     * @brief A peripheral on the I/O ports. The CPU sends every access to
+     * a port in the device's range to read() or write(), with the port
+     * number. Everything else is optional.
+     *
+     * Devices compiled in with the CPU are attached by type, with
+     * Cpu::attach<T>(), and their port handlers call the type's methods
+     * directly (so a final class pays nothing for the virtual interface).
+     * Others can be built as shared objects exporting a factory, with
+     * TRIREME_DEVICE_PLUGIN, and loaded at runtime with
+     * Cpu::load_device().
+     */
+    class Device
+    {
+        public:
+        // Bumped whenever this interface changes, so that old plugins
+        // aren't loaded
+        static constexpr int abi_version = 2;
+
+        virtual ~Device() = default;
+
+        virtual std::string name() const = 0;
+        virtual PortRange ports() const = 0;
+
+        virtual int read(int /*port*/) { return 0; }
+        virtual void write(int /*port*/, int /*value*/) {}
+
+        // Called whenever the CPU is reset
+        virtual void reset() {}
+
+        // A device that returns true from ticks() has tick() called as
+        // the CPU runs, with the number of instructions retired since
+        // the last call. That's after each block, so it can be a few
+        // instructions late. Most devices are better off scheduling
+        // events for when they have something to do.
+        virtual bool ticks() const { return false; }
+        virtual void tick(std::size_t /*retired*/) {}
+
+        // Called when the device is attached, with the CPU's scheduler
+        virtual void set_scheduler(Scheduler& /*scheduler*/) {}
+
+        // The device's state, as a list of numbers that restore() takes
+        // back
+        virtual std::vector<int> save() const { return {}; }
+        virtual void restore(const std::vector<int>& /*state*/) {}
+
+        // A device that wants to interrupt the CPU asks for some lines,
+        // and connect() gets each of them, by index, when it's attached
+        virtual int interrupt_lines() const { return 0; }
+        virtual void connect(int /*index*/, InterruptLine /*line*/) {}
+    };
+
+    /**
+     * @brief A device loaded from a shared object. The object exports
+     * `trireme_device_version`, which must match Device::abi_version,
+     * and `trireme_create_device`, which makes a device from a string of
+     * arguments. The device is destroyed before the object is unloaded.
+     */
+    class DevicePlugin
+    {
+        public:
+        using create_function = Device* (*)(const char*);
+
+        /**
+         * @brief Load a device.
+         *
+         * @param path The path of the shared object
+         * @param args Arguments for the device, passed to its factory
+         * @throw std::runtime_error if it can't be loaded, or was built
+         * against an incompatible Device
+         */
+        DevicePlugin(const std::string& path, const std::string& args);
+        ~DevicePlugin();
+
+        DevicePlugin(const DevicePlugin&) = delete;
+        DevicePlugin& operator=(const DevicePlugin&) = delete;
+
+        static constexpr bool supported() noexcept
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        Device& device() const noexcept { return *device_; }
+
+        private:
+        void* handle_ { nullptr };
+        std::unique_ptr<Device> device_;
+    };
+}
+
+// Export a device type from a plugin. The type needs a constructor that
+// takes the argument string.
+#define TRIREME_DEVICE_PLUGIN(Type) \
+    extern "C" const int trireme_device_version = ::ternary::Device::abi_version; \
+    extern "C" ::ternary::Device* trireme_create_device(const char* args) { return new Type(std::string { args }); }
+
+#endif /* TRIREME_DEVICE_HPP */
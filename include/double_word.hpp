@@ -0,0 +1,127 @@
+#ifndef TRIREME_DOUBLE_WORD_HPP
+#define TRIREME_DOUBLE_WORD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "word.hpp"
+#include "ternary_math.hpp"
+
+namespace ternary
+{
+    namespace detail
+    {
+        /**
+         * @brief Split a 64-bit value into its lowest Width trits and the
+         * rest, as low_trits and shift_right would. Like the fixed-width
+         * functions in ternary_math.hpp, this biases the value so that
+         * each trit becomes an unsigned digit.
+         *
+         * @tparam Width The number of trits in the low part
+         * @param value Any value up to 2**62 in magnitude
+         * @return constexpr std::pair<long long, long long> The low and high parts
+         */
+        template<std::size_t Width>
+        constexpr std::pair<long long, long long> split_trits(long long value) noexcept
+        {
+            constexpr auto power = pow3<std::uint64_t>(Width);
+            constexpr auto multiple = (std::uint64_t { 1 } << 62) / power + 1;
+            constexpr auto bias = power / 2 + multiple * power;
+
+            const auto biased = static_cast<std::uint64_t>(value) + bias;
+
+            return {
+                static_cast<long long>(biased % power) - static_cast<long long>(power / 2),
+                static_cast<long long>(biased / power) - static_cast<long long>(multiple)
+            };
+        }
+    }
+
+    /**
+     * @brief A 36-trit value, as held in a register pair such as ro:rA
+     * for multiplication and division. Any such value fits in a
+     * `long long`, since (3**36 - 1) / 2 < 2**63.
+     */
+    class DoubleWord
+    {
+        public:
+        using value_type = long long;
+
+        static constexpr auto width = 2 * Word::word_size;
+        static constexpr value_type word_range = pow3<value_type>(Word::word_size);
+        static constexpr value_type max_value = pow3<value_type>(width) / 2;
+        static constexpr value_type min_value = -max_value;
+
+        constexpr DoubleWord() = default;
+
+        constexpr DoubleWord(const Word& high, const Word& low):
+            value_(high.value() * word_range + low.value()) {}
+
+        // The value must be within the range of 36 trits
+        explicit constexpr DoubleWord(value_type v): value_(v) {}
+
+        constexpr value_type value() const noexcept { return value_; }
+
+        constexpr Word high() const noexcept
+            { return { static_cast<Word::value_type>(detail::split_trits<Word::word_size>(value_).second) }; }
+        constexpr Word low() const noexcept
+            { return { static_cast<Word::value_type>(detail::split_trits<Word::word_size>(value_).first) }; }
+
+        /**
+         * @brief Check whether the value fits in a single word.
+         *
+         * @return constexpr int 0 if it does (the high word is zero),
+         * otherwise the sign of the value
+         */
+        constexpr int overflow() const noexcept
+            { return (abs_c(value_) > word_range / 2) ? sign_c(value_) : 0; }
+
+        private:
+        value_type value_ { 0 };
+    };
+
+    inline bool operator==(const DoubleWord& lhs, const DoubleWord& rhs) { return lhs.value() == rhs.value(); }
+
+    // Multiplication gives a double-precision result
+    using multiplication_result = DoubleWord;
+
+    // Division takes a double-precision dividend, giving a double-precision
+    // quotient (which overflows if it doesn't fit in a word) and a remainder.
+    using division_dividend = DoubleWord;
+    using long_division_result = std::pair<DoubleWord, Word>;
+
+    inline multiplication_result mul(const Word& lhs, const Word& rhs) noexcept
+    {
+        return DoubleWord { static_cast<DoubleWord::value_type>(lhs.value()) * rhs.value() };
+    }
+
+    inline multiplication_result mul(const Word& lhs, Word::value_type rhs) noexcept
+    {
+        return DoubleWord { static_cast<DoubleWord::value_type>(lhs.value()) * detail::to_word_range(rhs) };
+    }
+
+    /**
+     * @brief Divide a double word by a word. As with the built-in integer
+     * division, the quotient is rounded toward zero, and the remainder
+     * takes the sign of the dividend.
+     *
+     * @param lhs The dividend
+     * @param rhs The divisor, which must be nonzero
+     * @return long_division_result The quotient and remainder
+     */
+    inline long_division_result div(const division_dividend& lhs, const Word& rhs) noexcept
+    {
+        return {
+            DoubleWord { lhs.value() / rhs.value() },
+            { static_cast<Word::value_type>(lhs.value() % rhs.value()) }
+        };
+    }
+
+    inline long_division_result div(const division_dividend& lhs, Word::value_type rhs) noexcept
+    {
+        return div(lhs, Word { rhs });
+    }
+}
+
+#endif /* TRIREME_DOUBLE_WORD_HPP */
@@ -1,6 +1,7 @@
 #ifndef TRIREME_FLAGS_HPP
 #define TRIREME_FLAGS_HPP
 
+#include <cstdint>
 #include <string>
 #include <numeric>
 #include <algorithm>
@@ -36,23 +37,68 @@ namespace ternary
         protection            
     };
 
+    /**
+     * @brief The flag register. Almost every arithmetic instruction sets
+     * C and S, but very few read them, so they are kept lazily: C as it
+     * is, and S as the result it was taken from. The sign is only worked
+     * out when a branch, an interrupt, or a read of the whole register
+     * asks for it.
+     *
+     * The fields are plain integers so that compiled code can read and
+     * write them directly.
+     */
     struct FlagRegister
     {
         FlagRegister() = default;
 
-        int get_flag(flags f) const { return get_trit(static_cast<int>(f)); }
-        void set_flag(flags f, int value) { set_trit(static_cast<int>(f), value); }
+        int get_flag(flags f) const
+        {
+            switch (f)
+            {
+                case flags::carry:
+                    return carry;
+                case flags::sign:
+                    return sign_c(result);
+                default:
+                    return nth_trit(others, static_cast<int>(f));
+            }
+        }
 
-        Word get() const { return w_; }
+        void set_flag(flags f, int value)
+        {
+            switch (f)
+            {
+                case flags::carry:
+                    carry = value;
+                    break;
+                case flags::sign:
+                    result = value;
+                    break;
+                default:
+                {
+                    const auto t { static_cast<int>(f) };
+                    others += (value - nth_trit(others, t)) * pow3(t);
+                    break;
+                }
+            }
+        }
+
+        // Set C, or set S from the sign of a result
+        void set_carry(int value) noexcept { carry = value; }
+        void set_result(int value) noexcept { result = value; }
+
+        Word get() const { return { others + 3 * sign_c(result) + carry }; }
 
         std::string to_string() const;
 
-        private:
-        Word w_ {};
+        // The carry trit
+        std::int32_t carry { 0 };
+
+        // The last result that set S, which has the sign of S
+        std::int32_t result { 0 };
 
-        int get_trit(int t) const { return nth_trit(w_.value(), t); }
-        void set_trit(int t, int value)
-            { w_ = { w_.value() - get_trit(t)*pow3(t) + value*pow3(t)}; }        
+        // The rest of the register, with the C and S trits always 0
+        std::int32_t others { 0 };
     };
 }
 
@@ -27,10 +27,10 @@ namespace ternary {
         using trit_container_type = std::array<value_type, width>;
         
         constexpr Hexad() = default;
-        constexpr Hexad(value_type v_): value(low_trits(v_, width)) {}
+        constexpr Hexad(value_type v_): value(low_trits<width>(v_)) {}
 
         constexpr value_type get() const { return value; }
-        constexpr trit_container_type trits() const { return to_trits<value_type, width>(value); }
+        constexpr trit_container_type trits() const { return hexad_to_trits(value); }
 
         std::string trit_string() const noexcept;
         std::string value_string() const noexcept;
@@ -0,0 +1,104 @@
+#ifndef TRIREME_INTERRUPT_CONTROLLER_HPP
+#define TRIREME_INTERRUPT_CONTROLLER_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "device.hpp"
+
+namespace ternary
+{
+    /**
+     * @brief The interrupt controller, which collects the interrupt lines
+     * of all the other devices. Raising a line makes it pending, and it
+     * stays that way until the CPU takes the interrupt, or the line is
+     * lowered. The CPU takes the pending line that isn't masked and has
+     * the highest priority (the lowest number, for a tie), through the
+     * vector `first_vector + line`.
+     *
+     * The guest sees it on four ports, starting at `base_port`:
+     *
+     * - select: the line the next two ports work on
+     * - mask: whether the selected line is masked (+1) or not (0)
+     * - priority: the selected line's priority, 0 by default
+     * - pending: reading gives the line the CPU would take next, or -1
+     *   if there isn't one; writing a line number clears it, for guests
+     *   that poll instead
+     */
+    class InterruptController final : public Device
+    {
+        public:
+        static constexpr int max_lines = 64;
+        static constexpr int base_port = 244;
+
+        // CPU exceptions come before this, with room to grow
+        static constexpr int first_vector = 27;
+
+        std::string name() const override { return "interrupts"; }
+        PortRange ports() const override { return { base_port, 4 }; }
+
+        int read(int port) override;
+        void write(int port, int value) override;
+
+        // Resetting drops every pending line, and unmasks them all
+        void reset() override;
+
+        std::vector<int> save() const override;
+        void restore(const std::vector<int>& state) override;
+
+        // Give out `count` lines, returning the number of the first, or
+        // -1 if there aren't enough left
+        int allocate(const int count);
+        int lines_used() const noexcept { return lines_used_; }
+
+        // For InterruptLine
+        static void set_line(void* controller, int line, bool level)
+            { static_cast<InterruptController*>(controller)->set(line, level); }
+
+        void set(const int line, const bool level);
+        bool level(const int line) const noexcept { return valid(line) && (levels_ & bit(line)) != 0; }
+        bool pending(const int line) const noexcept { return valid(line) && (pending_ & bit(line)) != 0; }
+
+        void mask(const int line, const bool masked);
+        bool masked(const int line) const noexcept { return valid(line) && (mask_ & bit(line)) != 0; }
+
+        void set_priority(const int line, const int priority)
+        {
+            if (valid(line))
+            {
+                priorities_[line] = priority;
+            }
+        }
+
+        int priority(const int line) const noexcept { return valid(line) ? priorities_[line] : 0; }
+
+        // Whether any line is pending and not masked. This is all the
+        // CPU checks until one is.
+        bool active() const noexcept { return active_ != 0; }
+
+        // The line to take next, or -1
+        int next() const noexcept;
+
+        // Take the next line, clearing it, and return its number (or -1)
+        int acknowledge() noexcept;
+
+        private:
+        static std::uint64_t bit(const int line) noexcept { return std::uint64_t { 1 } << line; }
+        static bool valid(const int line) noexcept { return line >= 0 && line < max_lines; }
+
+        void update() noexcept { active_ = pending_ & ~mask_; }
+
+        std::uint64_t levels_ { 0 };
+        std::uint64_t pending_ { 0 };
+        std::uint64_t mask_ { 0 };
+        std::uint64_t active_ { 0 };
+
+        std::array<int, max_lines> priorities_ {};
+        int lines_used_ { 0 };
+        int selected_ { 0 };
+    };
+}
+
+#endif /* TRIREME_INTERRUPT_CONTROLLER_HPP */
@@ -0,0 +1,24 @@
+#ifndef TRIREME_INTERRUPTS_HPP
+#define TRIREME_INTERRUPTS_HPP
+
+/*
+ * System interrupts are raised by instructions that can't complete normally.
+ * (The `und` instruction is an *intentional* example of this.) Rather than
+ * unwinding out of the instruction, a handler records the interrupt and
+ * returns; the CPU then vectors to it once the instruction is finished.
+ */
+namespace ternary
+{
+    // The value of each interrupt determines the vector
+    // the CPU jumps to when that interrupt occurs.
+    enum class interrupts
+    {
+        divide_by_zero = 0,
+        debug_breakpoint,
+        protection_violation,
+        invalid_flag,
+        invalid_opcode
+    };
+}
+
+#endif /* TRIREME_INTERRUPTS_HPP */
@@ -2,8 +2,10 @@
 #define TRIREME_IO_HPP
 
 #include <array>
+#include <cstdint>
 #include <map>
 #include <functional>
+#include <vector>
 
 #include "word.hpp"
 #include "ternary_math.hpp"
@@ -22,30 +24,75 @@ namespace ternary
         using read_handler_t = std::function<int()>;
         using write_handler_t = std::function<void(int)>;
 
+        // Handlers that skip std::function, for devices on the fast path.
+        // These get back the context they were bound with, and the port
+        // (wrapped into the 9-trit space), so one handler can serve a
+        // range of them.
+        using read_function = int (*)(void*, int);
+        using write_function = void (*)(void*, int, int);
+
         static constexpr auto io_address_width = 9;
+        static constexpr auto port_count = pow3(io_address_width);
 
         public:
-        Io() = default;
+        Io(): readers_(port_count), writers_(port_count) {}
 
+        // Binding fails (returning false) if the port already has a
+        // handler in that direction
         bool bind(int port, read_handler_t reader);
         bool bind(int port, write_handler_t writer);
+        bool bind(int port, read_function reader, void* context);
+        bool bind(int port, write_function writer, void* context);
         void unbind(int port, RW which);
 
-        Word read(int address);
+        // Whether a port has a handler in a direction
+        bool bound(int port, RW which) const;
+
+        Word read(int address) { return read_port(address); }
         Word read(Word address) { return read(address.value()); }
-        int read_binary(int address);
+        int read_binary(int address) { return read_port(address); }
         int read_binary(Word address) { return read_binary(address.value()); }
 
-        void write(int address, int data);
+        void write(int address, int data) { write_port(address, data); }
         void write(Word address, Word data) { return write(address.value(), data.value()); }
-        void write_binary(int address, unsigned char data);
-        void write_binary(Word address, unsigned char data) { return write(address.value(), data); }
+        void write_binary(int address, unsigned char data) { write_port(address, data); }
+        void write_binary(Word address, unsigned char data) { return write_binary(address.value(), data); }
 
         private:
-        std::array<Word, pow3(io_address_width)> io_space;
+        // How a port handles reads or writes: by keeping the value, or
+        // by calling a function (directly, or through a std::function)
+        enum class handler_kind : std::uint8_t
+        {
+            storage,
+            function,
+            std_function
+        };
+
+        template<typename Function>
+        struct Handler
+        {
+            handler_kind kind { handler_kind::storage };
+            Function function { nullptr };
+            void* context { nullptr };
+        };
+
+        // Ports are balanced, so they're indexed from the lowest
+        static constexpr int offset = port_count / 2;
+        static int index(int port) noexcept { return low_trits<io_address_width>(port) + offset; }
+        static int port_at(int index) noexcept { return index - offset; }
+
+        int read_port(int port);
+        void write_port(int port, int data);
+
+        std::array<Word, port_count> io_space;
+        std::vector<Handler<read_function>> readers_;
+        std::vector<Handler<write_function>> writers_;
+
+        // Owners of the std::function handlers, which their table
+        // entries point to
         std::map<int, read_handler_t> read_handlers;
         std::map<int, write_handler_t> write_handlers;
     };
 }
 
-#endif /* TRIREME_IO_HPP */
\ No newline at end of file
+#endif /* TRIREME_IO_HPP */
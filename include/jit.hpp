@@ -0,0 +1,97 @@
+#ifndef TRIREME_JIT_HPP
+#define TRIREME_JIT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "block_cache.hpp"
+#include "cpu_state.hpp"
+
+namespace ternary
+{
+    class Cpu;
+
+    /**
+     * @brief Native code for (a prefix of) a translated block.
+     */
+    struct CompiledBlock
+    {
+        using entry_point = void (*)(CpuState*, Cpu*);
+
+        entry_point code { nullptr };
+    };
+
+    /**
+     * @brief A baseline compiler from Trireme instructions to x86-64.
+     *
+     * Each block is compiled on its own, with guest registers kept in the
+     * CPU's own state and host registers used only as scratch. Code is compiled
+     * for the longest prefix of a block made up of supported instructions:
+     * register arithmetic, compares, flag branches, and indirect loads
+     * and stores (through calls back into the CPU). Anything else, such
+     * as I/O or system instructions, is left to the interpreter, and the
+     * compiled code returns just before it.
+     *
+     * On other hosts, supported() is false and nothing is ever compiled.
+     */
+    class Jit
+    {
+        public:
+        // Size of the executable buffer. When it fills up, all compiled
+        // code is thrown away and compilation starts again.
+        static constexpr std::size_t buffer_size = 4 * 1024 * 1024;
+
+        Jit();
+        ~Jit();
+
+        Jit(const Jit&) = delete;
+        Jit& operator=(const Jit&) = delete;
+
+        static constexpr bool supported() noexcept
+        {
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Whether the executable buffer was set up. This can be
+         * false on a supported host if the system refused the mapping.
+         */
+        bool available() const noexcept { return buffer_ != nullptr; }
+
+        /**
+         * @brief Compile the block at an address.
+         *
+         * @param cpu The CPU whose memory holds the block
+         * @param address The address of the block's first instruction
+         * @param block The translated block
+         * @return const CompiledBlock* The compiled code, or nullptr if the
+         * block starts with an unsupported instruction (or the buffer is
+         * full; see flushed())
+         */
+        const CompiledBlock* compile(const Cpu& cpu, const int address, const Block& block);
+
+        /**
+         * @brief Check, and clear, whether the last call to compile() threw
+         * away all earlier code to make room. If so, the caller must forget
+         * any CompiledBlock pointers it holds.
+         */
+        bool flushed() noexcept { const auto f { flushed_ }; flushed_ = false; return f; }
+
+        private:
+        void reset() noexcept;
+
+        std::uint8_t* buffer_ { nullptr };
+        std::size_t used_ { 0 };
+        bool flushed_ { false };
+
+        std::vector<std::unique_ptr<CompiledBlock>> blocks_;
+    };
+}
+
+#endif /* TRIREME_JIT_HPP */
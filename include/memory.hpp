@@ -1,10 +1,12 @@
 #ifndef TRIREME_MEMORY_HPP
 #define TRIREME_MEMORY_HPP
 
-#include <utility>
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <memory>
 #include <type_traits>
-#include <cassert>
+#include <vector>
 
 #include "word.hpp"
 #include "hexad.hpp"
@@ -12,109 +14,357 @@
 
 namespace ternary
 {
+    namespace detail
+    {
+        // Every hexad fits in 16 bits
+        using hexad_storage = std::int16_t;
+
+        // All of memory in one array, which is the fastest way to hold
+        // the basic 12-trit address space (about 1 MB)
+        template<std::size_t Range>
+        class DenseStorage
+        {
+            public:
+            hexad_storage read(const std::size_t index) const noexcept { return data_[index]; }
+            hexad_storage& write(const std::size_t index) noexcept { return data_[index]; }
+
+            void clear() noexcept { std::fill(data_.begin(), data_.end(), 0); }
+
+            private:
+            std::vector<hexad_storage> data_ = std::vector<hexad_storage>(Range);
+        };
+
+        /**
+         * @brief Memory in pages that are allocated the first time they're
+         * written, for address spaces too big to hold all at once. Reading
+         * a page that has never been written gives zeros. The last page
+         * used is kept in a one-entry TLB, so accesses that stay on a page
+         * skip the page table.
+         */
+        template<std::size_t Range, std::size_t Page_Size>
+        class PagedStorage
+        {
+            public:
+            static constexpr auto page_count = Range / Page_Size;
+
+            PagedStorage(): pages_(page_count) {}
+
+            hexad_storage read(const std::size_t index) const noexcept
+            {
+                const auto page { index / Page_Size };
+
+                if (page != tlb_page_)
+                {
+                    const auto& data { pages_[page] };
+
+                    if (!data)
+                    {
+                        return 0;
+                    }
+
+                    tlb_page_ = page;
+                    tlb_data_ = data.get();
+                }
+
+                return tlb_data_[index % Page_Size];
+            }
+
+            hexad_storage& write(const std::size_t index)
+            {
+                const auto page { index / Page_Size };
+
+                if (page != tlb_page_)
+                {
+                    auto& data { pages_[page] };
+
+                    if (!data)
+                    {
+                        data.reset(new hexad_storage[Page_Size]());
+                    }
+
+                    tlb_page_ = page;
+                    tlb_data_ = data.get();
+                }
+
+                return tlb_data_[index % Page_Size];
+            }
+
+            void clear() noexcept
+            {
+                for (auto& data : pages_)
+                {
+                    data.reset();
+                }
+
+                tlb_page_ = page_count;
+                tlb_data_ = nullptr;
+            }
+
+            // The number of pages that have been written
+            std::size_t pages_used() const noexcept
+            {
+                return std::count_if(pages_.cbegin(), pages_.cend(),
+                    [](const std::unique_ptr<hexad_storage[]>& p) { return p != nullptr; });
+            }
+
+            private:
+            std::vector<std::unique_ptr<hexad_storage[]>> pages_;
+
+            // No page has this number, so the TLB starts out empty
+            mutable std::size_t tlb_page_ { page_count };
+            mutable hexad_storage* tlb_data_ { nullptr };
+        };
+    }
+
     template<std::size_t Address_Width>
     struct Memory
     {
+        static constexpr auto address_width = Address_Width;
         static constexpr auto range = pow3(Address_Width);
 
+        // Watchpoints are filtered by page, so that accesses to memory
+        // nobody is watching only cost one extra load
+        static constexpr auto page_size = pow3(Address_Width / 2);
+        static constexpr auto page_count = range / page_size;
+
+        // Called for each access to a watched page, with the address (of
+        // the low hexad, for a word), the number of hexads, whether it's
+        // a write, and the value. A write is reported before it happens,
+        // with the new value; a read afterward, with the value read.
+        using watch_function = void (*)(void*, int, int, bool, int);
+
         Memory() = default;
 
-        Hexad get(const int address) const noexcept { return memory_[with_offset(address)]; }
-        void set(const int address, const Hexad& value) noexcept { memory_[with_offset(address)] = value; }
-        void set(const int address, const int value) noexcept { memory_[with_offset(address)] = { value }; }
-        void clear() noexcept { memory_.fill(0); }
+        Hexad get(const int address) const
+        {
+            const auto index { with_offset(address) };
+            const auto value { memory_.read(index) };
 
-        Word get_word(const int address) const
-            { return get_word_impl(address, std::integral_constant<std::size_t, Address_Width>()); }
-        
-        void set_word(const int address, const Word& data)
-            { return set_word_impl(address, data, std::integral_constant<std::size_t, Address_Width>()); }
+            if (watched_[index / page_size])
+            {
+                notify(index - offset, 1, false, value);
+            }
+
+            return { value };
+        }
+
+        void set(const int address, const Hexad& value)
+        {
+            const auto index { with_offset(address) };
+
+            if (watched_[index / page_size])
+            {
+                notify(index - offset, 1, true, value.get());
+            }
+
+            memory_.write(index) = static_cast<storage_type>(value.get());
+        }
+
+        void set(const int address, const int value) { set(address, Hexad { value }); }
+        void clear() noexcept { memory_.clear(); }
+
+        Word get_word(const int address) const { return get_word_impl<true>(address); }
+        void set_word(const int address, const Word& data) { set_word_impl<true>(address, data); }
+
+        // Access that doesn't count for watchpoints, for instruction
+        // fetch and the host
+        Hexad peek(const int address) const noexcept { return { memory_.read(with_offset(address)) }; }
+        void poke(const int address, const Hexad& value)
+            { memory_.write(with_offset(address)) = static_cast<storage_type>(value.get()); }
+
+        Word peek_word(const int address) const { return get_word_impl<false>(address); }
+        void poke_word(const int address, const Word& data) { set_word_impl<false>(address, data); }
+
+        // Set the function called for accesses to watched pages
+        void set_watcher(watch_function watcher, void* context) noexcept
+        {
+            watcher_ = watcher;
+            context_ = context;
+        }
+
+        // Watch every page holding part of a range of addresses
+        void watch(const int first, const int last) noexcept
+        {
+            for (auto page = with_offset(first) / page_size; page <= with_offset(last) / page_size; ++page)
+            {
+                watched_[page] = true;
+            }
+        }
+
+        void unwatch_all() noexcept { watched_.fill(false); }
+
+        // For paged memory, the number of pages written so far
+        std::size_t pages_used() const noexcept { return memory_.pages_used(); }
 
         private:
         // We use this for a number of calculations, including
         // all memory accesses. (Is there a better way to do it?)
-        static constexpr auto offset = range / 2;
+        static constexpr int offset = range / 2;
+
+        // There are too many hexads to keep inside the CPU, so they go on
+        // the heap: all together for the basic address space, and in
+        // pages for anything bigger.
+        using storage_type = detail::hexad_storage;
+        using storage = std::conditional_t<(Address_Width <= 12),
+            detail::DenseStorage<range>, detail::PagedStorage<range, pow3(6)>>;
 
-        std::array<Hexad, range> memory_;
+        storage memory_;
+        std::array<bool, page_count> watched_ {};
+
+        watch_function watcher_ { nullptr };
+        void* context_ { nullptr };
 
         /**
          * @brief Get the lowest trits of an address, so that it fits
          * in the available address space.
-         * 
+         *
          * @param address The given address
          * @return int The address, but witihin the used address space
          */
-        int address_mod(int address) const noexcept { return low_trits(address, Address_Width); }
+        int address_mod(int address) const noexcept
+        {
+            // Almost every address is already in range
+            return (address >= -offset && address <= offset) ? address : low_trits<Address_Width>(address);
+        }
 
         int with_offset(int address) const noexcept { return address_mod(address) + offset; }
 
-        // Note SFINAE stuff to handle different architectures
-        // (even though we haven't implemented more than 1 yet)
-        // This has to be in the class definition, because it
-        // otherwise gets really annoying with syntax.
-        template<std::size_t A = Address_Width,
-            typename std::enable_if_t<A == 12, int> = 0
-        >
-        Word get_word_impl(const int address, std::integral_constant<std::size_t, A>) const
+        void notify(int address, int length, bool write, int value) const
+        {
+            if (watcher_ != nullptr)
+            {
+                watcher_(context_, address, length, write, value);
+            }
+        }
+
+        // The index of the hexad after the one at an index, wrapping
+        // around the end of memory
+        static int next_index(int index) noexcept { return (index + 1 == range) ? 0 : index + 1; }
+
+        // Words are stored low hexad first. Only a word at the very top of
+        // memory wraps around to the bottom; the rest take a fast path.
+        template<bool Watch>
+        Word get_word_impl(const int address) const
         {
-            Word base { address };
-            Word result {};
+            const auto low { with_offset(address) };
+
+            if (low + 2 < range)
+            {
+                const Word result { memory_.read(low + 2), memory_.read(low + 1), memory_.read(low) };
 
-            base.set_high(0);
-            result.set_low(get(base.value()));
+                if (Watch && (watched_[low / page_size] || watched_[(low + 2) / page_size]))
+                {
+                    notify(low - offset, 3, false, result.value());
+                }
 
-            base = add(base, 1).first;
-            base.set_high(0);
-            result.set_middle(get(base.value()));
+                return result;
+            }
 
-            base = add(base, 1).first;
-            base.set_high(0);
-            result.set_high(get(base.value()));
+            const auto middle { next_index(low) };
+            const auto high { next_index(middle) };
+            const Word result { memory_.read(high), memory_.read(middle), memory_.read(low) };
+
+            if (Watch && (watched_[low / page_size] || watched_[high / page_size]))
+            {
+                notify(low - offset, 3, false, result.value());
+            }
 
             return result;
         }
 
-        template<std::size_t A = Address_Width,
-            typename std::enable_if_t<A != 12, int> = 0
-        >
-        Word get_word_impl(const int address, std::integral_constant<std::size_t, A>) const
+        template<bool Watch>
+        void set_word_impl(const int address, const Word& data)
         {
-            // Not implemented yet
-            assert(0);
-            return { };
+            const auto low { with_offset(address) };
+            const auto middle { next_index(low) };
+            const auto high { next_index(middle) };
+
+            if (Watch && (watched_[low / page_size] || watched_[high / page_size]))
+            {
+                notify(low - offset, 3, true, data.value());
+            }
+
+            memory_.write(low) = static_cast<storage_type>(data.low().get());
+            memory_.write(middle) = static_cast<storage_type>(data.middle().get());
+            memory_.write(high) = static_cast<storage_type>(data.high().get());
         }
+    };
 
-        template<std::size_t A = Address_Width,
-            typename std::enable_if_t<A == 12, int> = 0
-        >
-        void set_word_impl(const int address, const Word& data, std::integral_constant<std::size_t, A>)
-        {
-            Word base { address };
+    using BasicMemory = Memory<12ul>;
+    using AdvancedMemory = Memory<18ul>;
 
-            base.set_high(0);
-            set(base.value(), data.low());
+    // The width of the address space: 12 trits on the basic architecture,
+    // and the full 18 of a word on the advanced one
+    enum class architecture
+    {
+        basic,
+        advanced
+    };
 
-            base = add(base, 1).first;
-            base.set_high(0);
-            set(base.value(), data.middle());
+    /**
+     * @brief The CPU's memory, for either architecture. This has the same
+     * interface as Memory, and passes everything on to the memory for the
+     * architecture in use.
+     */
+    class AddressSpace
+    {
+        public:
+        using watch_function = BasicMemory::watch_function;
 
-            base = add(base, 1).first;
-            base.set_high(0);
-            set(base.value(), data.high());
+        explicit AddressSpace(const architecture a)
+        {
+            if (a == architecture::advanced)
+            {
+                advanced_.reset(new AdvancedMemory());
+            }
+            else
+            {
+                basic_.reset(new BasicMemory());
+            }
         }
 
-        template<std::size_t A = Address_Width,
-            typename std::enable_if_t<A != 12, int> = 0
-        >
-        void set_word_impl(const int address, const Word& data, std::integral_constant<std::size_t, A>)
+        bool advanced() const noexcept { return advanced_ != nullptr; }
+
+        // The number of hexads
+        int range() const noexcept { return advanced() ? AdvancedMemory::range : BasicMemory::range; }
+
+        // Wrap an address into the address space
+        int wrap(const int address) const noexcept
         {
-            // Not implemented yet
-            assert(0);
+            return advanced() ? low_trits<AdvancedMemory::address_width>(address)
+                : low_trits<BasicMemory::address_width>(address);
         }
-    };
 
-    using BasicMemory = Memory<12ul>;
+        Hexad get(const int address) const { return basic_ ? basic_->get(address) : advanced_->get(address); }
+        void set(const int address, const Hexad& value)
+            { basic_ ? basic_->set(address, value) : advanced_->set(address, value); }
+        Word get_word(const int address) const
+            { return basic_ ? basic_->get_word(address) : advanced_->get_word(address); }
+        void set_word(const int address, const Word& data)
+            { basic_ ? basic_->set_word(address, data) : advanced_->set_word(address, data); }
+
+        Hexad peek(const int address) const noexcept
+            { return basic_ ? basic_->peek(address) : advanced_->peek(address); }
+        void poke(const int address, const Hexad& value)
+            { basic_ ? basic_->poke(address, value) : advanced_->poke(address, value); }
+        Word peek_word(const int address) const
+            { return basic_ ? basic_->peek_word(address) : advanced_->peek_word(address); }
+        void poke_word(const int address, const Word& data)
+            { basic_ ? basic_->poke_word(address, data) : advanced_->poke_word(address, data); }
+
+        void clear() noexcept { basic_ ? basic_->clear() : advanced_->clear(); }
+
+        void set_watcher(watch_function watcher, void* context) noexcept
+            { basic_ ? basic_->set_watcher(watcher, context) : advanced_->set_watcher(watcher, context); }
+        void watch(const int first, const int last) noexcept
+            { basic_ ? basic_->watch(first, last) : advanced_->watch(first, last); }
+        void unwatch_all() noexcept { basic_ ? basic_->unwatch_all() : advanced_->unwatch_all(); }
+
+        private:
+        std::unique_ptr<BasicMemory> basic_;
+        std::unique_ptr<AdvancedMemory> advanced_;
+    };
 }
 
 
-#endif /* TRIREME_MEMORY_HPP */
\ No newline at end of file
+#endif /* TRIREME_MEMORY_HPP */
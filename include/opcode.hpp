@@ -4,6 +4,7 @@
 #include "word.hpp"
 #include "hexad.hpp"
 #include "ternary_math.hpp"
+#include "convert.hpp"
 
 namespace ternary
 {
@@ -33,7 +34,9 @@ namespace ternary
         // * T - tertiary operation code or operating register
         // * X,Y,Z - register, memory, or immediate values
         //
-        // We store these as `int`s for convenience.
+        // We store these as `int`s for convenience. Each hexad holds two
+        // fields, which are split out with `hexad_to_triads`, the same
+        // table the assembler uses to put them together.
 
         const int o;
         const int m;
@@ -0,0 +1,215 @@
+#ifndef TRIREME_PACKED_WORD_HPP
+#define TRIREME_PACKED_WORD_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#include "word.hpp"
+#include "hexad.hpp"
+#include "ternary_math.hpp"
+
+namespace ternary
+{
+    namespace detail
+    {
+        // Bit position of the negative-trit mask within a packed word.
+        // The positive mask starts at bit 0.
+        constexpr std::size_t negative_mask_offset = 32;
+
+        /**
+         * @brief Lookup table converting a hexad value to its packed trit
+         * masks, and a 6-bit mask back to the sum of its place values.
+         * Both are built at compile time.
+         */
+        struct hexad_mask_table
+        {
+            // Indexed by hexad value + Hexad::max_value. Positive trits
+            // are in bits 0-5, negative trits in bits 32-37.
+            std::uint64_t masks[Hexad::range];
+
+            // Indexed by a 6-bit trit mask; gives the sum of 3^i
+            // for each bit i that is set.
+            int place_values[1 << Hexad::width];
+        };
+
+        constexpr hexad_mask_table make_hexad_mask_table()
+        {
+            hexad_mask_table table {};
+
+            for (auto v = Hexad::min_value; v <= Hexad::max_value; ++v)
+            {
+                std::uint64_t pos { 0 };
+                std::uint64_t neg { 0 };
+                auto rest { v };
+
+                for (auto i = 0u; i < Hexad::width; ++i)
+                {
+                    const auto t { lowest_trit(rest) };
+
+                    if (t == 1)
+                    {
+                        pos |= std::uint64_t { 1 } << i;
+                    }
+                    else if (t == -1)
+                    {
+                        neg |= std::uint64_t { 1 } << i;
+                    }
+
+                    rest = (rest - t) / 3;
+                }
+
+                table.masks[v + Hexad::max_value] = pos | (neg << negative_mask_offset);
+            }
+
+            for (auto m = 0; m < (1 << Hexad::width); ++m)
+            {
+                auto sum { 0 };
+
+                for (auto i = 0u; i < Hexad::width; ++i)
+                {
+                    if (m & (1 << i))
+                    {
+                        sum += pow3(i);
+                    }
+                }
+
+                table.place_values[m] = sum;
+            }
+
+            return table;
+        }
+
+        static constexpr hexad_mask_table hexad_masks = make_hexad_mask_table();
+    }
+
+    /**
+     * @brief A Word stored as two bitmasks in one 64-bit integer: bit i
+     * of the low half is set if trit i is +1, and bit i of the high half
+     * is set if trit i is -1. A trit is never set in both masks.
+     *
+     * Tritwise operations on this representation are only a handful of
+     * bitwise instructions, instead of a loop over the individual trits.
+     */
+    class PackedWord
+    {
+        public:
+        using bits_type = std::uint64_t;
+
+        static constexpr auto width = Word::word_size;
+        static constexpr auto negative_offset = detail::negative_mask_offset;
+        static constexpr bits_type trit_mask = (bits_type { 1 } << width) - 1;
+        static constexpr bits_type positive_mask = trit_mask;
+        static constexpr bits_type negative_mask = trit_mask << negative_offset;
+
+        constexpr PackedWord() = default;
+
+        explicit PackedWord(const Word& w) noexcept:
+            bits_(pack(w.low()) | (pack(w.middle()) << Word::middle_power) | (pack(w.high()) << Word::high_power))
+        {}
+
+        explicit PackedWord(Word::value_type v) noexcept: PackedWord(Word { v }) {}
+
+        static constexpr PackedWord from_bits(bits_type b) noexcept { return PackedWord { b, 0 }; }
+
+        constexpr bits_type bits() const noexcept { return bits_; }
+        constexpr bits_type positive() const noexcept { return bits_ & positive_mask; }
+        constexpr bits_type negative() const noexcept { return bits_ >> negative_offset; }
+
+        Word to_word() const noexcept
+        {
+            return {
+                unpack(Word::high_power),
+                unpack(Word::middle_power),
+                unpack(0)
+            };
+        }
+
+        Word::value_type value() const noexcept { return to_word().value(); }
+
+        private:
+        // Tag parameter to keep this apart from the value constructor
+        constexpr PackedWord(bits_type b, int): bits_(b) {}
+
+        static bits_type pack(Hexad h) noexcept
+            { return detail::hexad_masks.masks[h.get() + Hexad::max_value]; }
+
+        Hexad::value_type unpack(std::size_t shift) const noexcept
+        {
+            constexpr bits_type hexad_mask { (1 << Hexad::width) - 1 };
+
+            return detail::hexad_masks.place_values[(bits_ >> shift) & hexad_mask]
+                - detail::hexad_masks.place_values[(bits_ >> (shift + negative_offset)) & hexad_mask];
+        }
+
+        bits_type bits_ { 0 };
+    };
+
+    inline bool operator==(const PackedWord& lhs, const PackedWord& rhs) { return lhs.bits() == rhs.bits(); }
+
+    // Tritwise operations on packed words. These give the same results
+    // as the Word versions of the same names.
+
+    inline PackedWord sti(PackedWord operand) noexcept
+    {
+        return PackedWord::from_bits((operand.positive() << PackedWord::negative_offset) | operand.negative());
+    }
+
+    inline PackedWord pti(PackedWord operand) noexcept
+    {
+        // + becomes -, everything else becomes +
+        const auto pos { operand.positive() };
+        return PackedWord::from_bits((~pos & PackedWord::trit_mask) | (pos << PackedWord::negative_offset));
+    }
+
+    inline PackedWord nti(PackedWord operand) noexcept
+    {
+        // - becomes +, everything else becomes -
+        const auto neg { operand.negative() };
+        return PackedWord::from_bits(neg | ((~neg & PackedWord::trit_mask) << PackedWord::negative_offset));
+    }
+
+    inline PackedWord min(PackedWord lhs, PackedWord rhs) noexcept
+    {
+        // Positive only if both are, negative if either is
+        const auto l { lhs.bits() };
+        const auto r { rhs.bits() };
+        return PackedWord::from_bits(((l & r) & PackedWord::positive_mask) | ((l | r) & PackedWord::negative_mask));
+    }
+
+    inline PackedWord max(PackedWord lhs, PackedWord rhs) noexcept
+    {
+        // Positive if either is, negative only if both are
+        const auto l { lhs.bits() };
+        const auto r { rhs.bits() };
+        return PackedWord::from_bits(((l | r) & PackedWord::positive_mask) | ((l & r) & PackedWord::negative_mask));
+    }
+
+    inline PackedWord teq(PackedWord lhs, PackedWord rhs) noexcept
+    {
+        const auto diff { lhs.bits() ^ rhs.bits() };
+        const auto unequal { (diff | (diff >> PackedWord::negative_offset)) & PackedWord::trit_mask };
+        return PackedWord::from_bits((~unequal & PackedWord::trit_mask) | (unequal << PackedWord::negative_offset));
+    }
+
+    inline PackedWord tem(PackedWord lhs, PackedWord rhs) noexcept
+    {
+        // Same signs multiply to +, opposite signs to -
+        const auto same { lhs.bits() & rhs.bits() };
+        const auto opposite { lhs.bits() & sti(rhs).bits() };
+        const auto pos { (same | (same >> PackedWord::negative_offset)) & PackedWord::trit_mask };
+        const auto neg { (opposite | (opposite >> PackedWord::negative_offset)) & PackedWord::trit_mask };
+        return PackedWord::from_bits(pos | (neg << PackedWord::negative_offset));
+    }
+
+    inline PackedWord fdr(PackedWord operand) noexcept
+    {
+        return PackedWord::from_bits(operand.bits() & PackedWord::positive_mask);
+    }
+
+    inline PackedWord rdr(PackedWord operand) noexcept
+    {
+        return PackedWord::from_bits(operand.bits() & PackedWord::negative_mask);
+    }
+}
+
+#endif /* TRIREME_PACKED_WORD_HPP */
@@ -2,7 +2,8 @@
 #define TRIREME_REGISTERS_HPP
 
 #include <array>
-#include <algorithm>
+#include <cassert>
+#include <cstdint>
 
 #include "hexad.hpp"
 #include "word.hpp"
@@ -23,16 +24,50 @@ namespace ternary
 
         Registers() = default;
 
-        Word get(int r) const noexcept;
-        void set(int r, const Word& w) noexcept;
-        void clear_all() noexcept;
+        /**
+         * @brief Get the contents of a machine register.
+         *
+         * @param r The register number, from -13 to 13. Every register
+         * field of an instruction is 3 trits, so it can't be anything else.
+         * @return Word The value of the register
+         */
+        Word get(int r) const noexcept { return { value(r) }; }
+
+        // The same, as a plain integer
+        std::int32_t value(int r) const noexcept
+        {
+            assert(r >= zero_register && r <= -zero_register);
+            return values_[r - zero_register];
+        }
+
+        /**
+         * @brief Set the contents of a machine register.
+         *
+         * @param r The register number, from -13 to 13
+         * @param v The new value of the register, which must be in the
+         * range of a word
+         */
+        void set(int r, std::int32_t v) noexcept
+        {
+            assert(r >= zero_register && r <= -zero_register);
 
-        int clamp_address(int r) const noexcept { return clamp<int, address_width>(r); }
+            if (r != zero_register)
+            {
+                values_[r - zero_register] = v;
+            }
+        }
+        void set(int r, const Word& w) noexcept { set(r, w.value()); }
+
+        void clear_all() noexcept;
 
         private:
-        std::array<Word, register_count/2 + 1> general;
-        std::array<Word, register_count/2> special;
+        // Indexed by register number + 13, so the zero register is first,
+        // and never written. Compiled code relies on this layout.
+        std::array<std::int32_t, register_count> values_ {};
     };
+
+    static_assert(sizeof(Registers) == Registers::register_count * sizeof(std::int32_t),
+        "registers must be a flat array of integers");
 }
 
-#endif /* TRIREME_REGISTERS_HPP */
\ No newline at end of file
+#endif /* TRIREME_REGISTERS_HPP */
@@ -0,0 +1,101 @@
+#ifndef TRIREME_SCHEDULER_HPP
+#define TRIREME_SCHEDULER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ternary
+{
+    /**
+     * @brief Events for devices, at points in simulated time. The
+     * simulator has no cycle timings, so time is counted in retired
+     * instructions.
+     *
+     * Events are kept in a min-heap, and the CPU only looks at it once
+     * the earliest deadline has passed, so devices with nothing
+     * scheduled cost nothing. Events due at the same time run in the
+     * order they were scheduled. Cancelled events are left in the heap,
+     * and dropped when they reach the top.
+     */
+    class Scheduler
+    {
+        public:
+        using time = std::uint64_t;
+        using event_id = std::size_t;
+
+        static constexpr time never = std::numeric_limits<time>::max();
+
+        // The number of instructions retired so far
+        time now() const noexcept { return now_; }
+
+        // Run an action at a time, or once `delay` more instructions
+        // have retired. Nothing runs before the next instruction, so
+        // times in the past (and a delay of 0) count as the next one.
+        event_id schedule_at(const time when, std::function<void()> action)
+        {
+            const auto id { next_id_++ };
+            const auto at { (when > now_) ? when : now_ + 1 };
+
+            queue_.push({ at, id });
+            actions_.emplace(id, std::move(action));
+            next_ = std::min(next_, at);
+
+            return id;
+        }
+
+        event_id schedule(const time delay, std::function<void()> action)
+            { return schedule_at(now_ + delay, std::move(action)); }
+
+        void cancel(const event_id id) { actions_.erase(id); }
+        bool scheduled(const event_id id) const { return actions_.count(id) != 0; }
+
+        // The number of events waiting to run
+        std::size_t size() const noexcept { return actions_.size(); }
+
+        // When the next event is due, which may be one that was
+        // cancelled, or `never`
+        time next_deadline() const noexcept { return next_; }
+
+        // How many instructions can run before the next event is due
+        time until_next() const noexcept { return (next_ > now_) ? next_ - now_ : 1; }
+
+        // Move time on, running anything that's now due
+        void advance(const time retired)
+        {
+            now_ += retired;
+
+            if (now_ >= next_)
+            {
+                run_due();
+            }
+        }
+
+        private:
+        struct Event
+        {
+            time when;
+            event_id id;
+
+            bool operator>(const Event& other) const noexcept
+                { return when > other.when || (when == other.when && id > other.id); }
+        };
+
+        void run_due();
+
+        std::priority_queue<Event, std::vector<Event>, std::greater<Event>> queue_;
+        std::unordered_map<event_id, std::function<void()>> actions_;
+
+        time now_ { 0 };
+        time next_ { never };
+        event_id next_id_ { 1 };
+    };
+}
+
+#endif /* TRIREME_SCHEDULER_HPP */
@@ -53,6 +53,7 @@ namespace ternary { namespace shell {
         register_name, balanced_integer) };
     static const std::regex match_memory { fmt::format(R"(({0})(?:\s*=\s*({1}))?)",
         balanced_integer, balanced_integer) };
+    static const std::regex match_range { fmt::format(R"(({0})(?:\s+({0}))?)", balanced_integer) };
 }}
 
 #endif /* TRIREME_SHELL_HPP */
\ No newline at end of file
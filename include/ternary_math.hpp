@@ -1,6 +1,9 @@
 #ifndef TRIREME_TERNARY_MATH_HPP
 #define TRIREME_TERNARY_MATH_HPP
 
+#include <cstddef>
+#include <cstdint>
+
 /**
  * @brief Constexpr absolute value function.
  * 
@@ -187,4 +190,95 @@ constexpr Int low_trits(Int value, std::size_t width) noexcept
     }
 }
 
+// Fixed-width versions of the above. The generic functions take the
+// number of places at runtime and work by signed division, with a fixup
+// for balanced rounding. These take the width as a template argument
+// (the project uses 1, 3, 4, 6, 9, 12, and 18), so every power of 3 is
+// a compile-time constant. The value is biased so that each of its
+// balanced trits becomes an ordinary digit {0,1,2}, which lets us use
+// unsigned division by a constant; the compiler turns that into a
+// multiply by the reciprocal. The generic versions remain the reference.
+
+namespace detail
+{
+    /**
+     * @brief The bias that maps a signed 32-bit value onto a non-negative
+     * one, while adding 1 to each of its lowest _Width_ trits.
+     * 
+     * @tparam Width The number of trits affected
+     * @return constexpr std::uint64_t (3**Width - 1) / 2, plus a multiple
+     * of 3**Width large enough to cover any negative int32 value
+     */
+    template<std::size_t Width>
+    constexpr std::uint64_t trit_bias() noexcept
+    {
+        static_assert(Width <= 20, "trit width too large for biased arithmetic");
+
+        constexpr auto power = pow3<std::uint64_t>(Width);
+        constexpr auto multiple = (std::uint64_t { 1 } << 31) / power + 1;
+
+        return power / 2 + multiple * power;
+    }
+
+    template<std::size_t Width, typename Int>
+    constexpr std::uint64_t biased(Int value) noexcept
+    {
+        static_assert(sizeof(Int) <= sizeof(std::int32_t),
+            "fixed-width trit functions only handle 32-bit values; use the generic versions");
+
+        return static_cast<std::uint64_t>(static_cast<std::int64_t>(value) + trit_bias<Width>());
+    }
+}
+
+/**
+ * @brief Shift a number to the right by a fixed number of trits.
+ * 
+ * @tparam Places The number of trits to shift
+ * @tparam Int A signed integral type of at most 32 bits
+ * @param value An integer to shift
+ * @return constexpr Int The same as `shift_right(value, Places)`
+ */
+template<std::size_t Places, typename Int = int>
+constexpr Int shift_right(Int value) noexcept
+{
+    constexpr auto power = pow3<std::uint64_t>(Places);
+    constexpr auto bias_multiple = static_cast<std::int64_t>(detail::trit_bias<Places>() / power);
+
+    return static_cast<Int>(static_cast<std::int64_t>(detail::biased<Places>(value) / power) - bias_multiple);
+}
+
+/**
+ * @brief Get a fixed number of the lowest trits of a number.
+ * 
+ * @tparam Width The desired number of trits in the result
+ * @tparam Int A signed integral type of at most 32 bits
+ * @param value The given value
+ * @return constexpr Int The same as `low_trits(value, Width)`
+ */
+template<std::size_t Width, typename Int = int>
+constexpr Int low_trits(Int value) noexcept
+{
+    constexpr auto power = pow3<std::uint64_t>(Width);
+
+    return static_cast<Int>(static_cast<std::int64_t>(detail::biased<Width>(value) % power)
+        - static_cast<std::int64_t>(power / 2));
+}
+
+/**
+ * @brief Get the trit at a fixed place in a number.
+ * 
+ * @tparam Place The desired trit, where 0 is the lowest
+ * @tparam Int A signed integral type of at most 32 bits
+ * @param value The given value
+ * @return constexpr Int The same as `nth_trit(value, Place)`; use
+ * `nth_trit<0>` in place of `lowest_trit`
+ */
+template<std::size_t Place, typename Int = int>
+constexpr Int nth_trit(Int value) noexcept
+{
+    constexpr auto power = pow3<std::uint64_t>(Place);
+
+    return static_cast<Int>((detail::biased<Place + 1>(value) / power) % 3) - 1;
+}
+
 #endif /* TRIREME_TERNARY_MATH_HPP */
\ No newline at end of file
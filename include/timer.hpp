@@ -0,0 +1,80 @@
+#ifndef TRIREME_TIMER_HPP
+#define TRIREME_TIMER_HPP
+
+#include <string>
+#include <vector>
+
+#include "device.hpp"
+#include "scheduler.hpp"
+
+namespace ternary
+{
+    /**
+     * @brief A programmable interval timer, counting retired instructions.
+     * When it runs out, it raises its interrupt line, and either starts
+     * again (periodic) or stops (one-shot). It only does anything when
+     * it runs out, through the scheduler.
+     *
+     * The guest sees it on three ports, starting at `base_port`:
+     *
+     * - control: 0 stops the timer, +1 starts it periodic, and -1 starts
+     *   it one-shot; reading gives the current mode
+     * - interval: the number of instructions between interrupts, which
+     *   must be positive for the timer to start
+     * - count: how many instructions are left before it runs out
+     */
+    class IntervalTimer final : public Device
+    {
+        public:
+        static constexpr int base_port = 248;
+
+        enum timer_mode
+        {
+            one_shot = -1,
+            stopped = 0,
+            periodic = 1
+        };
+
+        std::string name() const override { return "timer"; }
+        PortRange ports() const override { return { base_port, 3 }; }
+
+        int read(int port) override;
+        void write(int port, int value) override;
+
+        void reset() override;
+
+        // Mode, interval, and count
+        std::vector<int> save() const override;
+        void restore(const std::vector<int>& state) override;
+
+        int interrupt_lines() const override { return 1; }
+        void connect(int, InterruptLine line) override { line_ = line; }
+        void set_scheduler(Scheduler& scheduler) override { scheduler_ = &scheduler; }
+
+        // For the host
+        void start(const timer_mode m, const int interval);
+        void stop();
+
+        timer_mode mode() const noexcept { return mode_; }
+        int interval() const noexcept { return interval_; }
+        int count() const noexcept;
+
+        // The interrupt line, so the host can find its vector
+        const InterruptLine& line() const noexcept { return line_; }
+
+        private:
+        void arm(const Scheduler::time when);
+        void expire();
+
+        Scheduler* scheduler_ { nullptr };
+        InterruptLine line_ {};
+
+        timer_mode mode_ { stopped };
+        int interval_ { 0 };
+
+        Scheduler::event_id event_ { 0 };
+        Scheduler::time deadline_ { 0 };
+    };
+}
+
+#endif /* TRIREME_TIMER_HPP */
@@ -0,0 +1,59 @@
+#ifndef TRIREME_WATCHPOINTS_HPP
+#define TRIREME_WATCHPOINTS_HPP
+
+#include <cstddef>
+#include <functional>
+
+namespace ternary
+{
+    // What a watchpoint looks for. These can be combined.
+    enum watch_kind : unsigned
+    {
+        watch_read = 1,
+        watch_write = 2,
+
+        // A write that changes at least one watched hexad
+        watch_change = 4
+    };
+
+    // One access that matched a watchpoint
+    struct WatchHit
+    {
+        // The watchpoint's ID, from Cpu::add_watchpoint()
+        std::size_t id { 0 };
+
+        // watch_read, watch_write, or watch_change
+        watch_kind kind { watch_read };
+
+        // The address of the instruction that made the access
+        int ip { 0 };
+
+        // The address accessed (the low hexad, for a word), and its
+        // length in hexads
+        int address { 0 };
+        int length { 1 };
+
+        // The value in memory before and after; these are the same for
+        // a read
+        int old_value { 0 };
+        int new_value { 0 };
+    };
+
+    /**
+     * @brief A range of memory to watch, from `first` to `last` inclusive.
+     * Matching accesses by the guest stop execution, with
+     * stop_reason::watchpoint, once the instruction making them is done.
+     * If there is a callback, it decides instead: it gets each hit, and
+     * returns whether to stop.
+     */
+    struct Watchpoint
+    {
+        int first { 0 };
+        int last { 0 };
+        unsigned kinds { watch_write };
+
+        std::function<bool(const WatchHit&)> callback {};
+    };
+}
+
+#endif /* TRIREME_WATCHPOINTS_HPP */
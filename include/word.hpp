@@ -24,9 +24,9 @@ namespace ternary
         constexpr Word() = default;
 
         constexpr Word(Word::value_type v):
-            high_(shift_right(v, high_power)),
-            middle_(low_trits(shift_right(v, middle_power), middle_power)),
-            low_(low_trits(v, middle_power))
+            high_(shift_right<high_power>(v)),
+            middle_(low_trits<middle_power>(shift_right<middle_power>(v))),
+            low_(low_trits<middle_power>(v))
         {}
 
         constexpr Word(value_type hi, value_type mid, value_type lo):
@@ -53,6 +53,8 @@ namespace ternary
         void set_high(Hexad h) noexcept { high_ = h; }
         void set_high(value_type h) noexcept { high_ = h; }
 
+        trit_container trits() const noexcept;
+
         std::string raw_trit_string() const noexcept;
         std::string trit_string() const noexcept;
         std::string value_string() const noexcept;
@@ -75,13 +77,8 @@ namespace ternary
     // Addition/subtraction results have only a single trit for carries
     using addition_result = std::pair<Word, int>;
 
-    // Multiplication gives a double-precision result
-    using multiplication_result = std::pair<Word, Word>;
-
-    // Divisinn requires two types: a double-precision dividend
-    // and a quotient/remainder pair. Note that the "result" type
-    // is functionally the same, but we redefine it for clarity.
-    using division_dividend = multiplication_result;
+    // Single-precision division gives a quotient/remainder pair.
+    // (Multiplication and double-precision division are in double_word.hpp.)
     using division_result = std::pair<Word, Word>;
 
     // Shift and rotate operations can produce a carry, the same as addition
@@ -93,18 +90,51 @@ namespace ternary
     inline bool operator==(const Word& lhs, const Word& rhs) { return lhs.value() == rhs.value(); }
 
     // Arithmetic
-    addition_result add(const Word& lhs, Word rhs) noexcept;
-    addition_result add(const Word& lhs, Word::value_type rhs) noexcept;
-    addition_result sub(const Word& lhs, const Word& rhs) noexcept;
-    addition_result sub(const Word& lhs, Word::value_type rhs) noexcept;
 
-    multiplication_result mul(const Word& lhs, const Word& rhs) noexcept;
-    multiplication_result mul(const Word& lhs, Word::value_type rhs) noexcept;
+    namespace detail
+    {
+        /**
+         * @brief Wrap the sum of two values in the word range back into
+         * that range, extracting the carry trit.
+         * 
+         * @param sum A value within +/- (3**18 - 1)
+         * @return addition_result The wrapped sum and its carry
+         */
+        inline addition_result wrap_sum(Word::value_type sum) noexcept
+        {
+            constexpr auto range { pow3(Word::word_size) };
+            constexpr auto half { range / 2 };
+
+            const auto carry { (sum > half) - (sum < -half) };
+
+            return { { sum - carry * range }, carry };
+        }
+
+        // Reduce an immediate operand to the word range, the same as
+        // converting it to a Word. Almost all of them are already in it.
+        inline Word::value_type to_word_range(Word::value_type v) noexcept
+        {
+            return (abs_c(v) > pow3(Word::word_size) / 2) ? low_trits<Word::word_size>(v) : v;
+        }
+    }
+
+    // These work on the integer values of the words; a sum of two
+    // words needs only one wrap back into range.
+    inline addition_result add(const Word& lhs, const Word& rhs) noexcept
+        { return detail::wrap_sum(lhs.value() + rhs.value()); }
+    inline addition_result add(const Word& lhs, Word::value_type rhs) noexcept
+        { return detail::wrap_sum(lhs.value() + detail::to_word_range(rhs)); }
+    inline addition_result sub(const Word& lhs, const Word& rhs) noexcept
+        { return detail::wrap_sum(lhs.value() - rhs.value()); }
+    inline addition_result sub(const Word& lhs, Word::value_type rhs) noexcept
+        { return detail::wrap_sum(lhs.value() - detail::to_word_range(rhs)); }
+
+    // Reference versions, working a hexad at a time with carries
+    addition_result add_by_hexads(const Word& lhs, const Word& rhs) noexcept;
+    addition_result sub_by_hexads(const Word& lhs, const Word& rhs) noexcept;
 
     division_result div(const Word& lhs, const Word& rhs) noexcept;
     division_result div(const Word& lhs, Word::value_type rhs) noexcept;
-    division_result div(division_dividend lhs, const Word& rhs) noexcept;
-    division_result div(division_dividend lhs, Word::value_type rhs) noexcept;
 
     // Logical
     shift_result shl(const Word& operand, const Word& places) noexcept;
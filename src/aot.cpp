@@ -0,0 +1,794 @@
+#include "aot.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#endif
+
+#include "opcode.hpp"
+#include "flags.hpp"
+#include "registers.hpp"
+#include "memory.hpp"
+#include "word.hpp"
+
+namespace ternary
+{
+    namespace
+    {
+        // Addresses the translator starts from, besides the program
+        // itself: where reset() sets IP, and the default vector table
+        constexpr int boot_address { -265720 };
+        constexpr int vector_table { -204121 };
+        constexpr int vector_count { 27 };
+
+        constexpr int address_width { BasicMemory::address_width };
+        constexpr int highest_address { pow3(address_width) / 2 };
+
+        // Registers with fixed roles
+        constexpr int stack_register { -6 };
+        constexpr int return_register { -5 };
+        constexpr int vector_register { -9 };
+        constexpr int high_register { -2 };
+        constexpr int remainder_register { -8 };
+
+        // Relative branch target, computed as the CPU computes IP
+        int relative(const int address, const int disp) { return add(Word { address }, disp).first.value(); }
+
+        int next_address(const int address) { return relative(address, 3); }
+
+        // A guest register, as an element of the generated code's array
+        std::string reg(const int r)
+        {
+            return "g[" + std::to_string(r + 13) + "]";
+        }
+
+        // Assign to a guest register, unless it's rz
+        std::string assign(const int r, const std::string& value)
+        {
+            return (r == Registers::zero_register) ? "" : reg(r) + " = " + value + "; ";
+        }
+
+        // Index of a hexad_select for a memory access by O field (direct
+        // loads and stores) or M field (indirect ones)
+        int select_for_direct(const int o)
+        {
+            switch (o)
+            {
+                case 5: case -13: return 0;
+                case 6: case -12: return 1;
+                case 7: case -11: return 2;
+                default: return 3;
+            }
+        }
+
+        int select_for_indirect(const int m)
+        {
+            switch (m)
+            {
+                case 5: return 0;
+                case 6: return 1;
+                case 7: return 2;
+                default: return 3;
+            }
+        }
+
+        bool is_indirect_access(const int m) { return m == 5 || m == 6 || m == 7 || m == 9; }
+
+        bool is_kept_flag(const int f)
+        {
+            return f == static_cast<int>(flags::carry) || f == static_cast<int>(flags::sign);
+        }
+
+        // How an instruction passes control on
+        enum class flow
+        {
+            next,           // to the following instruction
+            branch,         // to a known target, or the following instruction
+            jump,           // only to a known target
+            call,           // to a known target, returning to the following instruction
+            indirect,       // to an address computed at run time
+            block_end       // to the interpreter, which will go on to the following instruction
+        };
+
+        // Classify an instruction, and get its target if it has one
+        flow control_flow(const Opcode& op, const int address, int& target)
+        {
+            switch (op.o)
+            {
+                case 0:
+                    switch (op.m)
+                    {
+                        case -11:
+                            return flow::next;
+                        case 10:
+                        case -13:
+                            // SYS, SRT
+                            return flow::indirect;
+                        default:
+                            return flow::block_end;
+                    }
+                case 10:
+                    switch (op.m)
+                    {
+                        case 0:
+                            target = op.low12();
+                            return flow::call;
+                        case -9:
+                            target = relative(address, op.low12());
+                            return flow::call;
+                        case 1:
+                            target = relative(address, op.low12());
+                            return flow::jump;
+                        case -1:
+                            target = relative(address, op.low6());
+                            return flow::jump;
+                        case 4:
+                            target = op.low12();
+                            return flow::jump;
+                        case 2:
+                        case 3:
+                        case -3:
+                        case -13:
+                            // BRI, CAR, RET
+                            return flow::indirect;
+                        default:
+                            return flow::block_end;
+                    }
+                case 11:
+                case 12:
+                case 13:
+                    if (!is_kept_flag(op.m))
+                    {
+                        return flow::block_end;
+                    }
+
+                    target = relative(address, op.low12());
+                    return flow::branch;
+                case -6:
+                    return flow::block_end;
+                default:
+                    return flow::next;
+            }
+        }
+
+        // The generated code's view of the CPU. This must stay in step
+        // with CpuState and AotHelpers.
+        const char* prelude = R"(
+namespace
+{
+    struct State
+    {
+        int registers[27];
+
+        // The flag register: S is the sign of result
+        int carry;
+        int result;
+        int others;
+
+        int ip;
+        int retired;
+        int budget;
+    };
+
+    struct Helpers
+    {
+        int (*load[4])(void*, int, int);
+        int (*store[4])(void*, int, int);
+        int (*output)(void*, int, int);
+    };
+
+    const int half = 193710244;
+    const int range = 387420489;
+
+    inline int sign_of(int v) { return (v > 0) - (v < 0); }
+
+    inline int wrap(int v) { return (v > half) ? v - range : (v < -half) ? v + range : v; }
+
+    // Wrap a sum or difference into a word, setting carry and sign
+    inline int arith(int v, int& carry, int& result)
+    {
+        carry = (v > half) ? 1 : (v < -half) ? -1 : 0;
+        v -= carry * range;
+        result = v;
+        return v;
+    }
+
+    // Split a double word, as for multiplication and division
+    inline int low_word(long long v)
+    {
+        const long long x = (v % range + range) % range;
+        return static_cast<int>(x > half ? x - range : x);
+    }
+
+    inline int high_word(long long v) { return static_cast<int>((v - low_word(v)) / range); }
+
+    // Set carry (to the sign of a double word that doesn't fit in a
+    // word) and sign
+    inline void double_flags(long long v, int& carry, int& result)
+    {
+        result = (v > 0) - (v < 0);
+        carry = (v > half || v < -half) ? result : 0;
+    }
+}
+)";
+    }
+
+    AotTranslator::AotTranslator(const data_map& image)
+    {
+        for (auto& pair : image)
+        {
+            hexads_[low_trits<address_width>(pair.first)] = pair.second.get();
+        }
+
+        // Start from the boot address, the start of the program, and
+        // any handlers in the vector table
+        std::vector<int> seeds { boot_address };
+
+        for (auto& pair : hexads_)
+        {
+            if (nth_trit<0>(pair.first) == -1 && has_word(pair.first))
+            {
+                seeds.push_back(pair.first);
+                break;
+            }
+        }
+
+        for (auto i = 0; i < vector_count; ++i)
+        {
+            const auto slot { vector_table + 3 * i };
+
+            if (has_word(slot))
+            {
+                seeds.push_back(word_at(slot));
+            }
+        }
+
+        for (auto s : seeds)
+        {
+            if (has_word(s) && nth_trit<0>(s) == -1)
+            {
+                leaders_.insert(s);
+                explore(s);
+            }
+        }
+    }
+
+    bool AotTranslator::has_word(const int address) const
+    {
+        // Only whole words inside the basic address space
+        return address >= -highest_address && address + 2 <= highest_address
+            && hexads_.count(address) && hexads_.count(address + 1) && hexads_.count(address + 2);
+    }
+
+    int AotTranslator::word_at(const int address) const
+    {
+        return Word { hexads_.at(address + 2), hexads_.at(address + 1), hexads_.at(address) }.value();
+    }
+
+    void AotTranslator::explore(int address)
+    {
+        std::vector<int> pending { address };
+
+        const auto visit = [&](const int a, const bool leader) {
+            if (!has_word(a) || nth_trit<0>(a) != -1)
+            {
+                return;
+            }
+
+            if (leader)
+            {
+                leaders_.insert(a);
+            }
+
+            if (!code_.count(a))
+            {
+                pending.push_back(a);
+            }
+        };
+
+        while (!pending.empty())
+        {
+            const auto current { pending.back() };
+            pending.pop_back();
+
+            if (!code_.insert(current).second)
+            {
+                continue;
+            }
+
+            const Opcode op { word_at(current) };
+            auto target { 0 };
+            const auto kind { control_flow(op, current, target) };
+            const auto next { next_address(current) };
+
+            switch (kind)
+            {
+                case flow::next:
+                    visit(next, false);
+
+                    // Code addresses loaded by LAD are likely to be
+                    // called or installed as handlers
+                    if (op.o == 8 && op.m == 8)
+                    {
+                        visit(op.low12(), true);
+                    }
+                    break;
+                case flow::branch:
+                    visit(target, true);
+                    visit(next, true);
+                    break;
+                case flow::jump:
+                    visit(target, true);
+                    break;
+                case flow::call:
+                    visit(target, true);
+                    visit(next, true);
+                    break;
+                case flow::indirect:
+                    // Calls through a register come back here
+                    if (op.o == 10 && op.m == -3)
+                    {
+                        visit(next, true);
+                    }
+                    break;
+                case flow::block_end:
+                    visit(next, true);
+                    break;
+            }
+        }
+    }
+
+    // Code to continue at a known address after an instruction. A branch
+    // to itself leaves IP alone, so the CPU moves on to the next one.
+    std::string AotTranslator::go_to(const int target) const
+    {
+        if (leaders_.count(target))
+        {
+            return "goto at_" + std::to_string(target + highest_address) + ";";
+        }
+
+        return "ip = " + std::to_string(target) + "; goto leave;";
+    }
+
+    std::string AotTranslator::instruction(const int address) const
+    {
+        const Opcode op { word_at(address) };
+        const auto next { next_address(address) };
+        const auto here { std::to_string(address) };
+        const auto leave_here { "ip = " + here + "; goto leave;" };
+
+        // After a store into the compiled program, which is now stale
+        const auto leave_next { "ip = " + std::to_string(next) + "; goto leave;" };
+
+        // Where a branch goes, with the rule for branching to itself
+        const auto branch_to = [&](const int target) { return go_to(target == address ? next : target); };
+        const auto dispatch { "if (ip == " + here + ") ip = " + std::to_string(next) + "; ++n; goto dispatch;" };
+
+        const auto sp { reg(stack_register) };
+
+        switch (op.o)
+        {
+            case 0:
+                switch (op.m)
+                {
+                    case -11:
+                        return "++n;";
+                    case 10:
+                        // SYS: rr = IP, and go through the table at rv
+                        return reg(return_register) + " = " + here + "; ip = wrap(" + reg(vector_register)
+                            + " + " + std::to_string(op.low6() * 3) + "); " + dispatch;
+                    case -13:
+                        // SRT
+                        return "ip = " + reg(return_register) + "; " + dispatch;
+                    default:
+                        return leave_here;
+                }
+
+            case 1:
+                switch (op.m)
+                {
+                    case -8:
+                        return "t = arith(" + reg(op.x) + " - " + std::to_string(op.low6()) + ", carry, result); ++n;";
+                    case -9:
+                        return "t = arith(" + reg(op.y) + " - " + reg(op.z) + ", carry, result); ++n;";
+                    default:
+                        return leave_here;
+                }
+
+            case 2:
+            {
+                // Products go to the destination and ro, quotients to the
+                // destination with the remainder in ru
+                const auto product = [&](const int dest, const std::string& lhs, const std::string& rhs) {
+                    return "{ const long long p = static_cast<long long>(" + lhs + ") * " + rhs + "; "
+                        + assign(dest, "low_word(p)") + assign(high_register, "high_word(p)")
+                        + "double_flags(p, carry, result); ++n; }";
+                };
+
+                const auto quotient = [&](const int dest, const std::string& dividend, const std::string& divisor) {
+                    return "{ const long long d = static_cast<long long>(" + reg(high_register) + ") * range + "
+                        + dividend + "; const int v = " + divisor + "; if (v == 0) { " + leave_here + " } "
+                        + "const long long q = d / v; " + assign(dest, "low_word(q)")
+                        + assign(remainder_register, "static_cast<int>(d % v)")
+                        + "double_flags(q, carry, result); ++n; }";
+                };
+
+                switch (op.m)
+                {
+                    case 12:
+                        return product(op.z, reg(op.x), reg(op.y));
+                    case -6:
+                        return product(op.x, reg(op.t), std::to_string(op.low6()));
+                    case -7:
+                        return product(op.t, reg(op.t), std::to_string(op.low9()));
+                    case 9:
+                        return quotient(op.z, reg(op.x), reg(op.y));
+                    case -9:
+                        // Division by an immediate zero is left to raise its interrupt
+                        return (op.low6() == 0) ? leave_here : quotient(op.x, reg(op.t), std::to_string(op.low6()));
+                    case -10:
+                        return (op.low9() == 0) ? leave_here : quotient(op.t, reg(op.t), std::to_string(op.low9()));
+                    default:
+                        return leave_here;
+                }
+            }
+
+            case 4:
+            {
+                const auto sum = [&](const int dest, const std::string& lhs, const char* sign, const std::string& rhs) {
+                    return "t = arith(" + lhs + sign + rhs + ", carry, result); " + assign(dest, "t") + "++n;";
+                };
+
+                switch (op.m)
+                {
+                    case 9:
+                        return sum(op.z, reg(op.x), " + ", reg(op.y));
+                    case -9:
+                        return sum(op.z, reg(op.x), " - ", reg(op.y));
+                    case 11:
+                        return sum(op.t, reg(op.t), " + ", std::to_string(op.low9()));
+                    case -8:
+                        return sum(op.t, reg(op.t), " - ", std::to_string(op.low9()));
+                    case 13:
+                        return sum(op.x, reg(op.t), " + ", std::to_string(op.low6()));
+                    case -6:
+                        return sum(op.x, reg(op.t), " - ", std::to_string(op.low6()));
+                    default:
+                        return leave_here;
+                }
+            }
+
+            case 5:
+            case 6:
+            case 7:
+            case 9:
+                // Direct loads into M
+                return "t = h->load[" + std::to_string(select_for_direct(op.o)) + "](cpu, "
+                    + std::to_string(op.low12()) + ", " + reg(op.m) + "); " + assign(op.m, "t")
+                    + "result = t; ++n;";
+
+            case 8:
+                switch (op.m)
+                {
+                    case 0:
+                        return assign(op.x, std::to_string(op.low6())) + "++n;";
+                    case 1:
+                        if (op.t < -1 || op.t > 1)
+                        {
+                            return leave_here;
+                        }
+
+                        return assign(op.y, std::to_string(op.t) + " * half") + "++n;";
+                    case 8:
+                        return assign(0, std::to_string(op.low12())) + "++n;";
+                    case 11:
+                        // PSH
+                        return "result = " + reg(op.z) + "; t = h->store[3](cpu, " + sp + ", " + reg(op.z)
+                            + "); " + sp + " = wrap(" + sp + " - 3); ++n; if (t) { " + leave_next + " }";
+                    case 13:
+                        // POP
+                        return sp + " = wrap(" + sp + " + 3); t = h->load[3](cpu, " + sp + ", 0); "
+                            + assign(op.z, "t") + "result = t; ++n;";
+                    case -1:
+                        return assign(op.y, reg(op.z)) + "++n;";
+                    case -4:
+                        return "t = " + reg(op.y) + "; " + assign(op.y, reg(op.z)) + assign(op.z, "t") + "++n;";
+                    default:
+                        if (!is_indirect_access(op.m))
+                        {
+                            return leave_here;
+                        }
+
+                        // Indirect loads through Y into Z
+                        return "t = h->load[" + std::to_string(select_for_indirect(op.m)) + "](cpu, "
+                            + reg(op.y) + ", " + reg(op.z) + "); " + assign(op.z, "t") + "result = t; ++n;";
+                }
+
+            case 10:
+            {
+                const auto push_return { "t = h->store[3](cpu, " + sp + ", " + std::to_string(next) + "); "
+                    + sp + " = wrap(" + sp + " - 3); " };
+
+                switch (op.m)
+                {
+                    case 0:
+                    case -9:
+                    {
+                        // CAL, CAA
+                        const auto target { (op.m == 0) ? op.low12() : relative(address, op.low12()) };
+                        const auto resolved { (target == address) ? next : target };
+
+                        return push_return + "++n; if (t) { ip = " + std::to_string(resolved) + "; goto leave; } "
+                            + go_to(resolved);
+                    }
+                    case 1:
+                        return "++n; " + branch_to(relative(address, op.low12()));
+                    case -1:
+                        return "++n; " + branch_to(relative(address, op.low6()));
+                    case 4:
+                        return "++n; " + branch_to(op.low12());
+                    case 2:
+                        return "ip = wrap(" + reg(op.x) + " + " + std::to_string(op.low6()) + "); " + dispatch;
+                    case 3:
+                        return "ip = " + reg(op.x) + "; " + dispatch;
+                    case -3:
+                        // CAR: the target register is read after the push
+                        return push_return + "ip = " + reg(op.z) + "; if (t) { if (ip == " + here + ") ip = "
+                            + std::to_string(next) + "; ++n; goto leave; } " + dispatch;
+                    case -13:
+                        return sp + " = wrap(" + sp + " + 3); ip = h->load[3](cpu, " + sp + ", 0); " + dispatch;
+                    default:
+                        return leave_here;
+                }
+            }
+
+            case 11:
+            case 12:
+            case 13:
+            {
+                if (!is_kept_flag(op.m))
+                {
+                    return leave_here;
+                }
+
+                const auto flag { (op.m == static_cast<int>(flags::carry)) ? "carry" : "sign_of(result)" };
+
+                return std::string { "++n; if (" } + flag + " == " + std::to_string(op.o - 12) + ") { "
+                    + branch_to(relative(address, op.low12())) + " }";
+            }
+
+            case -8:
+                if (op.m != -1)
+                {
+                    return leave_here;
+                }
+
+                return "s->retired = n; t = h->output(cpu, " + std::to_string(op.low9()) + ", " + reg(op.t)
+                    + "); ++n; if (t) { " + leave_next + " }";
+
+            case -9:
+            case -11:
+            case -12:
+            case -13:
+                // Direct stores from M
+                return "result = " + reg(op.m) + "; t = h->store[" + std::to_string(select_for_direct(op.o))
+                    + "](cpu, " + std::to_string(op.low12()) + ", " + reg(op.m) + "); ++n; if (t) { "
+                    + leave_next + " }";
+
+            case -10:
+                if (!is_indirect_access(op.m))
+                {
+                    return leave_here;
+                }
+
+                // Indirect stores of Y through Z
+                return "result = " + reg(op.y) + "; t = h->store[" + std::to_string(select_for_indirect(op.m))
+                    + "](cpu, " + reg(op.z) + ", " + reg(op.y) + "); ++n; if (t) { " + leave_next + " }";
+
+            default:
+                return leave_here;
+        }
+    }
+
+    std::string AotTranslator::source(const std::string& name) const
+    {
+        std::ostringstream out;
+
+        out << "// Translated from " << name << " by trireme-aot. Do not edit.\n";
+        out << prelude << '\n';
+
+        out << "extern \"C\" const int trireme_aot_version = " << abi_version << ";\n";
+
+        // Entry points, and the instructions that writes must not touch
+        const auto list = [&](const char* array, const char* count, const std::set<int>& values) {
+            out << "extern \"C\" const int " << count << " = " << values.size() << ";\n";
+            out << "extern \"C\" const int " << array << "[] = {";
+
+            auto i { 0 };
+
+            for (auto v : values)
+            {
+                out << ((i++ % 8) ? " " : "\n    ") << v << ',';
+            }
+
+            out << "\n    0\n};\n\n";
+        };
+
+        list("trireme_aot_entries", "trireme_aot_entry_count", leaders_);
+        list("trireme_aot_code", "trireme_aot_code_count", code_);
+
+        out << "extern \"C\" void trireme_aot_run(State* s, void* cpu, const Helpers* h)\n"
+            << "{\n"
+            << "    int g[27];\n"
+            << "    for (int i = 0; i < 27; ++i) g[i] = s->registers[i];\n"
+            << "    int carry = s->carry;\n"
+            << "    int result = s->result;\n"
+            << "    const int budget = s->budget;\n"
+            << "    int n = 0;\n"
+            << "    int ip = s->ip;\n"
+            << "    int t = 0;\n\n"
+            << "dispatch:\n"
+            << "    switch (ip)\n"
+            << "    {\n";
+
+        for (auto l : leaders_)
+        {
+            out << "        case " << l << ": goto at_" << (l + highest_address) << ";\n";
+        }
+
+        out << "        default: goto leave;\n"
+            << "    }\n";
+
+        auto previous { 0 };
+        auto falls_through { false };
+
+        for (auto a : code_)
+        {
+            if (falls_through && a != next_address(previous))
+            {
+                // The instruction before this one continues elsewhere
+                out << "    " << go_to(next_address(previous)) << '\n';
+            }
+
+            if (leaders_.count(a))
+            {
+                out << "\nat_" << (a + highest_address) << ":\n"
+                    << "    if (n >= budget) { ip = " << a << "; goto leave; }\n";
+            }
+
+            out << "    /* " << a << " */ " << instruction(a) << '\n';
+
+            const Opcode op { word_at(a) };
+            auto target { 0 };
+            const auto kind { control_flow(op, a, target) };
+
+            falls_through = (kind == flow::next || kind == flow::branch);
+            previous = a;
+        }
+
+        if (falls_through)
+        {
+            out << "    " << go_to(next_address(previous)) << '\n';
+        }
+
+        out << "\nleave:\n"
+            << "    for (int i = 1; i < 27; ++i) s->registers[i] = g[i];\n"
+            << "    s->carry = carry;\n"
+            << "    s->result = result;\n"
+            << "    s->retired = n;\n"
+            << "    s->ip = ip;\n"
+            << "}\n";
+
+        return out.str();
+    }
+
+    std::string AotTranslator::build(const std::string& stem, const std::string& compiler) const
+    {
+        const auto source_path { stem + ".cpp" };
+        const auto object_path { stem + ".so" };
+
+        {
+            std::ofstream file { source_path };
+
+            if (!file)
+            {
+                throw std::runtime_error { "can't write " + source_path };
+            }
+
+            file << source(stem);
+        }
+
+        const auto command { compiler + " -std=c++14 -O2 -shared -fPIC -o '" + object_path + "' '" + source_path + "'" };
+
+        if (std::system(command.c_str()) != 0)
+        {
+            throw std::runtime_error { "compiling " + source_path + " failed" };
+        }
+
+        return object_path;
+    }
+
+    AotImage::AotImage(const std::string& path)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        // dlopen searches the library path for names without a slash
+        const auto name { (path.find('/') == std::string::npos) ? "./" + path : path };
+
+        handle_ = dlopen(name.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+        if (handle_ == nullptr)
+        {
+            throw std::runtime_error { dlerror() };
+        }
+
+        const auto symbol = [this](const char* s) {
+            const auto p { dlsym(handle_, s) };
+
+            if (p == nullptr)
+            {
+                dlclose(handle_);
+                throw std::runtime_error { std::string { "missing symbol " } + s };
+            }
+
+            return p;
+        };
+
+        const auto version { *static_cast<const int*>(symbol("trireme_aot_version")) };
+
+        if (version != AotTranslator::abi_version)
+        {
+            dlclose(handle_);
+            throw std::runtime_error { "built by an incompatible version of trireme-aot" };
+        }
+
+        const auto entries { static_cast<const int*>(symbol("trireme_aot_entries")) };
+        const auto entry_count { *static_cast<const int*>(symbol("trireme_aot_entry_count")) };
+        const auto code { static_cast<const int*>(symbol("trireme_aot_code")) };
+        const auto code_count { *static_cast<const int*>(symbol("trireme_aot_code_count")) };
+
+        entry_ = reinterpret_cast<entry_point>(symbol("trireme_aot_run"));
+        entries_.insert(entries, entries + entry_count);
+        size_ = static_cast<std::size_t>(code_count);
+
+        if (code_count != 0)
+        {
+            low_ = code[0];
+            high_ = code[0] + 2;
+        }
+
+        for (auto i = 0; i < code_count; ++i)
+        {
+            low_ = std::min(low_, code[i]);
+            high_ = std::max(high_, code[i] + 2);
+        }
+
+        if (code_count != 0)
+        {
+            code_.assign(high_ - low_ + 1, false);
+
+            for (auto i = 0; i < code_count; ++i)
+            {
+                code_[code[i] - low_] = code_[code[i] - low_ + 1] = code_[code[i] - low_ + 2] = true;
+            }
+        }
+#else
+        throw std::runtime_error { "loading compiled programs isn't supported on this system" };
+#endif
+    }
+
+    AotImage::~AotImage()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if (handle_ != nullptr)
+        {
+            dlclose(handle_);
+        }
+#endif
+    }
+}
@@ -0,0 +1,117 @@
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "aot.hpp"
+#include "assembler/assembler.hpp"
+
+// Compiles an assembled program ahead of time (see AotTranslator). The
+// result is a shared object that Cpu::load_image() can run in place of
+// the interpreter.
+//
+// Usage: trireme-aot [-o stem] [--source] [--cxx compiler] program.tras
+// Writes stem.cpp and stem.so, where the stem defaults to the program's
+// path without its extension. With --source, only the C++ is written.
+
+namespace
+{
+    std::string default_stem(const std::string& path)
+    {
+        const auto slash { path.find_last_of("/\\") };
+        const auto dot { path.rfind('.') };
+
+        return (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            ? path : path.substr(0, dot);
+    }
+
+    int usage()
+    {
+        std::cerr << "usage: trireme-aot [-o stem] [--source] [--cxx compiler] program.tras\n";
+        return 2;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string program;
+    std::string stem;
+    std::string compiler { "c++" };
+    auto source_only { false };
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        const std::string arg { argv[i] };
+
+        if (arg == "-o" && i + 1 < argc)
+        {
+            stem = argv[++i];
+        }
+        else if (arg == "--cxx" && i + 1 < argc)
+        {
+            compiler = argv[++i];
+        }
+        else if (arg == "--source")
+        {
+            source_only = true;
+        }
+        else if (program.empty())
+        {
+            program = arg;
+        }
+        else
+        {
+            return usage();
+        }
+    }
+
+    if (program.empty())
+    {
+        return usage();
+    }
+
+    if (stem.empty())
+    {
+        stem = default_stem(program);
+    }
+
+    ternary::assembler::Assembler assembler {};
+    const auto data { assembler.assemble_file(program) };
+
+    if (data.empty())
+    {
+        std::cerr << program << ": assembly failed\n";
+        return 1;
+    }
+
+    try
+    {
+        const ternary::AotTranslator translator { data };
+
+        if (source_only)
+        {
+            std::ofstream file { stem + ".cpp" };
+            file << translator.source(program);
+
+            if (!file)
+            {
+                std::cerr << "can't write " << stem << ".cpp\n";
+                return 1;
+            }
+        }
+        else
+        {
+            translator.build(stem, compiler);
+        }
+
+        std::cout << program << ": " << translator.code().size() << " instructions, "
+            << translator.leaders().size() << " entry points\n";
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << program << ": " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
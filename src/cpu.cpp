@@ -1,22 +1,16 @@
+#include <stdexcept>
+
 #include "cpu.hpp"
 
 namespace ternary
 {
-    Cpu::Cpu()
+    Cpu::Cpu(const architecture a): memory(a)
     {
-        using std::placeholders::_1;
-
-        Io::read_handler_t read { std::bind(&DebugIo::read, &debug_io) };
-        Io::write_handler_t write { std::bind(&DebugIo::write, &debug_io, _1) };
-        
-        Io::read_handler_t read_control { std::bind(&DebugIo::read_control, &debug_io) };
-        Io::write_handler_t write_control { std::bind(&DebugIo::write_control, &debug_io, _1) };
-
-        io.bind(debug_io_base - 2, write);
-        io.bind(debug_io_base - 1, read);
+        connect_device(debug_io);
+        connect_device(interrupt_controller);
+        connect_device(timer);
 
-        io.bind(debug_io_base, read_control);
-        io.bind(debug_io_base, write_control);
+        memory.set_watcher(watch_access, this);
     }
 
     /**
@@ -25,14 +19,328 @@ namespace ternary
      */
     void Cpu::reset()
     {
-        registers.clear_all();
+        state = {};
         std::fill(control_regs.begin(), control_regs.end(), 0);
-        std::fill(debug_regs.begin(), debug_regs.end(), 0);
-        flag_register = {};
 
-        instruction_pointer.set(0, Hexad::min_value, Hexad::min_value);
+        for (auto i = 0u; i < debug_regs.size(); ++i)
+        {
+            set_debug_register(i, 0);
+        }
+
+        state.ip = Word { 0, Hexad::min_value, Hexad::min_value }.value();
         control_regs[2].set(0, -280, -1);
-        registers.set(-9, { 0, -283, -364});
+        state.registers.set(-9, { 0, -283, -364});
+
+        pending_hits.clear();
+        watch_pending = false;
+        interrupts_were_enabled = false;
+
+        for (const auto d : devices)
+        {
+            d->reset();
+        }
+    }
+
+    /**
+     * @brief Set a breakpoint for the host. Any blocks holding the
+     * instruction there are discarded, so that it will start a new one.
+     * 
+     * @param address The address of the instruction
+     */
+    void Cpu::set_breakpoint(const int address)
+    {
+        const auto a { memory.wrap(align(address)) };
+
+        if (host_breakpoints.insert(a).second)
+        {
+            breakpoints.mark(a, breakpoint_map::host);
+            block_cache.invalidate_word(a);
+        }
+    }
+
+    /**
+     * @brief Remove a host breakpoint, if there is one.
+     * 
+     * @param address The address of the instruction
+     */
+    void Cpu::clear_breakpoint(const int address)
+    {
+        const auto a { memory.wrap(align(address)) };
+
+        if (host_breakpoints.erase(a) != 0)
+        {
+            breakpoints.unmark(a, breakpoint_map::host);
+            block_cache.invalidate_word(a);
+
+            // On the advanced architecture, another breakpoint could
+            // share the mark
+            for (const auto other : host_breakpoints)
+            {
+                breakpoints.mark(other, breakpoint_map::host);
+            }
+        }
+    }
+
+    /**
+     * @brief Add a watchpoint on memory.
+     * 
+     * @param w The range to watch, what to watch for, and an optional
+     * callback to decide whether a hit stops execution
+     * @return std::size_t An ID for the watchpoint
+     */
+    std::size_t Cpu::add_watchpoint(const Watchpoint& w)
+    {
+        const auto half { memory.range() / 2 };
+
+        if (w.first > w.last || w.first < -half || w.last > half)
+        {
+            throw std::out_of_range("watchpoint range isn't in memory");
+        }
+
+        const auto id { next_watchpoint++ };
+        watchpoints.emplace(id, w);
+        update_watched_pages();
+
+        return id;
+    }
+
+    /**
+     * @brief Remove a watchpoint, if there is one with the given ID.
+     * 
+     * @param id The ID from add_watchpoint()
+     */
+    void Cpu::remove_watchpoint(const std::size_t id)
+    {
+        watchpoints.erase(id);
+        update_watched_pages();
+    }
+
+    /**
+     * @brief Attach a device, which the CPU will call through the Device
+     * interface.
+     * 
+     * @param device The device
+     * @return Device& The device, now owned by the CPU
+     * @throw std::invalid_argument if any of its ports are taken
+     */
+    Device& Cpu::attach(std::unique_ptr<Device> device)
+    {
+        connect_device<Device>(*device);
+        owned_devices.push_back(std::move(device));
+
+        return *owned_devices.back();
+    }
+
+    /**
+     * @brief Load a device from a shared object and attach it.
+     * 
+     * @param path The path of the shared object
+     * @param args Arguments for the device
+     * @return Device& The device
+     * @throw std::runtime_error if the plugin can't be loaded
+     * @throw std::invalid_argument if any of its ports are taken
+     */
+    Device& Cpu::load_device(const std::string& path, const std::string& args)
+    {
+        std::unique_ptr<DevicePlugin> plugin { new DevicePlugin(path, args) };
+        auto& device { plugin->device() };
+
+        connect_device<Device>(device);
+        plugins.push_back(std::move(plugin));
+
+        return device;
+    }
+
+    std::vector<std::vector<int>> Cpu::save_devices() const
+    {
+        std::vector<std::vector<int>> states;
+
+        for (const auto d : devices)
+        {
+            states.push_back(d->save());
+        }
+
+        return states;
+    }
+
+    void Cpu::restore_devices(const std::vector<std::vector<int>>& states)
+    {
+        for (auto i = 0u; i < states.size() && i < devices.size(); ++i)
+        {
+            devices[i]->restore(states[i]);
+        }
+    }
+
+    PortRange Cpu::check_ports(const Device& device) const
+    {
+        const auto range { device.ports() };
+
+        if (range.count <= 0 || range.count > Io::port_count)
+        {
+            throw std::invalid_argument { "device " + device.name() + " has no ports" };
+        }
+
+        if (device.interrupt_lines() > InterruptController::max_lines - interrupt_controller.lines_used())
+        {
+            throw std::invalid_argument { "not enough interrupt lines left for device " + device.name() };
+        }
+
+        for (auto port = range.first; port < range.first + range.count; ++port)
+        {
+            if (io.bound(port, RW::read) || io.bound(port, RW::write))
+            {
+                throw std::invalid_argument { "port " + std::to_string(port) + " for device "
+                    + device.name() + " is already in use" };
+            }
+        }
+
+        return range;
+    }
+
+    void Cpu::add_device(Device& device)
+    {
+        devices.push_back(&device);
+        device.set_scheduler(scheduler);
+
+        if (device.ticks())
+        {
+            ticking_devices.push_back(&device);
+        }
+
+        const auto count { device.interrupt_lines() };
+        const auto first { interrupt_controller.allocate(count) };
+
+        for (auto i = 0; i < count; ++i)
+        {
+            device.connect(i, { InterruptController::set_line, &interrupt_controller, first + i });
+        }
+    }
+
+    void Cpu::update_watched_pages()
+    {
+        memory.unwatch_all();
+
+        for (const auto& pair : watchpoints)
+        {
+            memory.watch(pair.second.first, pair.second.last);
+        }
+    }
+
+    void Cpu::watch_access(void* context, int address, int length, bool write, int value)
+    {
+        const auto c { static_cast<Cpu*>(context) };
+        const Word data { value };
+
+        // Writes come in before they happen, so memory still has the
+        // old value
+        const auto old_value { (length == 1) ? c->memory.peek(address).get() : c->memory.peek_word(address).value() };
+
+        for (const auto& pair : c->watchpoints)
+        {
+            const auto& w { pair.second };
+            auto covered { false };
+            auto changed { false };
+
+            for (auto i = 0; i < length; ++i)
+            {
+                const auto a { c->memory.wrap(address + i) };
+
+                if (a >= w.first && a <= w.last)
+                {
+                    const auto before { c->memory.peek(a).get() };
+                    const auto after { (length == 1) ? value
+                        : (i == 0) ? data.low().get() : (i == 1) ? data.middle().get() : data.high().get() };
+
+                    covered = true;
+                    changed = changed || before != after;
+                }
+            }
+
+            if (!covered)
+            {
+                continue;
+            }
+
+            WatchHit hit { pair.first, watch_read, 0, address, length, old_value, write ? value : old_value };
+
+            if (!write && (w.kinds & watch_read))
+            {
+                hit.kind = watch_read;
+            }
+            else if (write && (w.kinds & watch_write))
+            {
+                hit.kind = watch_write;
+            }
+            else if (write && changed && (w.kinds & watch_change))
+            {
+                hit.kind = watch_change;
+            }
+            else
+            {
+                continue;
+            }
+
+            c->pending_hits.push_back(hit);
+            c->watch_pending = true;
+        }
+    }
+
+    bool Cpu::report_watch_hits(const int current_ip)
+    {
+        // Callbacks may change the watchpoints, or throw
+        auto hits { std::move(pending_hits) };
+        auto stop { false };
+
+        pending_hits.clear();
+        watch_pending = false;
+
+        for (auto& hit : hits)
+        {
+            hit.ip = current_ip;
+
+            const auto found { watchpoints.find(hit.id) };
+
+            if (found == watchpoints.end())
+            {
+                continue;
+            }
+
+            const auto& callback { found->second.callback };
+
+            if (!callback || callback(hit))
+            {
+                stop = true;
+            }
+        }
+
+        if (stop)
+        {
+            stopped_hits = std::move(hits);
+        }
+
+        return stop;
+    }
+
+    void Cpu::set_debug_register(const std::size_t index, const Word& value)
+    {
+        auto& dr_n { debug_regs.at(index) };
+
+        // Two registers can hold the same address, so unmark them all
+        // and mark them again. A block holding one of the addresses has
+        // to end there, so those blocks go too.
+        for (auto& dr : debug_regs)
+        {
+            breakpoints.unmark(dr.value(), breakpoint_map::debug_register);
+        }
+
+        block_cache.invalidate(dr_n.value());
+        dr_n = value;
+        block_cache.invalidate(value.value());
+
+        for (auto& dr : debug_regs)
+        {
+            breakpoints.mark(dr.value(), breakpoint_map::debug_register);
+        }
     }
 
     /**
@@ -42,6 +350,13 @@ namespace ternary
     void Cpu::clear_memory()
     {
         memory.clear();
+        decode_cache.clear();
+        block_cache.clear();
+
+        if (aot)
+        {
+            aot->invalidate();
+        }
     }
 
     /**
@@ -54,105 +369,927 @@ namespace ternary
     {
         for (auto& pair : data)
         {
-            memory.set(pair.first, pair.second);
+            poke(pair.first, pair.second);
+        }
+    }
+
+    namespace
+    {
+        BlockResult block_result(const std::size_t retired, const stop_reason stop)
+        {
+            return { retired, stop == stop_reason::halt || stop == stop_reason::breakpoint, stop };
+        }
+    }
+
+    std::string to_string(stop_reason r)
+    {
+        switch (r)
+        {
+            case stop_reason::none:
+                return "none";
+            case stop_reason::halt:
+                return "halt";
+            case stop_reason::breakpoint:
+                return "breakpoint";
+            case stop_reason::watchpoint:
+                return "watchpoint";
+            case stop_reason::interrupt:
+                return "interrupt";
+            case stop_reason::budget:
+                return "budget";
+            case stop_reason::target:
+                return "target";
+            case stop_reason::error:
+                return "error";
+        }
+
+        return {};
+    }
+
+    /**
+     * @brief Start the simulated CPU. This begins execution at
+     * address %00zzzz and runs until a breakpoint, a BRK, or an error.
+     * 
+     * @return RunResult Why it stopped, and how many instructions it ran
+     */
+    RunResult Cpu::run()
+    {
+        reset();
+
+        return run_for(unlimited);
+    }
+
+    /**
+     * @brief Run up to a given number of instructions, in the current
+     * execution mode.
+     * 
+     * @param budget The most instructions to run
+     * @param stop_on_interrupt Whether to stop after delivering an
+     * interrupt, as well as at a breakpoint or BRK
+     * @return RunResult Why it stopped, and how many instructions it ran
+     */
+    RunResult Cpu::run_for(const std::size_t budget, const bool stop_on_interrupt)
+    {
+        const auto result { run_blocks(budget, false, 0, stop_on_interrupt) };
+        debug_io.flush();
+
+        return result;
+    }
+
+    /**
+     * @brief Run until IP reaches an address. Blocks are cut short where
+     * they would run past it, so this is still (mostly) a block at a time.
+     * 
+     * @param address The address to stop at
+     * @param budget The most instructions to run
+     * @param stop_on_interrupt Whether to stop after delivering an
+     * interrupt, as well as at a breakpoint or BRK
+     * @return RunResult Why it stopped, and how many instructions it ran
+     */
+    RunResult Cpu::run_until(const int address, const std::size_t budget, const bool stop_on_interrupt)
+    {
+        const auto result { run_blocks(budget, true, address, stop_on_interrupt) };
+        debug_io.flush();
+
+        return result;
+    }
+
+    /**
+     * @brief Run until a condition holds, checking it after every
+     * instruction.
+     * 
+     * @param done The condition
+     * @param budget The most instructions to run
+     * @param stop_on_interrupt Whether to stop after delivering an
+     * interrupt, as well as at a breakpoint or BRK
+     * @return RunResult Why it stopped, and how many instructions it ran
+     */
+    RunResult Cpu::run_until(const std::function<bool(const Cpu&)>& done, const std::size_t budget,
+        const bool stop_on_interrupt)
+    {
+        const auto result { run_steps(done, budget, stop_on_interrupt) };
+        debug_io.flush();
+
+        return result;
+    }
+
+    RunResult Cpu::run_steps(const std::function<bool(const Cpu&)>& done, const std::size_t budget,
+        const bool stop_on_interrupt)
+    {
+        RunResult result {};
+
+        try
+        {
+            while (result.retired < budget)
+            {
+                const auto stop { step_one().stop };
+                ++result.retired;
+
+                if (stops(stop, stop_on_interrupt))
+                {
+                    poll_devices(1);
+                    result.reason = stop;
+                    return result;
+                }
+
+                if (poll_devices(1) && stop_on_interrupt)
+                {
+                    result.reason = stop_reason::interrupt;
+                    return result;
+                }
+
+                if (at_host_breakpoint())
+                {
+                    result.reason = stop_reason::breakpoint;
+                    return result;
+                }
+
+                if (done(*this))
+                {
+                    result.reason = stop_reason::target;
+                    return result;
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            result.reason = stop_reason::error;
+            result.error = e.what();
+            return result;
+        }
+
+        result.reason = stop_reason::budget;
+        return result;
+    }
+
+    RunResult Cpu::run_blocks(const std::size_t budget, const bool has_target, const int target,
+        const bool stop_on_interrupt)
+    {
+        RunResult result {};
+
+        try
+        {
+            while (result.retired < budget)
+            {
+                // Stop in time for the next event
+                auto limit { std::min<std::size_t>(budget - result.retired, scheduler.until_next()) };
+                auto use_image { true };
+
+                if (has_target)
+                {
+                    // Stop a block short of the target, and stay out of a
+                    // compiled program that might run through it
+                    const auto distance { target - state.ip };
+
+                    if (distance >= 0 && distance % 3 == 0)
+                    {
+                        limit = std::min(limit, std::max(std::size_t { 1 }, static_cast<std::size_t>(distance / 3)));
+                    }
+
+                    use_image = !(aot && aot->covers(target));
+                }
+
+                const auto block { (mode == execution_mode::step) ? step_one() : run_block(limit, use_image) };
+                result.retired += block.retired;
+
+                if (stops(block.stop, stop_on_interrupt))
+                {
+                    poll_devices(block.retired);
+                    result.reason = block.stop;
+                    return result;
+                }
+
+                if (poll_devices(block.retired) && stop_on_interrupt)
+                {
+                    result.reason = stop_reason::interrupt;
+                    return result;
+                }
+
+                if (at_host_breakpoint())
+                {
+                    result.reason = stop_reason::breakpoint;
+                    return result;
+                }
+
+                if (has_target && state.ip == target)
+                {
+                    result.reason = stop_reason::target;
+                    return result;
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            result.reason = stop_reason::error;
+            result.error = e.what();
+            return result;
+        }
+
+        result.reason = stop_reason::budget;
+        return result;
+    }
+
+    /**
+     * @brief Execute a single instruction on the simulated CPU.
+     * 
+     * @return true if it hit a debug breakpoint (including BRK)
+     */
+    bool Cpu::step()
+    {
+        const auto result { step_one() };
+        poll_devices(1);
+        debug_io.flush();
+
+        return result.breakpoint;
+    }
+
+    /**
+     * @brief Execute the basic block at IP, in the current execution mode.
+     * 
+     * @return BlockResult The number of instructions executed, and
+     * whether the last one delivered an interrupt
+     */
+    BlockResult Cpu::step_block()
+    {
+        const auto result { run_block(unlimited, true) };
+        poll_devices(result.retired);
+        debug_io.flush();
+
+        return result;
+    }
+
+    BlockResult Cpu::step_one()
+    {
+        const auto current_ip { state.ip };
+        start_block();
+
+        execute(fetch(current_ip));
+
+        return block_result(1, retire(current_ip));
+    }
+
+    /**
+     * @brief Finish executing the instruction at a given address.
+     * 
+     * @param current_ip The address of the instruction
+     * @return stop_reason The kind of interrupt delivered, if any
+     */
+    stop_reason Cpu::retire(const int current_ip)
+    {
+        auto stop { stop_reason::none };
+
+        // If debug breakpoints are enabled, check to see whether we
+        // have reached one. If so, raise the interrupt. The map rules
+        // out almost every address before anything else is looked at.
+        if (!interrupt_pending &&
+            breakpoints.has(current_ip, breakpoint_map::debug_register) &&
+            state.flag_register.get_flag(flags::trap) &&
+            std::find(debug_regs.cbegin(), debug_regs.cend(), Word { current_ip }) != debug_regs.cend()
+        )
+        {
+            raise(interrupts::debug_breakpoint);
+            stop = stop_reason::breakpoint;
+        }
+
+        if (interrupt_pending)
+        {
+            // Otherwise, a debug breakpoint comes from BRK
+            if (stop == stop_reason::none)
+            {
+                stop = (pending_interrupt == interrupts::debug_breakpoint)
+                    ? stop_reason::halt : stop_reason::interrupt;
+            }
+
+            deliver_interrupt();
+        }
+
+        // Watchpoints stop execution after the instruction, unless it
+        // stopped for a breakpoint anyway
+        if (watch_pending && report_watch_hits(current_ip)
+            && (stop == stop_reason::none || stop == stop_reason::interrupt))
+        {
+            stop = stop_reason::watchpoint;
+        }
+        
+        // Branch, call, return, and syscall/sysret will all change IP.
+        // If they don't, then we increment it by 3 (instructions are
+        // word-aligned on our architecture.)
+        if (state.ip == current_ip)
+        {
+            state.ip = next_instruction(current_ip);
+        }
+
+        return stop;
+    }
+
+    /**
+     * @brief Execute the basic block starting at IP: instructions up to
+     * and including the next one that can transfer control. The block is
+     * translated the first time it runs, and kept until something writes
+     * to its memory. Execution leaves the block early if an instruction
+     * raises an interrupt or hits a watchpoint, or if the block is
+     * overwritten.
+     * 
+     * If the block is longer than the limit, this runs a single
+     * instruction instead. Addresses in DR1-4 always end a block, so
+     * breakpoints work as they do for step().
+     * 
+     * @param limit The most instructions to run
+     * @param use_image Whether to run a compiled program, if one is loaded
+     * @return BlockResult The number of instructions executed, and
+     * whether the last one delivered an interrupt
+     */
+    BlockResult Cpu::run_block(const std::size_t limit, const bool use_image)
+    {
+        const auto start { state.ip };
+        start_block();
+        auto block { cacheable(start) ? block_cache.lookup(start) : nullptr };
+
+        if (block == nullptr)
+        {
+            return step_one();
+        }
+
+        // Compiled code assumes A = 0 and 12-trit addresses, and doesn't
+        // check breakpoints or watchpoints
+        const auto compiled_ok { state.flag_register.get_flag(flags::absolute) == 0
+            && state.flag_register.get_flag(flags::trap) == 0 && watchpoints.empty() && !memory.advanced() };
+
+        // A program compiled ahead of time runs wherever it can be
+        // entered, as long as it can't run into a host breakpoint
+        if (use_image && compiled_ok && aot && host_breakpoints.empty() && aot->has_entry(start)
+            && limit > aot->size())
+        {
+            const auto result { run_image(limit) };
+
+            // If it stopped at once, the interpreter has to take the
+            // first instruction
+            if (result.retired != 0)
+            {
+                return result;
+            }
+        }
+
+        if (!block->translated())
+        {
+            translate(start, *block);
+        }
+
+        if (block->length > limit)
+        {
+            return step_one();
+        }
+
+        // A compiled block loops back to its start without returning, so
+        // it can't be used if there's a host breakpoint there
+        if (mode == execution_mode::jit && jit && compiled_ok && !breakpoints.has(start, breakpoint_map::host))
+        {
+            if (block->native == nullptr && ++block->runs == jit_threshold)
+            {
+                block->native = jit->compile(*this, start, *block);
+
+                if (jit->flushed())
+                {
+                    // All the older code is gone
+                    const auto native { block->native };
+                    block_cache.forget_native();
+                    block->native = native;
+                }
+            }
+
+            if (block->native != nullptr)
+            {
+                return run_native(*block->native, block->length, limit);
+            }
+        }
+
+        const auto generation { block_cache.generation() };
+        const auto count { block->ops.size() };
+        BlockResult result {};
+
+        for (auto i = 0u; i < count; ++i)
+        {
+            // Copy the op, since running it may discard the block
+            const auto entry { block->ops[i] };
+            const auto last { i + 1 == count };
+
+            // Only the last instruction of a block can read or change IP
+            // (or the flags that step() checks), so the others run without
+            // keeping it up to date. Fused pairs move it on halfway through,
+            // which shows how far they got.
+            if (last || entry.count > 1)
+            {
+                state.ip = entry.address;
+            }
+
+            block_position = result.retired;
+            execute(entry.op);
+
+            if (last || stop_pending())
+            {
+                const auto first_only { entry.count > 1 && stop_pending()
+                    && state.ip == entry.address };
+                const auto current { first_only ? entry.address : entry.last };
+
+                if (!last && entry.count == 1)
+                {
+                    state.ip = current;
+                }
+
+                const auto retired { result.retired + (first_only ? 1 : entry.count) };
+                return block_result(retired, retire(current));
+            }
+
+            result.retired += entry.count;
+
+            if (block_cache.generation() != generation || device_needs_cpu())
+            {
+                // Something wrote to this block, so pick up from the
+                // next instruction with a fresh translation, or a device
+                // needs the CPU to look before going on
+                state.ip = next_instruction(entry.last);
+                break;
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Choose how run() executes instructions. Switching to jit mode
+     * sets up the compiler, if the host supports it.
+     * 
+     * @param m The new mode
+     */
+    void Cpu::set_execution_mode(execution_mode m)
+    {
+        mode = m;
+
+        if (mode == execution_mode::jit && !jit && Jit::supported())
+        {
+            jit.reset(new Jit());
+
+            if (!jit->available())
+            {
+                jit.reset();
+            }
+        }
+    }
+
+    /**
+     * @brief Run compiled code for the block at IP. The code works on
+     * the CPU's state in place.
+     * 
+     * @param native The compiled block
+     * @param length The length of the block
+     * @param limit The most instructions to run
+     * @return BlockResult The number of instructions executed (more than
+     * the block's length, if it loops)
+     */
+    BlockResult Cpu::run_native(const CompiledBlock& native, const std::size_t length, const std::size_t limit)
+    {
+        // The code checks its budget each time it gets back to the start
+        // of the block, so it can run up to a block's length past it
+        state.retired = 0;
+        state.budget = static_cast<int>(std::min<std::size_t>(jit_budget, limit - length + 1));
+
+        native.code(&state, this);
+
+        return { static_cast<std::size_t>(state.retired), false };
+    }
+
+    /**
+     * @brief Load a program compiled by trireme-aot. It takes over from
+     * the interpreter at any of its entry points, until something
+     * overwrites its code.
+     * 
+     * @param path The path of the shared object
+     */
+    void Cpu::load_image(const std::string& path)
+    {
+        aot.reset(new AotImage(path));
+    }
+
+    /**
+     * @brief Run the compiled program from IP. Like compiled blocks, it
+     * works on the CPU's state in place.
+     * 
+     * @param limit The most instructions to run
+     * @return BlockResult The number of instructions executed, which is
+     * 0 if the program couldn't run the instruction at IP
+     */
+    BlockResult Cpu::run_image(const std::size_t limit)
+    {
+        // The program checks its budget at each block leader, and the
+        // code between two of those can't be longer than the program
+        state.retired = 0;
+        state.budget = static_cast<int>(std::min<std::size_t>(jit_budget, limit - aot->size()));
+
+        aot->entry()(&state, this, &aot_helpers());
+
+        return { static_cast<std::size_t>(state.retired), false };
+    }
+
+    const AotHelpers& Cpu::aot_helpers()
+    {
+        using hs = hexad_select;
+
+        // Memory access is the same as for the JIT, except that a store
+        // reports a write into the compiled program instead of a block
+        static const AotHelpers helpers {
+            {
+                [](void* c, int a, int v) { return jit_load<hs::low>(static_cast<Cpu*>(c), a, v); },
+                [](void* c, int a, int v) { return jit_load<hs::middle>(static_cast<Cpu*>(c), a, v); },
+                [](void* c, int a, int v) { return jit_load<hs::high>(static_cast<Cpu*>(c), a, v); },
+                [](void* c, int a, int v) { return jit_load<hs::full_word>(static_cast<Cpu*>(c), a, v); }
+            },
+            {
+                [](void* c, int a, int v) {
+                    const auto cpu { static_cast<Cpu*>(c) };
+                    jit_store<hs::low>(cpu, a, v);
+                    return cpu->aot->valid() ? 0 : 1;
+                },
+                [](void* c, int a, int v) {
+                    const auto cpu { static_cast<Cpu*>(c) };
+                    jit_store<hs::middle>(cpu, a, v);
+                    return cpu->aot->valid() ? 0 : 1;
+                },
+                [](void* c, int a, int v) {
+                    const auto cpu { static_cast<Cpu*>(c) };
+                    jit_store<hs::high>(cpu, a, v);
+                    return cpu->aot->valid() ? 0 : 1;
+                },
+                [](void* c, int a, int v) {
+                    const auto cpu { static_cast<Cpu*>(c) };
+                    jit_store<hs::full_word>(cpu, a, v);
+                    return cpu->aot->valid() ? 0 : 1;
+                }
+            },
+            [](void* c, int port, int v) {
+                // The program stores how far it's got before calling this
+                const auto cpu { static_cast<Cpu*>(c) };
+                cpu->block_position = static_cast<std::size_t>(cpu->state.retired);
+                cpu->use_port(port, RW::write);
+                cpu->io.write(port, Word { v });
+
+                return cpu->device_needs_cpu() ? 1 : 0;
+            }
+        };
+
+        return helpers;
+    }
+
+    void Cpu::overwrite_image(const int address, const int length)
+    {
+        for (auto i = 0; i < length; ++i)
+        {
+            if (aot->covers(low_trits<BasicMemory::address_width>(address + i)))
+            {
+                aot->invalidate();
+                return;
+            }
+        }
+    }
+
+    template<hexad_select Select>
+    int Cpu::jit_load(Cpu* c, int address, int current)
+    {
+        Word a { address };
+        Word result { current };
+
+        // As in load_register_indirect, with the A flag clear
+        a.set_high(0);
+
+        switch (Select)
+        {
+            case hexad_select::low:
+                result.set_low(c->memory.get(a.value()));
+                break;
+            case hexad_select::middle:
+                result.set_middle(c->memory.get(a.value()));
+                break;
+            case hexad_select::high:
+                result.set_high(c->memory.get(a.value()));
+                break;
+            case hexad_select::full_word:
+                result = c->memory.get_word(a.value());
+                break;
+        }
+
+        return result.value();
+    }
+
+    template<hexad_select Select>
+    int Cpu::jit_store(Cpu* c, int address, int value)
+    {
+        Word a { address };
+        const Word data { value };
+        const auto generation { c->block_cache.generation() };
+
+        // As in store_register_indirect, with the A flag clear
+        a.set_high(0);
+
+        switch (Select)
+        {
+            case hexad_select::low:
+                c->store(a.value(), data.low());
+                break;
+            case hexad_select::middle:
+                c->store(a.value(), data.middle());
+                break;
+            case hexad_select::high:
+                c->store(a.value(), data.high());
+                break;
+            case hexad_select::full_word:
+                c->store_word(a.value(), data);
+                break;
+        }
+
+        return c->block_cache.generation() != generation;
+    }
+
+    template int Cpu::jit_load<hexad_select::low>(Cpu*, int, int);
+    template int Cpu::jit_load<hexad_select::middle>(Cpu*, int, int);
+    template int Cpu::jit_load<hexad_select::high>(Cpu*, int, int);
+    template int Cpu::jit_load<hexad_select::full_word>(Cpu*, int, int);
+    template int Cpu::jit_store<hexad_select::low>(Cpu*, int, int);
+    template int Cpu::jit_store<hexad_select::middle>(Cpu*, int, int);
+    template int Cpu::jit_store<hexad_select::high>(Cpu*, int, int);
+    template int Cpu::jit_store<hexad_select::full_word>(Cpu*, int, int);
+
+    /**
+     * @brief Transfer control to the handler for the pending interrupt.
+     * 
+     */
+    void Cpu::deliver_interrupt()
+    {
+        interrupt_pending = false;
+
+        // Give the handler one instruction (or block) to disable device
+        // interrupts, before one of them can overwrite CR3
+        interrupts_were_enabled = false;
+
+        vector_to(static_cast<int>(pending_interrupt));
+    }
+
+    /**
+     * @brief Take the device interrupt with the highest priority, once
+     * poll_devices() has found that device interrupts are enabled. This
+     * clears the I flag, so that the handler isn't interrupted in turn;
+     * it can set the flag again just before it returns.
+     * 
+     * @return true if an interrupt was taken
+     */
+    bool Cpu::take_device_interrupt()
+    {
+        const auto line { interrupt_controller.acknowledge() };
+
+        if (line < 0)
+        {
+            return false;
+        }
+
+        state.flag_register.set_flag(flags::interrupt, 0);
+        interrupts_were_enabled = false;
+
+        vector_to(InterruptController::first_vector + line);
+        return true;
+    }
+
+    void Cpu::vector_to(const int number)
+    {
+        // The hardware interrupt vector table is stored in
+        // the CR2 register. We take the interrupt # as an
+        // index into this table.
+        Word interrupt_vector { add(control_regs[2], number*3).first };
+        Word interrupt_address { get_memory_word(interrupt_vector.value()) };
+
+        // Save the current IP into CR3
+        control_regs[3].set(state.ip);
+
+        // Now jump to the interrupt handler
+        state.ip = interrupt_address.value();
+    }
+
+    /**
+     * @brief Get the decoded form of the instruction at a given address.
+     * Word-aligned instructions are decoded once and cached until something
+     * writes to their memory; unaligned ones are decoded on every fetch.
+     * 
+     * @param address The address of the instruction
+     * @return MicroOp The decoded instruction
+     */
+    MicroOp Cpu::fetch(const int address)
+    {
+        auto slot { cacheable(address) ? decode_cache.lookup(address) : nullptr };
+
+        if (slot == nullptr)
+        {
+            return decode_major(memory.peek_word(address));
+        }
+
+        if (slot->handler == nullptr)
+        {
+            *slot = decode_major(memory.peek_word(address));
         }
+
+        // Return a copy, because executing the instruction
+        // may overwrite (and thus invalidate) its own slot.
+        return *slot;
     }
 
     /**
-     * @brief Start the simulated CPU. This begins execution at
-     * address %00zzzz and runs until an unhandled exception or
-     * a special debug I/O write.
+     * @brief Translate the basic block starting at an address. Each
+     * instruction is decoded (through the decode cache) into the block,
+     * except that pairs which commonly appear together are fused into
+     * one superinstruction.
      * 
+     * @param address The address of the first instruction
+     * @param block The (empty) block to fill in
      */
-    void Cpu::run()
+    void Cpu::translate(const int address, Block& block)
     {
-        // TODO
-        reset();
+        const auto capacity { block_cache.capacity(address) };
+        auto current { address };
 
-        while (true)
+        while (block.length < capacity)
         {
-            auto breakpoint { step() };
+            // A host breakpoint always starts a block
+            if (current != address && breakpoints.has(current, breakpoint_map::host))
+            {
+                break;
+            }
+
+            const Opcode op { memory.peek_word(current) };
+            const auto next { current + 3 };
+
+            // An address in DR1-4 ends the block, so that retire() sees it
+            const auto watched { breakpoints.has(current, breakpoint_map::debug_register) };
+
+            if (!watched && block.length + 1 < capacity && !breakpoints.has(next, breakpoint_map::host))
+            {
+                const Opcode following { memory.peek_word(next) };
+                const auto fused { fuse(op, following) };
+
+                if (fused.handler != nullptr)
+                {
+                    block.ops.push_back({ fused, current, next, 2 });
+                    block.length += 2;
+                    current = next + 3;
+
+                    if (ends_block(following) || breakpoints.has(next, breakpoint_map::debug_register))
+                    {
+                        break;
+                    }
 
-            if (breakpoint)
+                    continue;
+                }
+            }
+
+            block.ops.push_back({ fetch(current), current, current, 1 });
+            block.length += 1;
+            current = next;
+
+            if (ends_block(op) || watched)
             {
                 break;
             }
         }
+
+        block_cache.commit(address);
     }
 
-    /**
-     * @brief Execute a single instruction on the simulated CPU.
-     * 
-     */
-    bool Cpu::step()
+    bool Cpu::ends_block(const Opcode& op)
     {
-        // TODO
-        auto current_ip { instruction_pointer };
-
-        bool breakpoint_encountered { false };
+        switch (op.o)
+        {
+            case 0:
+                // Everything but NOP: SYS, SRT, and BRK transfer control,
+                // and SLR and SSR can read or write IP and the flags
+                return op.m != -11;
+            case -6:
+                // Setting a flag may enable breakpoints
+                return true;
+            case 10:
+            case 11:
+            case 12:
+            case 13:
+                // All branches, calls, and returns
+                return true;
+            default:
+                return false;
+        }
+    }
 
-        // We wrap the main fetch/decode loop in a try/catch
-        // for easier handling of interrupts (since we represent
-        // them as exceptions.)
-        try
+    namespace
+    {
+        // Choose the handler for a flag branch (BNf, BZf, or BPf)
+        MicroOp::handler_type by_branch_target(const Opcode& branch, MicroOp::handler_type negative,
+            MicroOp::handler_type zero, MicroOp::handler_type positive)
         {
-            Opcode instruction { memory.get_word(current_ip.value()) };
-            decode_major(instruction);
-            
-            // If debug breakpoints are enabled, check to see whether we
-            // have reached one. If so, raise the interrupt.
-            if (flag_register.get_flag(flags::trap) &&
-                std::find(debug_regs.cbegin(), debug_regs.cend(), current_ip) != debug_regs.cend()
-            )
+            switch (branch.o)
             {
-                throw debug_breakpoint{};
+                case 11:
+                    return negative;
+                case 12:
+                    return zero;
+                default:
+                    return positive;
             }
         }
-        catch (const system_interrupt_base& e)
+
+        bool is_flag_branch(const Opcode& op) { return op.o >= 11 && op.o <= 13; }
+    }
+
+    MicroOp Cpu::fuse(const Opcode& first, const Opcode& second)
+    {
+        // CMI rX, imm; Bxf addr
+        if (first.o == 1 && first.m == -8 && is_flag_branch(second))
         {
-            // Architecture interrupts are all derived from the
-            // `system_interrupt_base` class, and they all have
-            // a `value()` method that gives their interrupt #.
-            
-            // The hardware interrupt vector table is stored in
-            // the CR2 register. We take the interrupt # as an
-            // index into this table.
-            Word interrupt_vector { add(control_regs[2], e.value()*3).first };
-            Word interrupt_address { get_memory_word(interrupt_vector.value()) };
-            
-            // Save the current IP into CR3
-            control_regs[3].set(instruction_pointer);
+            return { by_branch_target(second, fused_compare_branch<-1>,
+                    fused_compare_branch<0>, fused_compare_branch<1>),
+                first.x, first.low6(), second.low12(), second.m };
+        }
 
-            // Now jump to the interrupt handler
-            instruction_pointer.set(interrupt_address);
+        // INC/DEC (or any long immediate add or subtract); Bxf addr
+        if (first.o == 4 && first.m == 11 && is_flag_branch(second))
+        {
+            return { by_branch_target(second, fused_add_branch<false, -1>,
+                    fused_add_branch<false, 0>, fused_add_branch<false, 1>),
+                first.t, first.low9(), second.low12(), second.m };
+        }
 
-            // For a debug breakpoint, set the return flag
-            if (e.value() == 1)
-            {
-                breakpoint_encountered = true;
-            }
+        if (first.o == 4 && first.m == -8 && is_flag_branch(second))
+        {
+            return { by_branch_target(second, fused_add_branch<true, -1>,
+                    fused_add_branch<true, 0>, fused_add_branch<true, 1>),
+                first.t, first.low9(), second.low12(), second.m };
         }
-        catch (const std::exception& e)
+
+        // LAL rX, rY; OUT rZ, @port
+        if (first.o == 8 && first.m == 5 && second.o == -8 && second.m == -1)
         {
-            // Other exceptions are, well, exceptional
-            std::cerr << e.what() << '\n';
-            throw;
+            return { fused_load_output, first.y, first.z, second.t, second.low9() };
         }
-        
-        // Branch, call, return, and syscall/sysret will all change IP.
-        // If they don't, then we increment it by 3 (instructions are
-        // word-aligned on our architecture.)
-        if (instruction_pointer.value() == current_ip.value())
+
+        // MOV rX, rY; SHR rZ, places
+        if (first.o == 8 && first.m == -1 && second.o == 1 && second.m == -13)
+        {
+            return { fused_move_shift, first.z, first.y, second.x, second.low6() };
+        }
+
+        return {};
+    }
+
+    template<int Target>
+    void Cpu::fused_compare_branch(Cpu& c, const MicroOp& u)
+    {
+        c.compare_immediate(u.a, u.b);
+
+        if (!c.stop_pending())
+        {
+            c.enter_second_half();
+            c.branch_on_flag(u.c, u.d, Target);
+        }
+    }
+
+    template<bool Subtract, int Target>
+    void Cpu::fused_add_branch(Cpu& c, const MicroOp& u)
+    {
+        c.add_subtract_immediate(u.a, u.a, u.b, Subtract);
+
+        if (!c.stop_pending())
+        {
+            c.enter_second_half();
+            c.branch_on_flag(u.c, u.d, Target);
+        }
+    }
+
+    void Cpu::fused_load_output(Cpu& c, const MicroOp& u)
+    {
+        c.load_register_indirect(u.a, u.b, hexad_select::low);
+
+        if (!c.stop_pending())
         {
-            instruction_pointer.set(add(current_ip.value(), 3).first);
+            c.enter_second_half();
+            c.io_write(u.c, u.d, false);
         }
+    }
+
+    void Cpu::fused_move_shift(Cpu& c, const MicroOp& u)
+    {
+        c.move_register(u.a, u.b);
 
-        return breakpoint_encountered;
+        if (!c.stop_pending())
+        {
+            c.enter_second_half();
+            c.shift_register(u.c, u.d, true);
+        }
     }
 
     Hexad Cpu::read_memory(const int ad)
     {
-        auto f { flag_register.get_flag(flags::absolute) };
+        auto f { state.flag_register.get_flag(flags::absolute) };
 
         switch (f)
         {
@@ -160,16 +1297,17 @@ namespace ternary
                 return memory.get(ad);
             
             case 1:
-                return memory.get(ad + registers.get(-3).value());
+                return memory.get(ad + state.registers.get(-3).value());
             
             default:
-                throw invalid_flag{};
+                raise(interrupts::invalid_flag);
+                return {};
         }
     }
 
     Word Cpu::read_memory_word(const int ad)
     {
-        auto f { flag_register.get_flag(flags::absolute) };
+        auto f { state.flag_register.get_flag(flags::absolute) };
 
         switch (f)
         {
@@ -177,487 +1315,459 @@ namespace ternary
                 return memory.get_word(ad);
             
             case 1:
-                return memory.get_word(ad + registers.get(-3).value());
+                return memory.get_word(ad + state.registers.get(-3).value());
             
             default:
-                throw invalid_flag{};
+                raise(interrupts::invalid_flag);
+                return {};
         }
     }
 
     void Cpu::write_memory(const int ad, const int val)
     {
-        auto f { flag_register.get_flag(flags::absolute) };
+        auto f { state.flag_register.get_flag(flags::absolute) };
 
         switch (f)
         {
             case 0:
-                return memory.set(ad, val);
+                return store(ad, val);
             
             case 1:
-                return memory.set(ad + registers.get(-3).value(), val);
+                return store(ad + state.registers.get(-3).value(), val);
             
             default:
-                throw invalid_flag{};
+                return raise(interrupts::invalid_flag);
         }
     }
 
     void Cpu::write_memory_word(const int ad, const int val)
     {
-        auto f { flag_register.get_flag(flags::absolute) };
+        auto f { state.flag_register.get_flag(flags::absolute) };
 
         switch (f)
         {
             case 0:
-                return memory.set_word(ad, val);
+                return store_word(ad, val);
             
             case 1:
-                return memory.set_word(ad + registers.get(-3).value(), val);
+                return store_word(ad + state.registers.get(-3).value(), val);
             
             default:
-                throw invalid_flag{};
+                return raise(interrupts::invalid_flag);
         }
     }
 
-    void Cpu::decode_major(Opcode& op)
+    MicroOp Cpu::decode_major(const Opcode& op)
     {
         switch (op.o)
         {
             case 0:
-                decode_minor_system(op);
-                break;
+                return decode_minor_system(op);
             case 1:
-                decode_minor_tritwise(op);
-                break;
+                return decode_minor_tritwise(op);
             case 2:
-                decode_minor_complex(op);
-                break;
+                return decode_minor_complex(op);
             case 3:
                 // %C.... is undefined on the basic architecture
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
             case 4:
-                decode_minor_arithmetic(op);
-                break;
+                return decode_minor_arithmetic(op);
             case 5:
-                load_register_memory(op.m, op.low12(), hexad_select::low);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_memory(u.a, u.b, hexad_select::low); },
+                    op.m, op.low12() };
             case 6:
-                load_register_memory(op.m, op.low12(), hexad_select::middle);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_memory(u.a, u.b, hexad_select::middle); },
+                    op.m, op.low12() };
             case 7:
-                load_register_memory(op.m, op.low12(), hexad_select::high);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_memory(u.a, u.b, hexad_select::high); },
+                    op.m, op.low12() };
             case 8:
-                decode_minor_register(op);
-                break;
+                return decode_minor_register(op);
             case 9:
-                load_register_memory(op.m, op.low12(), hexad_select::full_word);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_memory(u.a, u.b, hexad_select::full_word); },
+                    op.m, op.low12() };
             case 10:
-                decode_minor_branch(op);
-                break;
+                return decode_minor_branch(op);
             case 11:
-                branch_on_flag(op.low12(), op.m, -1);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_on_flag(u.a, u.b, -1); },
+                    op.low12(), op.m };
             case 12:
-                branch_on_flag(op.low12(), op.m, 0);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_on_flag(u.a, u.b, 0); },
+                    op.low12(), op.m };
             case 13:
-                branch_on_flag(op.low12(), op.m, 1);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_on_flag(u.a, u.b, 1); },
+                    op.low12(), op.m };
             case -1:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
             case -2:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
             case -3:
                 // %p..... is undefined on the basic architecture
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
             case -4:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
             case -5:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
             case -6:
-                decode_minor_set(op);
-                break;
+                return decode_minor_set(op);
             case -7:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
             case -8:
-                decode_minor_io(op);
-                break;
+                return decode_minor_io(op);
             case -9:
-                store_register_memory(op.m, op.low12(), hexad_select::full_word);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.store_register_memory(u.a, u.b, hexad_select::full_word); },
+                    op.m, op.low12() };
             case -10:
-                decode_minor_indirect(op);
-                break;
+                return decode_minor_indirect(op);
             case -11:
-                store_register_memory(op.m, op.low12(), hexad_select::high);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.store_register_memory(u.a, u.b, hexad_select::high); },
+                    op.m, op.low12() };
             case -12:
-                store_register_memory(op.m, op.low12(), hexad_select::middle);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.store_register_memory(u.a, u.b, hexad_select::middle); },
+                    op.m, op.low12() };
             case -13:
-                store_register_memory(op.m, op.low12(), hexad_select::low);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.store_register_memory(u.a, u.b, hexad_select::low); },
+                    op.m, op.low12() };
 
             default:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
         }
     }
 
-    void Cpu::decode_minor_system(Opcode& op)
+    MicroOp Cpu::decode_minor_system(const Opcode& op)
     {
         switch (op.m)
         {
             case 0:
                 // %00.... is an *intentional* undefined opcode
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
             case 1:
-                system_load_register(op.x, op.z);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.system_load_register(u.a, u.b); },
+                    op.x, op.z };
             case 10:
-                system_call(op.low6());
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.system_call(u.a); },
+                    op.low6() };
             case -1:
-                system_store_register(op.x, op.z);
+                return { [](Cpu& c, const MicroOp& u) { c.system_store_register(u.a, u.b); },
+                    op.x, op.z };
             case -11:
                 // %0x.... is a NOP
-                break;
+                return { [](Cpu&, const MicroOp&) {} };
             case -12:
-                system_breakpoint();
-                break;
+                return { [](Cpu& c, const MicroOp&) { c.system_breakpoint(); } };
             case -13:
-                system_return();
+                return { [](Cpu& c, const MicroOp&) { c.system_return(); } };
             default:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
         }
     }
 
-    void Cpu::decode_minor_tritwise(Opcode& op)
+    MicroOp Cpu::decode_minor_tritwise(const Opcode& op)
     {
         switch (op.m)
         {
             case 0:
-                invert_register(op.z, sti);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.invert_register(u.a, sti); },
+                    op.z };
             case 1:
-                invert_register(op.z, pti);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.invert_register(u.a, pti); },
+                    op.z };
             case 8:
-                logical_register(op.x, op.y, op.z, min);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.logical_register(u.a, u.b, u.c, min); },
+                    op.x, op.y, op.z };
             case 9:
-                logical_register(op.x, op.y, op.z, teq);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.logical_register(u.a, u.b, u.c, teq); },
+                    op.x, op.y, op.z };
             case 10:
-                logical_register(op.x, op.y, op.z, max);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.logical_register(u.a, u.b, u.c, max); },
+                    op.x, op.y, op.z };
             case 11:
-                logical_register(op.x, op.y, op.z, tem);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.logical_register(u.a, u.b, u.c, tem); },
+                    op.x, op.y, op.z };
             case -1:
-                invert_register(op.z, nti);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.invert_register(u.a, nti); },
+                    op.z };
             case -5:
-                rotate_register(op.x, op.low6(), false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.rotate_register(u.a, u.b, false); },
+                    op.x, op.low6() };
             case -7:
-                rotate_register(op.x, op.low6(), true);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.rotate_register(u.a, u.b, true); },
+                    op.x, op.low6() };
             case -8:
-                compare_immediate(op.x, op.low6());
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.compare_immediate(u.a, u.b); },
+                    op.x, op.low6() };
             case -9:
-                compare_register(op.y, op.z);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.compare_register(u.a, u.b); },
+                    op.y, op.z };
             case -10:
-                rotate_register_carry(op.x, op.low6(), true);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.rotate_register_carry(u.a, u.b, true); },
+                    op.x, op.low6() };
             case -11:
-                shift_register(op.x, op.low6(), false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.shift_register(u.a, u.b, false); },
+                    op.x, op.low6() };
             case -12:
-                rotate_register_carry(op.x, op.low6(), false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.rotate_register_carry(u.a, u.b, false); },
+                    op.x, op.low6() };
             case -13:
-                shift_register(op.x, op.low6(), true);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.shift_register(u.a, u.b, true); },
+                    op.x, op.low6() };
             default:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
         }
     }
 
-    void Cpu::decode_minor_arithmetic(Opcode& op)
+    MicroOp Cpu::decode_minor_arithmetic(const Opcode& op)
     {
         switch (op.m)
         {
             case 9:
-                add_subtract_register(op.x, op.y, op.z, false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.add_subtract_register(u.a, u.b, u.c, false); },
+                    op.x, op.y, op.z };
             case 11:
-                add_subtract_immediate(op.t, op.t, op.low9(), false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.add_subtract_immediate(u.a, u.b, u.c, false); },
+                    op.t, op.t, op.low9() };
             case 12:
-                add_subtract_carry(op.x, op.y, op.z, false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.add_subtract_carry(u.a, u.b, u.c, false); },
+                    op.x, op.y, op.z };
             case 13:
-                add_subtract_immediate(op.t, op.x, op.low6(), false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.add_subtract_immediate(u.a, u.b, u.c, false); },
+                    op.t, op.x, op.low6() };
             case -6:
-                add_subtract_immediate(op.t, op.x, op.low6(), true);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.add_subtract_immediate(u.a, u.b, u.c, true); },
+                    op.t, op.x, op.low6() };
             case -8:
-                add_subtract_immediate(op.t, op.t, op.low9(), true);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.add_subtract_immediate(u.a, u.b, u.c, true); },
+                    op.t, op.t, op.low9() };
             case -9:
-                add_subtract_register(op.x, op.y, op.z, true);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.add_subtract_register(u.a, u.b, u.c, true); },
+                    op.x, op.y, op.z };
             case -10:
-                add_subtract_carry(op.x, op.y, op.z, true);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.add_subtract_carry(u.a, u.b, u.c, true); },
+                    op.x, op.y, op.z };
             default:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
         }
     }
 
-    void Cpu::decode_minor_complex(Opcode& op)
+    MicroOp Cpu::decode_minor_complex(const Opcode& op)
     {
         switch (op.m)
         {
             case 1:
-                register_conversion(op.y, op.z, bin);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.register_conversion(u.a, u.b, bin); },
+                    op.y, op.z };
             case 2:
-                register_conversion(op.y, op.z, rdr);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.diode_register(u.a, u.b, rdr); },
+                    op.y, op.z };
             case 4:
-                register_conversion(op.y, op.z, fdr);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.diode_register(u.a, u.b, fdr); },
+                    op.y, op.z };
             case 9:
-                divide_register(op.x, op.y, op.z);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.divide_register(u.a, u.b, u.c); },
+                    op.x, op.y, op.z };
             case 12:
-                multiply_register(op.x, op.y, op.z);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.multiply_register(u.a, u.b, u.c); },
+                    op.x, op.y, op.z };
             case -1:
-                register_conversion(op.y, op.z, tri);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.register_conversion(u.a, u.b, tri); },
+                    op.y, op.z };
             case -6:
-                multiply_immediate(op.t, op.x, op.low6());
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.multiply_immediate(u.a, u.b, u.c); },
+                    op.t, op.x, op.low6() };
             case -7:
-                multiply_immediate(op.t, op.t, op.low9());
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.multiply_immediate(u.a, u.b, u.c); },
+                    op.t, op.t, op.low9() };
             case -9:
-                divide_immediate(op.t, op.x, op.low6());
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.divide_immediate(u.a, u.b, u.c); },
+                    op.t, op.x, op.low6() };
             case -10:
-                divide_immediate(op.t, op.t, op.low9());
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.divide_immediate(u.a, u.b, u.c); },
+                    op.t, op.t, op.low9() };
             default:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
         }
     }
 
-    void Cpu::decode_minor_register(Opcode& op)
+    MicroOp Cpu::decode_minor_register(const Opcode& op)
     {
         switch (op.m)
         {
             case 0:
-                load_register_immediate(op.x, op.low6(), hexad_select::full_word);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_immediate(u.a, u.b, hexad_select::full_word); },
+                    op.x, op.low6() };
             case 1:
-                decode_tertiary_HA(op);
-                break;
+                return decode_tertiary_HA(op);
             case 2:
-                load_register_immediate(op.x, op.low6(), hexad_select::low);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_immediate(u.a, u.b, hexad_select::low); },
+                    op.x, op.low6() };
             case 3:
-                load_register_immediate(op.x, op.low6(), hexad_select::middle);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_immediate(u.a, u.b, hexad_select::middle); },
+                    op.x, op.low6() };
             case 4:
-                load_register_immediate(op.x, op.low6(), hexad_select::high);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_immediate(u.a, u.b, hexad_select::high); },
+                    op.x, op.low6() };
             case 5:
-                load_register_indirect(op.y, op.z, hexad_select::low);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_indirect(u.a, u.b, hexad_select::low); },
+                    op.y, op.z };
             case 6:
-                load_register_indirect(op.y, op.z, hexad_select::middle);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_indirect(u.a, u.b, hexad_select::middle); },
+                    op.y, op.z };
             case 7:
-                load_register_indirect(op.y, op.z, hexad_select::high);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_indirect(u.a, u.b, hexad_select::high); },
+                    op.y, op.z };
             case 8:
-                load_register_address(op.low12());
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_address(u.a); },
+                    op.low12() };
             case 9:
-                load_register_indirect(op.y, op.z, hexad_select::full_word);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.load_register_indirect(u.a, u.b, hexad_select::full_word); },
+                    op.y, op.z };
             case 11:
-                push_register(op.z);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.push_register(u.a); },
+                    op.z };
             case 13:
-                pop_register(op.z);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.pop_register(u.a); },
+                    op.z };
             case -1:
                 // Note swapped order!!!
-                move_register(op.z, op.y);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.move_register(u.a, u.b); },
+                    op.z, op.y };
             case -4:
-                exchange_registers(op.y, op.z);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.exchange_registers(u.a, u.b); },
+                    op.y, op.z };
             default:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
         }
     }
 
-    void Cpu::decode_minor_branch(Opcode& op)
+    MicroOp Cpu::decode_minor_branch(const Opcode& op)
     {
         switch (op.m)
         {
             case 0:
-                branch_call(op.low12(), false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_call(u.a, false); },
+                    op.low12() };
             case 1:
-                branch_relative(op.low12());
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_relative(u.a); },
+                    op.low12() };
             case 2:
-                branch_register(op.x, op.low6(), false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_register(u.a, u.b, false); },
+                    op.x, op.low6() };
             case 3:
-                branch_register(op.x, 0, false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_register(u.a, 0, false); },
+                    op.x };
             case 4:
-                branch_absolute(op.low12());
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_absolute(u.a); },
+                    op.low12() };
             case 11:
-                branch_on_flag(3, op.z, -1);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_on_flag(3, u.a, -1); },
+                    op.z };
             case 12:
-                branch_on_flag(3, op.z, 0);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_on_flag(3, u.a, 0); },
+                    op.z };
             case 13:
-                branch_on_flag(3, op.z, 1);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_on_flag(3, u.a, 1); },
+                    op.z };
             case -1:
-                branch_relative(op.low6());
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_relative(u.a); },
+                    op.low6() };
             case -2:
                 // Note different order of operands!!!
-                branch_ternary(static_cast<flags>(op.t), op.z, op.y, op.x);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_ternary(static_cast<flags>(u.a), u.b, u.c, u.d); },
+                    op.t, op.z, op.y, op.x };
             case -3:
-                branch_register(op.z, 0, true);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_register(u.a, 0, true); },
+                    op.z };
             case -9:
-                branch_call(op.low12(), true);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.branch_call(u.a, true); },
+                    op.low12() };
             case -13:
-                branch_return();
-                break;
+                return { [](Cpu& c, const MicroOp&) { c.branch_return(); } };
             default:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
         }
     }
 
-    void Cpu::decode_minor_indirect(Opcode& op)
+    MicroOp Cpu::decode_minor_indirect(const Opcode& op)
     {
         switch (op.m)
         {
             case 5:
-                store_register_indirect(op.y, op.z, hexad_select::low);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.store_register_indirect(u.a, u.b, hexad_select::low); },
+                    op.y, op.z };
             case 6:
-                store_register_indirect(op.y, op.z, hexad_select::middle);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.store_register_indirect(u.a, u.b, hexad_select::middle); },
+                    op.y, op.z };
             case 7:
-                store_register_indirect(op.y, op.z, hexad_select::high);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.store_register_indirect(u.a, u.b, hexad_select::high); },
+                    op.y, op.z };
             case 9:
-                store_register_indirect(op.y, op.z, hexad_select::full_word);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.store_register_indirect(u.a, u.b, hexad_select::full_word); },
+                    op.y, op.z };
             default:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
         }
     }
 
-    void Cpu::decode_minor_set(Opcode& op)
+    MicroOp Cpu::decode_minor_set(const Opcode& op)
     {
         switch (op.m)
         {
             case 0:
-                set_flag_to_value(static_cast<flags>(op.z), 0);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.set_flag_to_value(static_cast<flags>(u.a), 0); },
+                    op.z };
             case 1:
-                set_flag_to_value(static_cast<flags>(op.z), 1);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.set_flag_to_value(static_cast<flags>(u.a), 1); },
+                    op.z };
             case -1:
-                set_flag_to_value(static_cast<flags>(op.z), -1);
+                return { [](Cpu& c, const MicroOp& u) { c.set_flag_to_value(static_cast<flags>(u.a), -1); },
+                    op.z };
             default:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
         }
     }
 
-    void Cpu::decode_tertiary_HA(Opcode& op)
+    MicroOp Cpu::decode_tertiary_HA(const Opcode& op)
     {
         switch (op.t)
         {
             case 0:
-                set_register(op.y, 0);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.set_register(u.a, 0); },
+                    op.y };
             case 1:
-                set_register(op.y, 1);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.set_register(u.a, 1); },
+                    op.y };
             case -1:
-                set_register(op.y, -1);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.set_register(u.a, -1); },
+                    op.y };
             default:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
         }
     }
 
-    void Cpu::decode_minor_io(Opcode& op)
+    MicroOp Cpu::decode_minor_io(const Opcode& op)
     {
         switch (op.m)
         {
             case 1:
-                io_read(op.t, op.low9(), false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.io_read(u.a, u.b, false); },
+                    op.t, op.low9() };
             case 2:
-                io_write(op.t, op.low9(), true);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.io_write(u.a, u.b, true); },
+                    op.t, op.low9() };
             case 4:
-                io_read(op.t, op.low9(), true);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.io_read(u.a, u.b, true); },
+                    op.t, op.low9() };
             case -1:
-                io_write(op.t, op.low9(), false);
-                break;
+                return { [](Cpu& c, const MicroOp& u) { c.io_write(u.a, u.b, false); },
+                    op.t, op.low9() };
             default:
-                undefined_opcode(op);
-                break;
+                return { undefined_opcode };
         }
     }
 
-    void Cpu::undefined_opcode(Opcode& op)
+    void Cpu::undefined_opcode(Cpu& cpu, const MicroOp&)
     {
-        throw invalid_opcode{};
+        cpu.raise(interrupts::invalid_opcode);
     }
 
     void Cpu::load_register_immediate(const int reg, const int value, hexad_select type)
@@ -665,12 +1775,12 @@ namespace ternary
         if (type == hexad_select::full_word)
         {
             Word w { 0, 0, value };
-            registers.set(reg, w);
+            state.registers.set(reg, w);
         }
         else
         {
             Hexad h { value };
-            Word current { registers.get(reg) };
+            Word current { state.registers.get(reg) };
 
             switch (type)
             {
@@ -691,7 +1801,7 @@ namespace ternary
                     break;
             }
 
-            registers.set(reg, current);
+            state.registers.set(reg, current);
         }
     }
 
@@ -700,14 +1810,26 @@ namespace ternary
         if (type == hexad_select::full_word)
         {
             Word w { read_memory_word(addr) };
-            registers.set(reg, w);
 
-            flag_register.set_flag(flags::sign, sign_c(w.value()));
+            if (interrupt_pending)
+            {
+                // A faulting access leaves the register untouched
+                return;
+            }
+            state.registers.set(reg, w);
+
+            state.flag_register.set_result(w.value());
         }
         else
         {
             Hexad h { read_memory(addr) };
-            Word current { registers.get(reg) };
+
+            if (interrupt_pending)
+            {
+                // A faulting access leaves the register untouched
+                return;
+            }
+            Word current { state.registers.get(reg) };
 
             switch (type)
             {
@@ -728,26 +1850,25 @@ namespace ternary
                     break;
             }
 
-            registers.set(reg, current);
+            state.registers.set(reg, current);
 
-            flag_register.set_flag(flags::sign, sign_c(current.value()));
+            state.flag_register.set_result(current.value());
         }
     }
 
     void Cpu::load_register_indirect(const int addrreg, const int destreg, hexad_select type)
     {
-        auto address { registers.get(addrreg) };
-        auto current { registers.get(destreg) };
+        auto address { state.registers.get(addrreg) };
+        auto current { state.registers.get(destreg) };
 
         // If the A flag is set +, use it as a base
-        if (flag_register.get_flag(flags::absolute) == 1)
+        if (state.flag_register.get_flag(flags::absolute) == 1)
         {
-            address = add(address, registers.get(-3)).first;
+            address = add(address, state.registers.get(-3)).first;
         }
 
         // On the basic architecture, clear high hexad
-        // TODO: Implement advanced architecture w/18-trit address space
-        address.set_high(0);
+        address = to_address(address);
 
         if (type == hexad_select::full_word)
         {
@@ -774,46 +1895,59 @@ namespace ternary
 
         }
 
-        registers.set(destreg, current);
+        if (interrupt_pending)
+        {
+            // A faulting access leaves the register untouched
+            return;
+        }
+
+        state.registers.set(destreg, current);
 
-        flag_register.set_flag(flags::sign, sign_c(current.value()));
+        state.flag_register.set_result(current.value());
     }
 
     void Cpu::load_register_indexed(const int destreg, const int addr)
     {
-        auto address { registers.get(-3).value() + registers.get(-1).value() + addr };
+        auto address { state.registers.get(-3).value() + state.registers.get(-1).value() + addr };
 
-        registers.set(destreg, read_memory_word(address));
-        
-        if (flag_register.get_flag(flags::direction))
+        const Word data { read_memory_word(address) };
+
+        if (interrupt_pending)
+        {
+            return;
+        }
+
+        state.registers.set(destreg, data);
+
+        if (state.flag_register.get_flag(flags::direction))
         {
-            registers.set(destreg, add(address, 3).first);
+            state.registers.set(destreg, add(address, 3).first);
         }
 
-        flag_register.set_flag(flags::sign, sign_c(registers.get(destreg).value()));
+        state.flag_register.set_result(state.registers.get(destreg).value());
     }
 
     void Cpu::load_register_address(const int addr)
     {
         Word w;
 
-        if (flag_register.get_flag(flags::absolute))
+        if (state.flag_register.get_flag(flags::absolute))
         {
-            w.set(add(registers.get(-3), addr).first);
+            w.set(add(state.registers.get(-3), addr).first);
         }
         else
         {
             w = addr;
         }
 
-        w.set_high(0);
+        w = to_address(w);
 
-        registers.set(0, w);        
+        state.registers.set(0, w);        
     }
 
     void Cpu::store_register_memory(const int reg, const int addr, hexad_select type)
     {
-        Word r { registers.get(reg) };
+        Word r { state.registers.get(reg) };
         if (type == hexad_select::full_word)
         {
             write_memory_word(addr, r);
@@ -840,23 +1974,27 @@ namespace ternary
             }
         }
 
-        flag_register.set_flag(flags::sign, sign_c(r.value()));
+        if (interrupt_pending)
+        {
+            return;
+        }
+
+        state.flag_register.set_result(r.value());
     }
 
     void Cpu::store_register_indirect(const int srcreg, const int addrreg, hexad_select type)
     {
-        auto address { registers.get(addrreg) };
-        auto current { registers.get(srcreg) };
+        auto address { state.registers.get(addrreg) };
+        auto current { state.registers.get(srcreg) };
 
         // If the A flag is set +, use it as a base
-        if (flag_register.get_flag(flags::absolute) == 1)
+        if (state.flag_register.get_flag(flags::absolute) == 1)
         {
-            address = add(address, registers.get(-3)).first;
+            address = add(address, state.registers.get(-3)).first;
         }
 
         // On the basic architecture, clear high hexad
-        // TODO: Implement advanced architecture w/18-trit address space
-        address.set_high(0);
+        address = to_address(address);
 
         if (type == hexad_select::full_word)
         {
@@ -884,357 +2022,347 @@ namespace ternary
             }
         }
 
-        flag_register.set_flag(flags::sign, sign_c(current.value()));
+        if (interrupt_pending)
+        {
+            return;
+        }
+
+        state.flag_register.set_result(current.value());
     }
 
     void Cpu::store_register_indexed(const int srcreg, const int addr)
     {
-        auto address { registers.get(-3).value() + registers.get(-1).value() + addr };
+        auto address { state.registers.get(-3).value() + state.registers.get(-1).value() + addr };
 
-        write_memory_word(address, registers.get(srcreg));
+        write_memory_word(address, state.registers.get(srcreg));
+
+        if (interrupt_pending)
+        {
+            return;
+        }
 
-        if (flag_register.get_flag(flags::direction))
+        if (state.flag_register.get_flag(flags::direction))
         {
-            registers.set(srcreg, add(address, 3).first);
+            state.registers.set(srcreg, add(address, 3).first);
         }
 
-        flag_register.set_flag(flags::sign, sign_c(registers.get(srcreg).value()));
+        state.flag_register.set_result(state.registers.get(srcreg).value());
     }
 
     void Cpu::push_register(const int reg)
     {
         // rs = stack pointer
-        auto sp { registers.get(-6) };
-        auto data { registers.get(reg) };
+        auto sp { state.registers.get(-6) };
+        auto data { state.registers.get(reg) };
 
-        memory.set_word(sp.value(), data);
+        store_word(sp.value(), data);
 
         auto newsp  { sub(sp, 3) };
 
         // TODO: Handle stack overflow, probably using carry from the
         // previous operation.
-        registers.set(-6, newsp.first);
+        state.registers.set(-6, newsp.first);
 
-        flag_register.set_flag(flags::sign, sign_c(data.value()));
+        state.flag_register.set_result(data.value());
     }
 
     void Cpu::pop_register(const int reg)
     {
         // rs = stack pointer
-        auto sp { registers.get(-6) };
+        auto sp { state.registers.get(-6) };
 
         auto newsp  { add(sp, 3) };
 
         // TODO: Handle stack overflow, probably using carry from the
         // previous operation.
-        registers.set(-6, newsp.first);
+        state.registers.set(-6, newsp.first);
 
         auto data { memory.get_word(newsp.first.value()) };
 
-        registers.set(reg, data);
+        state.registers.set(reg, data);
 
-        flag_register.set_flag(flags::sign, sign_c(data.value()));
+        state.flag_register.set_result(data.value());
     }
 
     void Cpu::branch_on_flag(const int addr, const int flag, const int target)
     {
-        if (flag_register.get_flag(static_cast<flags>(flag)) == target)
+        if (state.flag_register.get_flag(static_cast<flags>(flag)) == target)
         {
-            auto newaddr { add(instruction_pointer, addr).first };
-            instruction_pointer.set(newaddr);
+            auto newaddr { add(Word { state.ip }, addr).first };
+            state.ip = newaddr.value();
         }
     }
 
     void Cpu::add_subtract_register(const int srcreg1, const int srcreg2, const int destreg, const bool subtract)
     {
-        auto src1 { registers.get(srcreg1) };
-        auto src2 { registers.get(srcreg2) };
+        auto src1 { state.registers.get(srcreg1) };
+        auto src2 { state.registers.get(srcreg2) };
 
         auto result { subtract ? sub(src1, src2) : add(src1, src2) };
 
-        registers.set(destreg, result.first);
-        flag_register.set_flag(flags::carry, result.second);
-        flag_register.set_flag(flags::sign, sign_c(result.first.value()));
+        state.registers.set(destreg, result.first);
+        state.flag_register.set_carry(result.second);
+        state.flag_register.set_result(result.first.value());
     }
 
     void Cpu::add_subtract_carry(const int srcreg1, const int srcreg2, const int destreg, const bool subtract)
     {
-        auto src1 { registers.get(srcreg1) };
-        auto src2 { registers.get(srcreg2) };
-        auto carry { flag_register.get_flag(flags::carry) };
+        auto src1 { state.registers.get(srcreg1) };
+        auto src2 { state.registers.get(srcreg2) };
+        auto carry { state.flag_register.get_flag(flags::carry) };
 
         auto result { subtract ? sub(src1, src2) : add(src1, src2) };
         auto with_carry { subtract ? sub(result.first, carry) : add(result.first, carry) };
         auto final_carry { result.second + with_carry.second };
 
-        registers.set(destreg, with_carry.first);
-        flag_register.set_flag(flags::carry, final_carry);
-        flag_register.set_flag(flags::sign, sign_c(with_carry.first.value()));
+        state.registers.set(destreg, with_carry.first);
+        state.flag_register.set_carry(final_carry);
+        state.flag_register.set_result(with_carry.first.value());
     }
 
     void Cpu::add_subtract_immediate(const int srcreg, const int destreg, const int immediate, const bool subtract)
     {
-        auto src { registers.get(srcreg) };
+        auto src { state.registers.get(srcreg) };
 
         auto result { subtract ? sub(src, immediate) : add(src, immediate) };
 
-        registers.set(destreg, result.first);
-        flag_register.set_flag(flags::carry, result.second);
-        flag_register.set_flag(flags::sign, sign_c(result.first.value()));
+        state.registers.set(destreg, result.first);
+        state.flag_register.set_carry(result.second);
+        state.flag_register.set_result(result.first.value());
     }
 
     void Cpu::multiply_register(const int srcreg1, const int srcreg2, const int destreg)
     {
-        auto src1 { registers.get(srcreg1) };
-        auto src2 { registers.get(srcreg2) };
+        auto src1 { state.registers.get(srcreg1) };
+        auto src2 { state.registers.get(srcreg2) };
 
         auto result { mul(src1, src2) };
 
-        registers.set(destreg, result.first);
+        state.registers.set(destreg, result.low());
         // ro = high word of result
-        registers.set(-2, result.second);
+        state.registers.set(-2, result.high());
 
-        flag_register.set_flag(flags::carry, sign_c(result.second.value()));
-        flag_register.set_flag(flags::sign, result.second.value() ? 
-            sign_c(result.second.value()) : sign_c(result.first.value()));
+        state.flag_register.set_carry(result.overflow());
+        state.flag_register.set_result(sign_c(result.value()));
     }
 
     void Cpu::multiply_immediate(const int srcreg, const int destreg, const int immediate)
     {
-        auto src { registers.get(srcreg) };
+        auto src { state.registers.get(srcreg) };
         auto result { mul(src, immediate) };
 
-        registers.set(destreg, result.first);
+        state.registers.set(destreg, result.low());
         // ro = high word of result
-        registers.set(-2, result.second);
+        state.registers.set(-2, result.high());
 
-        flag_register.set_flag(flags::carry, sign_c(result.second.value()));
-        flag_register.set_flag(flags::sign, result.second.value() ? 
-            sign_c(result.second.value()) : sign_c(result.first.value()));
+        state.flag_register.set_carry(result.overflow());
+        state.flag_register.set_result(sign_c(result.value()));
     }
 
     void Cpu::divide_register(const int srcreg1, const int srcreg2, const int destreg)
     {
-        if (registers.get(srcreg2).value())
-        {
-            auto src1 { registers.get(srcreg1) };
-            auto src2 { registers.get(srcreg2) };
+        auto src2 { state.registers.get(srcreg2) };
 
+        if (src2.value())
+        {
             // ro = high word of dividend
-            auto highword { registers.get(-2) };
-            division_dividend di { highword, src1 };
-
-            auto result { div(di, src2) };
-
-            registers.set(destreg, result.first.value());
-            // ru = remainder
-            registers.set(-8, result.second.value());
-
-            // Check for overflow
-            if (result.first.value() * src2.value() + result.second.value() !=
-                highword.value() * static_cast<long long int>(pow3(Word::word_size)) + src2.value())
-            {
-                flag_register.set_flag(flags::carry, highword.value() ?
-                    sign_c(highword.value()) : sign_c(src2.value()));
-            }
-            else
-            {
-                flag_register.set_flag(flags::carry, 0);
-            }
+            division_dividend di { state.registers.get(-2), state.registers.get(srcreg1) };
 
-            flag_register.set_flag(flags::sign, sign_c(result.first.value()));
+            divide(di, src2, destreg);
         }
         else
         {
-            throw divide_by_zero{};
+            raise(interrupts::divide_by_zero);
         }
-        
     }
 
     void Cpu::divide_immediate(const int srcreg, const int destreg, const int immediate)
     {
         if (immediate)
         {
-            auto src { registers.get(srcreg) };
-
             // ro = high word of dividend
-            auto highword { registers.get(-2) };
-            division_dividend di { highword, src };
-
-            auto result { div(di, immediate) };
-
-            registers.set(destreg, result.first.value());
-            // ru = remainder
-            registers.set(-8, result.second.value());
-
-            // Check for overflow
-            if (result.first.value() * immediate + result.second.value() !=
-                highword.value() * static_cast<long long int>(pow3(Word::word_size)) + immediate)
-            {
-                flag_register.set_flag(flags::carry, highword.value() ?
-                    sign_c(highword.value()) : sign_c(immediate));
-            }
-            else
-            {
-                flag_register.set_flag(flags::carry, 0);
-            }
+            division_dividend di { state.registers.get(-2), state.registers.get(srcreg) };
 
-            flag_register.set_flag(flags::sign, sign_c(result.first.value()));
+            divide(di, immediate, destreg);
         }
         else
         {
-            throw divide_by_zero{};
+            raise(interrupts::divide_by_zero);
         }        
     }
 
+    void Cpu::divide(const DoubleWord& dividend, const Word& divisor, const int destreg)
+    {
+        auto result { div(dividend, divisor) };
+        const auto& quotient { result.first };
+
+        // If the quotient doesn't fit, we keep its low word,
+        // and the carry flag gets its sign
+        state.registers.set(destreg, quotient.low());
+        // ru = remainder
+        state.registers.set(-8, result.second);
+
+        state.flag_register.set_carry(quotient.overflow());
+        state.flag_register.set_result(sign_c(quotient.value()));
+    }
+
     void Cpu::register_conversion(const int srcreg, const int destreg, unary_function fun)
     {
-        auto src { registers.get(srcreg) };
+        auto src { state.registers.get(srcreg) };
+
+        state.registers.set(destreg, fun(src));
+
+        // conversions don't affect flags
+    }
+
+    void Cpu::diode_register(const int srcreg, const int destreg, tritwise_unary_function fun)
+    {
+        PackedWord src { state.registers.get(srcreg) };
 
-        registers.set(destreg, fun(src));
+        state.registers.set(destreg, fun(src).to_word());
 
         // conversions don't affect flags
     }
 
-    void Cpu::invert_register(const int reg, unary_function fun)
+    void Cpu::invert_register(const int reg, tritwise_unary_function fun)
     {
-        auto src { registers.get(reg) };
+        PackedWord src { state.registers.get(reg) };
 
-        registers.set(reg, fun(src));
+        state.registers.set(reg, fun(src).to_word());
 
-        flag_register.set_flag(flags::sign, sign_c(registers.get(reg).value()));
+        state.flag_register.set_result(state.registers.get(reg).value());
     }
 
-    void Cpu::logical_register(const int srcreg1, const int srcreg2, const int destreg, binary_function fun)
+    void Cpu::logical_register(const int srcreg1, const int srcreg2, const int destreg, tritwise_binary_function fun)
     {
-        auto src1 { registers.get(srcreg1) };
-        auto src2 { registers.get(srcreg2) };
+        PackedWord src1 { state.registers.get(srcreg1) };
+        PackedWord src2 { state.registers.get(srcreg2) };
 
-        auto result { fun(src1, src2) };
+        auto result { fun(src1, src2).to_word() };
 
-        registers.set(destreg, result);
+        state.registers.set(destreg, result);
 
-        flag_register.set_flag(flags::sign, sign_c(result.value()));
+        state.flag_register.set_result(result.value());
     }
 
     void Cpu::compare_register(const int lreg, const int rreg)
     {
-        auto lhs { registers.get(lreg) };
-        auto rhs { registers.get(rreg) };
+        auto lhs { state.registers.get(lreg) };
+        auto rhs { state.registers.get(rreg) };
 
         auto result { sub(lhs, rhs) };
 
-        flag_register.set_flag(flags::carry, result.second);
-        flag_register.set_flag(flags::sign, sign_c(result.first.value()));
+        state.flag_register.set_carry(result.second);
+        state.flag_register.set_result(result.first.value());
     }
 
     void Cpu::compare_immediate(const int reg, const int immediate)
     {
-        auto lhs { registers.get(reg) };
+        auto lhs { state.registers.get(reg) };
 
         auto result { sub(lhs, immediate) };
 
-        flag_register.set_flag(flags::carry, result.second);
-        flag_register.set_flag(flags::sign, sign_c(result.first.value()));
+        state.flag_register.set_carry(result.second);
+        state.flag_register.set_result(result.first.value());
     }
 
     void Cpu::shift_register(const int reg, const int places, bool right)
     {
-        auto value { registers.get(reg) };
+        auto value { state.registers.get(reg) };
 
-        auto result { right ? shr(value, low_trits(places, 4)) : shl(value, low_trits(places, 4)) };
+        auto result { right ? shr(value, low_trits<4>(places)) : shl(value, low_trits<4>(places)) };
 
-        registers.set(reg, result.first);
+        state.registers.set(reg, result.first);
 
-        flag_register.set_flag(flags::carry, result.second);
-        flag_register.set_flag(flags::sign, sign_c(result.first.value()));
+        state.flag_register.set_carry(result.second);
+        state.flag_register.set_result(result.first.value());
     }
 
     void Cpu::rotate_register(const int reg, const int places, bool right)
     {
-        auto value { registers.get(reg) };
+        auto value { state.registers.get(reg) };
 
-        auto result { right ? ror(value, low_trits(places, 4)) : rol(value, low_trits(places, 4)) };
+        auto result { right ? ror(value, low_trits<4>(places)) : rol(value, low_trits<4>(places)) };
 
-        registers.set(reg, result.first);
+        state.registers.set(reg, result.first);
 
-        flag_register.set_flag(flags::sign, sign_c(result.first.value()));
+        state.flag_register.set_result(result.first.value());
     }
 
     void Cpu::rotate_register_carry(const int reg, const int places, bool right)
     {
-        auto value { registers.get(reg) };
-        auto carry { flag_register.get_flag(flags::carry )};
+        auto value { state.registers.get(reg) };
+        auto carry { state.flag_register.get_flag(flags::carry )};
 
-        auto result { right ? rcr(value, carry, low_trits(places, 4))
-            : rcl(value, carry, low_trits(places, 4)) };
+        auto result { right ? rcr(value, carry, low_trits<4>(places))
+            : rcl(value, carry, low_trits<4>(places)) };
 
-        registers.set(reg, result.first);
+        state.registers.set(reg, result.first);
 
-        flag_register.set_flag(flags::carry, result.second);
-        flag_register.set_flag(flags::sign, sign_c(result.first.value()));
+        state.flag_register.set_carry(result.second);
+        state.flag_register.set_result(result.first.value());
     }
 
     void Cpu::set_register(const int reg, const int value)
     {
-        registers.set(reg, value * (pow3(Word::word_size)/2));
+        state.registers.set(reg, value * (pow3(Word::word_size)/2));
     }
 
     void Cpu::move_register(const int srcreg, const int destreg)
     {
-        registers.set(destreg, registers.get(srcreg));
+        state.registers.set(destreg, state.registers.get(srcreg));
     }
 
     void Cpu::exchange_registers(const int lreg, const int rreg)
     {
-        auto temp { registers.get(lreg) };
-        registers.set(lreg, registers.get(rreg));
-        registers.set(rreg, temp);
+        auto temp { state.registers.get(lreg) };
+        state.registers.set(lreg, state.registers.get(rreg));
+        state.registers.set(rreg, temp);
     }
 
     void Cpu::set_flag_to_value(flags f, const int target)
     {
-        flag_register.set_flag(f, target);
+        state.flag_register.set_flag(f, target);
     }
 
     void Cpu::branch_absolute(const int address)
     {
-        instruction_pointer.set(address);
+        state.ip = address;
     }
 
     void Cpu::branch_register(const int reg, const int disp, bool subroutine)
     {
         if (subroutine)
         {
-            // Save the previous address on the stack
+            // Save the return address (the next instruction) on the stack
 
             // rs = stack pointer
-            auto sp { registers.get(-6) };
+            auto sp { state.registers.get(-6) };
 
-            memory.set_word(sp.value(), instruction_pointer);
+            store_word(sp.value(), next_instruction(state.ip));
 
             auto newsp { sub(sp, 3) };
 
             // TODO: Handle stack overflow, probably using carry from the
             // previous operation.
-            registers.set(-6, newsp.first);
+            state.registers.set(-6, newsp.first);
         }
 
-        auto newaddr { add(registers.get(reg), disp).first };
-        instruction_pointer.set(newaddr);
+        auto newaddr { add(state.registers.get(reg), disp).first };
+        state.ip = newaddr.value();
     }
 
     void Cpu::branch_relative(const int disp)
     {
-        auto newaddr { add(instruction_pointer, disp).first };
-        instruction_pointer.set(newaddr);
+        auto newaddr { add(Word { state.ip }, disp).first };
+        state.ip = newaddr.value();
     }
 
     void Cpu::branch_ternary(flags f, const int preg, const int zreg, const int nreg)
     {
-        auto addr { instruction_pointer };
+        Word addr { state.ip };
 
-        switch (flag_register.get_flag(f))
+        switch (state.flag_register.get_flag(f))
         {
             case 1:
                 addr.set(add(addr, preg).first);
@@ -1250,65 +2378,65 @@ namespace ternary
                 break;
         }
 
-        instruction_pointer.set(addr);
+        state.ip = addr.value();
     }
 
     void Cpu::branch_call(const int addr, bool relative)
     {
-        auto newaddr { relative ? add(instruction_pointer, addr).first : addr };
+        auto newaddr { relative ? add(Word { state.ip }, addr).first : addr };
 
-        // Save the previous address on the stack
+        // Save the return address (the next instruction) on the stack
 
         // rs = stack pointer
-        auto sp { registers.get(-6) };
+        auto sp { state.registers.get(-6) };
 
-        memory.set_word(sp.value(), instruction_pointer);
+        store_word(sp.value(), next_instruction(state.ip));
 
         auto newsp  { sub(sp, 3) };
 
         // TODO: Handle stack overflow, probably using carry from the
         // previous operation.
-        registers.set(-6, newsp.first);
+        state.registers.set(-6, newsp.first);
 
-        instruction_pointer.set(newaddr);
+        state.ip = newaddr.value();
     }
 
     void Cpu::branch_return()
     {
         // Pop the stack to get the return address
-        auto sp { registers.get(-6) };
+        auto sp { state.registers.get(-6) };
         auto newsp { add(sp, 3) };
 
         // TODO: Handle stack overflow, probably using carry from the
         // previous operation.
-        registers.set(-6, newsp.first);
+        state.registers.set(-6, newsp.first);
 
         auto retaddr { memory.get_word(newsp.first.value()) };
-        instruction_pointer.set(retaddr);
+        state.ip = retaddr.value();
     }
 
     void Cpu::system_call(const int vec)
     {
         // rv = system call vector table
-        auto vbase { registers.get(-9) };
+        auto vbase { state.registers.get(-9) };
         auto addr { add(vbase, vec*3).first };
 
         // rr = return address (system calls are not reentrant)
-        registers.set(-5, instruction_pointer);
+        state.registers.set(-5, state.ip);
 
-        instruction_pointer.set(addr);
+        state.ip = addr.value();
     }
 
     void Cpu::system_return()
     {
-        instruction_pointer.set(registers.get(-5));
+        state.ip = state.registers.value(-5);
     }
 
     void Cpu::system_breakpoint()
     {
-        // if (flag_register.get_flag(flags::trap))
+        // if (state.flag_register.get_flag(flags::trap))
         // {
-            throw debug_breakpoint{};
+            raise(interrupts::debug_breakpoint);
         // }
     }
 
@@ -1321,20 +2449,21 @@ namespace ternary
         {
             if (sysreg == 1)
             {
-                registers.set(userreg, flag_register.get());
+                state.registers.set(userreg, state.flag_register.get());
             }
             else
             {
-                registers.set(userreg, control_regs.at(sysreg));
+                state.registers.set(userreg, control_regs.at(sysreg));
             }            
         }
         else if (sysreg < 0)
         {
-            registers.set(userreg, debug_regs.at(sysreg));
+            // DR1 is register -1, and so on
+            state.registers.set(userreg, debug_regs.at(-sysreg - 1));
         }
         else
         {
-            registers.set(userreg, instruction_pointer);
+            state.registers.set(userreg, state.ip);
         }
     }
 
@@ -1345,9 +2474,9 @@ namespace ternary
 
         if (sysreg < 0)
         {
-            debug_regs.at(sysreg) = registers.get(userreg);
+            set_debug_register(-sysreg - 1, state.registers.get(userreg));
         }
-        else if (flag_register.get_flag(flags::protection))
+        else if (state.flag_register.get_flag(flags::protection))
         {
             if (sysreg > 0)
             {
@@ -1357,49 +2486,51 @@ namespace ternary
 
                     for (auto f : valid_flags)
                     {
-                        flag_register.set_flag(flags(f), nth_trit(registers.get(userreg).value(), f));
+                        state.flag_register.set_flag(flags(f), nth_trit(state.registers.get(userreg).value(), f));
                     }
                 }
                 else
                 {
-                    control_regs.at(sysreg) = registers.get(userreg);
+                    control_regs.at(sysreg) = state.registers.get(userreg);
                 }                
             }
-            else if (flag_register.get_flag(flags::protection) == -1)
+            else if (state.flag_register.get_flag(flags::protection) == -1)
             {
                 // P flag = -1 allows directly changing IP
-                instruction_pointer.set(registers.get(userreg));
+                state.ip = state.registers.value(userreg);
             }
             else
             {
-                throw protection_violation{};
+                raise(interrupts::protection_violation);
             }
         }
         else
         {
-            throw protection_violation{};
+            raise(interrupts::protection_violation);
         }
     }
 
     void Cpu::io_read(const int reg, const int port, bool binary)
     {
+        use_port(port, RW::read);
         Word data { binary ? io.read_binary(port) : io.read(port) };
 
         if (binary)
         {
-            registers.set(reg, bin(data));
+            state.registers.set(reg, bin(data));
         }
         else
         {
-            registers.set(reg, data);
+            state.registers.set(reg, data);
         }
 
-        flag_register.set_flag(flags::sign, sign_c(data.value()));
+        state.flag_register.set_result(data.value());
     }
 
     void Cpu::io_write(const int reg, const int port, bool binary)
     {
-        Word data { binary ? tri(registers.get(reg)) : registers.get(reg) };
+        Word data { binary ? tri(state.registers.get(reg)) : state.registers.get(reg) };
+        use_port(port, RW::write);
 
         if (binary)
         {
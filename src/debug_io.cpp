@@ -1,28 +1,92 @@
+#include <stdexcept>
+
 #include "debug_io.hpp"
 
 namespace ternary
 {
+    FileSource::FileSource(const std::string& path): file_(path)
+    {
+        if (!file_)
+        {
+            throw std::runtime_error { "can't open " + path + " for debug input" };
+        }
+    }
+
+    FileSink::FileSink(const std::string& path): file_(path)
+    {
+        if (!file_)
+        {
+            throw std::runtime_error { "can't open " + path + " for debug output" };
+        }
+    }
+
+    bool StdioSource::read_line(std::string& line)
+    {
+        line.clear();
+
+        auto c { std::fgetc(in_) };
+
+        if (c == EOF)
+        {
+            return false;
+        }
+
+        while (c != EOF && c != '\n')
+        {
+            line.push_back(static_cast<char>(c));
+            c = std::fgetc(in_);
+        }
+
+        return true;
+    }
+
+    bool StringSource::read_line(std::string& line)
+    {
+        if (position_ >= input_.size())
+        {
+            return false;
+        }
+
+        auto end { input_.find('\n', position_) };
+
+        if (end == std::string::npos)
+        {
+            end = input_.size();
+        }
+
+        line.assign(input_, position_, end - position_);
+        position_ = end + 1;
+        return true;
+    }
+
+    DebugIo::DebugIo():
+        source(new StreamSource(std::cin)),
+        sink(new StreamSink(std::cout))
+    {
+    }
+
     char DebugIo::read()
     {
         if (request == 1)
         {
+            // The prompt, and anything else waiting, has to be seen
+            // before we wait for input
+            backing_output += "> ";
+            flush();
+
             backing_input.clear();
-            std::cout << "> ";
-            get_input();
-            
+            input_position = 0;
+            source->read_line(backing_input);
+
             request = 0;
         }
 
-        if (backing_input.empty())
+        if (input_position >= backing_input.size())
         {
             return 0;
         }
-        else
-        {
-            char c { backing_input[0] };
-            backing_input.erase(backing_input.begin());
-            return c;
-        }
+
+        return backing_input[input_position++];
     }
 
     void DebugIo::write(int input)
@@ -33,25 +97,27 @@ namespace ternary
             {
                 if (input)
                 {
-                    backing_output.push_back(static_cast<unsigned char>(input));
+                    backing_line.push_back(static_cast<unsigned char>(input));
                 }
                 else
                 {
-                    print_and_clear();
+                    end_line();
                 }
                 break;
             }
             case 1:
             {
-                backing_output = std::to_string(input);
-                print_and_clear();
+                // A number is a line of its own, replacing any characters
+                // that haven't been ended yet
+                backing_line = std::to_string(input);
+                end_line();
                 break;
             }
             case -1:
             {
                 Word w { input };
-                backing_output = w.value_string();
-                print_and_clear();
+                backing_line = w.value_string();
+                end_line();
                 break;
             }
             default:
@@ -71,4 +137,89 @@ namespace ternary
 
         mode = shift_right(low_trits(value, 2), 1);
     }
-}
\ No newline at end of file
+
+    int DebugIo::read(int port)
+    {
+        switch (port - base_port)
+        {
+            case -1:
+                return read();
+            case 0:
+                return read_control();
+            default:
+                return 0;
+        }
+    }
+
+    void DebugIo::write(int port, int value)
+    {
+        switch (port - base_port)
+        {
+            case -2:
+                write(value);
+                break;
+            case 0:
+                write_control(value);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void DebugIo::reset()
+    {
+        request = 0;
+        mode = 0;
+
+        backing_input.clear();
+        input_position = 0;
+    }
+
+    void DebugIo::restore(const std::vector<int>& state)
+    {
+        if (state.size() == 2)
+        {
+            request = state[0];
+            mode = state[1];
+        }
+    }
+
+    void DebugIo::set_source(std::unique_ptr<DebugSource> s)
+    {
+        source = std::move(s);
+        backing_input.clear();
+        input_position = 0;
+    }
+
+    void DebugIo::set_sink(std::unique_ptr<DebugSink> s)
+    {
+        flush();
+        sink = std::move(s);
+    }
+
+    void DebugIo::flush()
+    {
+        // The sink is flushed whenever anything is written to it, so
+        // there's nothing to do without new output
+        if (backing_output.empty())
+        {
+            return;
+        }
+
+        sink->write(backing_output.data(), backing_output.size());
+        backing_output.clear();
+        sink->flush();
+    }
+
+    void DebugIo::end_line()
+    {
+        backing_output += backing_line;
+        backing_output.push_back('\n');
+        backing_line.clear();
+
+        if (policy == flush_policy::every_line || backing_output.size() >= block_size)
+        {
+            flush();
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#include "device.hpp"
+
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#endif
+
+namespace ternary
+{
+    DevicePlugin::DevicePlugin(const std::string& path, const std::string& args)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        // dlopen searches the library path for names without a slash
+        const auto name { (path.find('/') == std::string::npos) ? "./" + path : path };
+
+        handle_ = dlopen(name.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+        if (handle_ == nullptr)
+        {
+            throw std::runtime_error { dlerror() };
+        }
+
+        const auto symbol = [this](const char* s) {
+            const auto p { dlsym(handle_, s) };
+
+            if (p == nullptr)
+            {
+                dlclose(handle_);
+                throw std::runtime_error { std::string { "missing symbol " } + s };
+            }
+
+            return p;
+        };
+
+        const auto version { *static_cast<const int*>(symbol("trireme_device_version")) };
+
+        if (version != Device::abi_version)
+        {
+            dlclose(handle_);
+            throw std::runtime_error { "device built against an incompatible version of trireme" };
+        }
+
+        const auto create { reinterpret_cast<create_function>(symbol("trireme_create_device")) };
+        device_.reset(create(args.c_str()));
+
+        if (!device_)
+        {
+            dlclose(handle_);
+            throw std::runtime_error { "device plugin " + path + " didn't create a device" };
+        }
+#else
+        throw std::runtime_error { "loading devices isn't supported on this system" };
+#endif
+    }
+
+    DevicePlugin::~DevicePlugin()
+    {
+        device_.reset();
+
+#if defined(__unix__) || defined(__APPLE__)
+        if (handle_ != nullptr)
+        {
+            dlclose(handle_);
+        }
+#endif
+    }
+}
@@ -0,0 +1,8 @@
+#include "double_word.hpp"
+
+namespace ternary
+{
+    constexpr DoubleWord::value_type DoubleWord::word_range;
+    constexpr DoubleWord::value_type DoubleWord::max_value;
+    constexpr DoubleWord::value_type DoubleWord::min_value;
+}
@@ -6,7 +6,7 @@ namespace ternary {
         // Each string is identified by a single character,
         // with reserved flags using spaces.
         const std::string all_flags { "        PITBA  DSC" };
-        const std::string trits { w_.raw_trit_string() };
+        const std::string trits { get().raw_trit_string() };
 
         return std::inner_product(
             trits.cbegin(), trits.cend(),
@@ -7,7 +7,7 @@ namespace ternary {
     value_with_carry<Hexad> add_with_carry(const Hexad lhs, const Hexad rhs)
     {
         const auto result { lhs.get() + rhs.get() };
-        const auto carry { shift_right(result, Hexad::width) };
+        const auto carry { shift_right<Hexad::width>(result) };
 
         return { {result}, carry };
     }
@@ -15,7 +15,7 @@ namespace ternary {
     value_with_carry<Hexad> subtract_with_carry(const Hexad lhs, const Hexad rhs)
     {
         const auto result { lhs.get() - rhs.get() };
-        const auto carry { shift_right(result, Hexad::width) };
+        const auto carry { shift_right<Hexad::width>(result) };
 
         return { {result}, carry };
     }
@@ -25,8 +25,8 @@ namespace ternary {
         const auto result { lhs.get() * rhs.get() };
 
         return {
-            { low_trits(result, Hexad::width) },
-            { shift_right(result, Hexad::width) }
+            { low_trits<Hexad::width>(result) },
+            { shift_right<Hexad::width>(result) }
         };
     }
 
@@ -237,26 +237,11 @@ namespace ternary {
 
     std::string Hexad::trit_string() const noexcept
     {
-        auto tr { trits() };
-        auto result = std::string(Hexad::width, ' ' );
-        std::transform(tr.begin(), tr.end(), result.rbegin(), [](auto e){
-            if (e == 1)
-                { return '+'; }
-            else if (e == -1)
-                { return '-'; }
-            else
-                { return '0'; }
-        });
-        return result;
+        return hexad_to_trit_string(value);
     }
 
     std::string Hexad::value_string() const noexcept
     {
-        auto low { low_trits(value, 3) };
-        auto high { shift_right(value, 3) };
-
-        auto result { triad_to_string(high) };
-        result += triad_to_string(low);
-        return result;
+        return hexad_to_string(value);
     }
 }
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "interrupt_controller.hpp"
+
+#include <algorithm>
+
+namespace ternary
+{
+    namespace
+    {
+        // Bitmaps are saved as two halves
+        int low_half(const std::uint64_t bits) { return static_cast<int>(static_cast<std::uint32_t>(bits)); }
+        int high_half(const std::uint64_t bits) { return static_cast<int>(static_cast<std::uint32_t>(bits >> 32)); }
+
+        std::uint64_t join(const int low, const int high)
+        {
+            return (std::uint64_t { static_cast<std::uint32_t>(high) } << 32) | static_cast<std::uint32_t>(low);
+        }
+    }
+
+    int InterruptController::read(int port)
+    {
+        switch (port - base_port)
+        {
+            case 0:
+                return selected_;
+            case 1:
+                return masked(selected_) ? 1 : 0;
+            case 2:
+                return priority(selected_);
+            case 3:
+                return next();
+            default:
+                return 0;
+        }
+    }
+
+    void InterruptController::write(int port, int value)
+    {
+        switch (port - base_port)
+        {
+            case 0:
+                selected_ = value;
+                break;
+            case 1:
+                mask(selected_, value > 0);
+                break;
+            case 2:
+                set_priority(selected_, value);
+                break;
+            case 3:
+                if (valid(value))
+                {
+                    pending_ &= ~bit(value);
+                    update();
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    void InterruptController::reset()
+    {
+        levels_ = pending_ = mask_ = active_ = 0;
+        priorities_.fill(0);
+        selected_ = 0;
+    }
+
+    std::vector<int> InterruptController::save() const
+    {
+        std::vector<int> state {
+            low_half(levels_), high_half(levels_),
+            low_half(pending_), high_half(pending_),
+            low_half(mask_), high_half(mask_),
+            selected_
+        };
+
+        state.insert(state.end(), priorities_.cbegin(), priorities_.cend());
+        return state;
+    }
+
+    void InterruptController::restore(const std::vector<int>& state)
+    {
+        if (state.size() != 7 + priorities_.size())
+        {
+            return;
+        }
+
+        levels_ = join(state[0], state[1]);
+        pending_ = join(state[2], state[3]);
+        mask_ = join(state[4], state[5]);
+        selected_ = state[6];
+        std::copy(state.cbegin() + 7, state.cend(), priorities_.begin());
+
+        update();
+    }
+
+    int InterruptController::allocate(const int count)
+    {
+        if (count < 0 || lines_used_ + count > max_lines)
+        {
+            return -1;
+        }
+
+        const auto first { lines_used_ };
+        lines_used_ += count;
+
+        return first;
+    }
+
+    void InterruptController::set(const int line, const bool level)
+    {
+        if (!valid(line))
+        {
+            return;
+        }
+
+        // Raising a line makes it pending even if it was already up, so
+        // a device can signal again without lowering it first
+        if (level)
+        {
+            levels_ |= bit(line);
+            pending_ |= bit(line);
+        }
+        else
+        {
+            levels_ &= ~bit(line);
+            pending_ &= ~bit(line);
+        }
+
+        update();
+    }
+
+    void InterruptController::mask(const int line, const bool masked)
+    {
+        if (!valid(line))
+        {
+            return;
+        }
+
+        if (masked)
+        {
+            mask_ |= bit(line);
+        }
+        else
+        {
+            mask_ &= ~bit(line);
+        }
+
+        update();
+    }
+
+    int InterruptController::next() const noexcept
+    {
+        auto best { -1 };
+
+        for (auto line = 0; line < max_lines; ++line)
+        {
+            if ((active_ & bit(line)) != 0 && (best < 0 || priorities_[line] > priorities_[best]))
+            {
+                best = line;
+            }
+        }
+
+        return best;
+    }
+
+    int InterruptController::acknowledge() noexcept
+    {
+        const auto line { next() };
+
+        if (line >= 0)
+        {
+            pending_ &= ~bit(line);
+            update();
+        }
+
+        return line;
+    }
+}
@@ -5,91 +5,127 @@
 
 namespace ternary
 {
-    Word Io::read(int address)
+    int Io::read_port(int port)
     {
-        if (read_handlers[address])
-        {
-            return read_handlers[address]();
-        }
-        else
+        const auto i { index(port) };
+        const auto& handler { readers_[i] };
+
+        switch (handler.kind)
         {
-            return io_space[address];
+            case handler_kind::function:
+                return handler.function(handler.context, port_at(i));
+
+            case handler_kind::std_function:
+                return (*static_cast<read_handler_t*>(handler.context))();
+
+            default:
+                return io_space[i].value();
         }
     }
 
-    void Io::write(int address, int data)
+    void Io::write_port(int port, int data)
     {
-        if (write_handlers[address])
-        {
-            write_handlers[address](data);
-        }
-        else
+        const auto i { index(port) };
+        const auto& handler { writers_[i] };
+
+        switch (handler.kind)
         {
-            io_space[address] = data;
+            case handler_kind::function:
+                handler.function(handler.context, port_at(i), data);
+                break;
+
+            case handler_kind::std_function:
+                (*static_cast<write_handler_t*>(handler.context))(data);
+                break;
+
+            default:
+                io_space[i] = data;
+                break;
         }
     }
 
-    // TODO: Base conversion?
-    int Io::read_binary(int address)
+    bool Io::bind(int port, read_handler_t reader)
     {
-        if (read_handlers[address])
-        {
-            return read_handlers[address]();
-        }
-        else
+        auto& handler { readers_[index(port)] };
+
+        if (handler.kind != handler_kind::storage || !reader)
         {
-            return io_space[address].value();
+            return false;
         }
+
+        // Key by index, so that aliases of a port share a handler
+        auto& owner { read_handlers[index(port)] };
+        owner = std::move(reader);
+        handler = { handler_kind::std_function, nullptr, &owner };
+
+        return true;
     }
 
-    void Io::write_binary(int address, unsigned char data)
+    bool Io::bind(int port, write_handler_t writer)
     {
-        if (write_handlers[address]) {
-            write_handlers[address](data);
-        }
-        else
+        auto& handler { writers_[index(port)] };
+
+        if (handler.kind != handler_kind::storage || !writer)
         {
-            io_space[address] = data;
+            return false;
         }
+
+        auto& owner { write_handlers[index(port)] };
+        owner = std::move(writer);
+        handler = { handler_kind::std_function, nullptr, &owner };
+
+        return true;
     }
 
-    bool Io::bind(int port, read_handler_t reader)
+    bool Io::bind(int port, read_function reader, void* context)
     {
-        if (read_handlers[port])
+        auto& handler { readers_[index(port)] };
+
+        if (handler.kind != handler_kind::storage || reader == nullptr)
         {
             return false;
         }
-        else
-        {
-            read_handlers[port] = reader;
-            return true;
-        }
+
+        handler = { handler_kind::function, reader, context };
+        return true;
     }
 
-    bool Io::bind(int port, write_handler_t writer)
+    bool Io::bind(int port, write_function writer, void* context)
     {
-        if (write_handlers[port])
+        auto& handler { writers_[index(port)] };
+
+        if (handler.kind != handler_kind::storage || writer == nullptr)
         {
             return false;
         }
-        else
-        {
-            write_handlers[port] = writer;
-            return true;
-        }
+
+        handler = { handler_kind::function, writer, context };
+        return true;
     }
 
     void Io::unbind(int port, RW which)
     {
+        const auto i { index(port) };
+
         switch (which)
         {
             case RW::read:
-                read_handlers.erase(port);
+                readers_[i] = {};
+                read_handlers.erase(i);
                 break;
 
             case RW::write:
-                write_handlers.erase(port);
+                writers_[i] = {};
+                write_handlers.erase(i);
                 break;
         }
     }
+
+    bool Io::bound(int port, RW which) const
+    {
+        const auto i { index(port) };
+
+        return (which == RW::read) ? readers_[i].kind != handler_kind::storage
+            : writers_[i].kind != handler_kind::storage;
+    }
 }
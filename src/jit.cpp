@@ -0,0 +1,677 @@
+#include "jit.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#include <sys/mman.h>
+#endif
+
+#include "cpu.hpp"
+
+namespace ternary
+{
+    namespace
+    {
+        // Host registers, numbered as in x86 instruction encodings
+        enum host : std::uint8_t
+        {
+            eax = 0,
+            ecx = 1,
+            edx = 2,
+            ebx = 3,
+            esi = 6,
+            edi = 7
+        };
+
+        // Condition codes for Jcc
+        enum condition : std::uint8_t
+        {
+            equal = 0x4,
+            not_equal = 0x5,
+            less = 0xc,
+            greater_equal = 0xd,
+            less_equal = 0xe,
+            greater = 0xf
+        };
+
+        /**
+         * @brief Writes x86-64 machine code into a byte vector. This knows
+         * only the handful of instructions the compiler needs. CpuState
+         * fields are addressed through rbx, and the CPU pointer is in r12.
+         */
+        class Emitter
+        {
+            public:
+            using label = std::size_t;
+
+            std::vector<std::uint8_t> code;
+
+            label new_label()
+            {
+                targets_.push_back(std::size_t { unbound });
+                return targets_.size() - 1;
+            }
+
+            void bind(label l) { targets_[l] = code.size(); }
+
+            // push rbx; push r12; push r13; mov rbx, rdi; mov r12, rsi
+            // Three pushes leave the stack 16-byte aligned for calls.
+            void prologue() { bytes({ 0x53, 0x41, 0x54, 0x41, 0x55, 0x48, 0x89, 0xfb, 0x49, 0x89, 0xf4 }); }
+
+            // pop r13; pop r12; pop rbx; ret
+            void epilogue() { bytes({ 0x41, 0x5d, 0x41, 0x5c, 0x5b, 0xc3 }); }
+
+            // mov r32, [rbx + disp]
+            void load(host r, int disp) { byte(0x8b); field(r, disp); }
+
+            // mov [rbx + disp], r32
+            void store(int disp, host r) { byte(0x89); field(r, disp); }
+
+            // mov dword [rbx + disp], imm
+            void store_immediate(int disp, std::int32_t imm) { byte(0xc7); field(0, disp); dword(imm); }
+
+            // add dword [rbx + disp], imm
+            void add_to_field(int disp, std::int32_t imm) { byte(0x81); field(0, disp); dword(imm); }
+
+            // cmp dword [rbx + disp], imm
+            void compare_field(int disp, std::int32_t imm) { byte(0x81); field(7, disp); dword(imm); }
+
+            // mov r32, imm
+            void move_immediate(host r, std::int32_t imm) { byte(0xb8 + r); dword(imm); }
+
+            // mov dst, src
+            void move(host dst, host src) { byte(0x89); byte(0xc0 | src << 3 | dst); }
+
+            // add dst, src / sub dst, src / cmp dst, src
+            void add(host dst, host src) { byte(0x01); byte(0xc0 | src << 3 | dst); }
+            void sub(host dst, host src) { byte(0x29); byte(0xc0 | src << 3 | dst); }
+            void compare(host dst, host src) { byte(0x39); byte(0xc0 | src << 3 | dst); }
+
+            // add r32, imm / sub r32, imm / cmp r32, imm
+            void add_immediate(host r, std::int32_t imm) { byte(0x81); byte(0xc0 | r); dword(imm); }
+            void sub_immediate(host r, std::int32_t imm) { byte(0x81); byte(0xe8 | r); dword(imm); }
+            void compare_immediate(host r, std::int32_t imm) { byte(0x81); byte(0xf8 | r); dword(imm); }
+
+            // xor r, r
+            void clear(host r) { byte(0x31); byte(0xc0 | r << 3 | r); }
+
+            // mov rdi, r12; mov rax, target; call rax
+            void call(const void* target)
+            {
+                std::uint64_t address;
+                std::memcpy(&address, &target, sizeof address);
+
+                bytes({ 0x4c, 0x89, 0xe7, 0x48, 0xb8 });
+                qword(address);
+                bytes({ 0xff, 0xd0 });
+            }
+
+            // mov r13d, eax / test r13d, r13d
+            void save_result() { bytes({ 0x41, 0x89, 0xc5 }); }
+            void test_saved_result() { bytes({ 0x45, 0x85, 0xed }); }
+
+            void jump(label l) { byte(0xe9); reference(l); }
+            void jump(condition c, label l) { byte(0x0f); byte(0x80 | c); reference(l); }
+
+            // Patch every jump with its target's offset
+            void resolve()
+            {
+                for (auto& f : fixups_)
+                {
+                    const auto rel { static_cast<std::int32_t>(targets_[f.second] - (f.first + 4)) };
+                    std::memcpy(&code[f.first], &rel, sizeof rel);
+                }
+            }
+
+            private:
+            static constexpr std::size_t unbound = ~std::size_t { 0 };
+
+            void byte(std::uint8_t b) { code.push_back(b); }
+            void bytes(std::initializer_list<std::uint8_t> bs) { code.insert(code.end(), bs); }
+
+            void dword(std::int32_t d)
+            {
+                std::uint8_t b[sizeof d];
+                std::memcpy(b, &d, sizeof d);
+                code.insert(code.end(), b, b + sizeof d);
+            }
+
+            void qword(std::uint64_t q)
+            {
+                std::uint8_t b[sizeof q];
+                std::memcpy(b, &q, sizeof q);
+                code.insert(code.end(), b, b + sizeof q);
+            }
+
+            // ModRM for [rbx + disp32], with a register or opcode extension
+            void field(std::uint8_t reg, int disp) { byte(0x80 | reg << 3 | ebx); dword(disp); }
+
+            void reference(label l)
+            {
+                fixups_.emplace_back(code.size(), l);
+                dword(0);
+            }
+
+            std::vector<std::size_t> targets_;
+            std::vector<std::pair<std::size_t, label>> fixups_;
+        };
+
+        // Offsets of the CpuState fields
+        constexpr int flags_field { offsetof(CpuState, flag_register) };
+        constexpr int carry_field { flags_field + offsetof(FlagRegister, carry) };
+        constexpr int result_field { flags_field + offsetof(FlagRegister, result) };
+        constexpr int ip_field { offsetof(CpuState, ip) };
+        constexpr int retired_field { offsetof(CpuState, retired) };
+        constexpr int budget_field { offsetof(CpuState, budget) };
+
+        // Registers are a flat array, with rz first
+        constexpr int register_field(int r)
+            { return offsetof(CpuState, registers) + 4 * (r - Registers::zero_register); }
+
+        constexpr int word_range { pow3(Word::word_size) };
+        constexpr int word_half { word_range / 2 };
+
+        int next_address(int address) { return add(Word { address }, 3).first.value(); }
+
+        // The CPU's memory access functions for compiled code, indexed
+        // by hexad_select
+        struct Helpers
+        {
+            const void* load[4];
+            const void* store[4];
+        };
+
+        /**
+         * @brief Compiles one block. Each instruction handler emits code
+         * that has the same effect on CpuState as the interpreter has on
+         * the CPU, or returns false if it can't.
+         */
+        class BlockCompiler
+        {
+            public:
+            BlockCompiler(int start, const Helpers& helpers): start_(start), helpers_(helpers)
+            {
+                e.prologue();
+                e.bind(top_);
+            }
+
+            Emitter e;
+            CompiledBlock result;
+
+            bool instruction(const Opcode& op, int address, int index)
+            {
+                address_ = address;
+                index_ = index;
+
+                switch (op.o)
+                {
+                    case 0:
+                        // Only NOP
+                        return op.m == -11;
+                    case 1:
+                        return tritwise(op);
+                    case 4:
+                        return arithmetic(op);
+                    case 8:
+                        return register_op(op);
+                    case 10:
+                        return branch(op);
+                    case 11:
+                    case 12:
+                    case 13:
+                        return flag_branch(op);
+                    case -10:
+                        return indirect_store(op);
+                    default:
+                        return false;
+                }
+            }
+
+            // Leave for the interpreter, after `executed` instructions
+            void exit_to(int ip, int executed)
+            {
+                if (executed != 0)
+                {
+                    e.add_to_field(retired_field, executed);
+                }
+
+                e.store_immediate(ip_field, ip);
+                e.jump(done_);
+            }
+
+            void finish()
+            {
+                e.bind(done_);
+                e.epilogue();
+                e.resolve();
+            }
+
+            private:
+            int start_;
+            const Helpers& helpers_;
+            int address_ { 0 };
+            int index_ { 0 };
+
+            Emitter::label top_ { e.new_label() };
+            Emitter::label done_ { e.new_label() };
+
+            // Get a guest register into a host register. rz always reads as 0.
+            void read(host h, int r)
+            {
+                if (r == Registers::zero_register)
+                {
+                    e.clear(h);
+                    return;
+                }
+
+                e.load(h, register_field(r));
+            }
+
+            // Writes to rz are discarded
+            void write(int r, host h)
+            {
+                if (r == Registers::zero_register)
+                {
+                    return;
+                }
+
+                e.store(register_field(r), h);
+            }
+
+            // S is kept as the result it comes from (see FlagRegister)
+            void set_sign_from_eax() { e.store(result_field, eax); }
+
+            // eax holds a sum or difference of two words. Wrap it back into
+            // range, setting the carry and sign flags from it.
+            void wrap_and_set_flags()
+            {
+                const auto in_range { e.new_label() };
+                const auto not_high { e.new_label() };
+
+                e.clear(ecx);
+                e.compare_immediate(eax, word_half);
+                e.jump(less_equal, not_high);
+                e.sub_immediate(eax, word_range);
+                e.move_immediate(ecx, 1);
+                e.jump(in_range);
+
+                e.bind(not_high);
+                e.compare_immediate(eax, -word_half);
+                e.jump(greater_equal, in_range);
+                e.add_immediate(eax, word_range);
+                e.move_immediate(ecx, -1);
+
+                e.bind(in_range);
+                e.store(carry_field, ecx);
+                set_sign_from_eax();
+            }
+
+            // Go to a guest address after this instruction. Going back to
+            // the start of the block loops, while the budget lasts.
+            void go_to(int ip)
+            {
+                const auto executed { index_ + 1 };
+
+                if (ip != start_)
+                {
+                    exit_to(ip, executed);
+                    return;
+                }
+
+                e.add_to_field(retired_field, executed);
+                e.load(eax, retired_field);
+                e.load(ecx, budget_field);
+                e.compare(eax, ecx);
+                e.jump(less, top_);
+                e.store_immediate(ip_field, start_);
+                e.jump(done_);
+            }
+
+            // Relative branch target, as branch_relative and branch_on_flag
+            // work it out. A branch to itself leaves IP unchanged, so
+            // the CPU moves on to the next instruction.
+            int branch_target(int disp)
+            {
+                const auto target { add(Word { address_ }, disp).first.value() };
+                return (target == address_) ? next_address(address_) : target;
+            }
+
+            bool tritwise(const Opcode& op)
+            {
+                switch (op.m)
+                {
+                    case -8:
+                        // CMI
+                        read(eax, op.x);
+                        e.sub_immediate(eax, op.low6());
+                        wrap_and_set_flags();
+                        return true;
+                    case -9:
+                        // CMP
+                        read(eax, op.y);
+                        read(ecx, op.z);
+                        e.sub(eax, ecx);
+                        wrap_and_set_flags();
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+
+            bool arithmetic(const Opcode& op)
+            {
+                switch (op.m)
+                {
+                    case 9:
+                    case -9:
+                        // ADD/SUB x, y, z
+                        read(eax, op.x);
+                        read(ecx, op.y);
+                        if (op.m == 9)
+                        {
+                            e.add(eax, ecx);
+                        }
+                        else
+                        {
+                            e.sub(eax, ecx);
+                        }
+
+                        wrap_and_set_flags();
+                        write(op.z, eax);
+                        return true;
+                    case 11:
+                    case -8:
+                        // Long immediates (including INC and DEC)
+                        read(eax, op.t);
+                        if (op.m == 11)
+                        {
+                            e.add_immediate(eax, op.low9());
+                        }
+                        else
+                        {
+                            e.sub_immediate(eax, op.low9());
+                        }
+
+                        wrap_and_set_flags();
+                        write(op.t, eax);
+                        return true;
+                    case 13:
+                    case -6:
+                        // Short immediates
+                        read(eax, op.t);
+                        if (op.m == 13)
+                        {
+                            e.add_immediate(eax, op.low6());
+                        }
+                        else
+                        {
+                            e.sub_immediate(eax, op.low6());
+                        }
+
+                        wrap_and_set_flags();
+                        write(op.x, eax);
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+
+            bool register_op(const Opcode& op)
+            {
+                switch (op.m)
+                {
+                    case 0:
+                        // LDI (full word)
+                        e.move_immediate(eax, op.low6());
+                        write(op.x, eax);
+                        return true;
+                    case 1:
+                        // CLR, and setting to all + or all -
+                        if (op.t < -1 || op.t > 1)
+                        {
+                            return false;
+                        }
+
+                        e.move_immediate(eax, op.t * word_half);
+                        write(op.y, eax);
+                        return true;
+                    case 5:
+                        return indirect_load(op, hexad_select::low);
+                    case 6:
+                        return indirect_load(op, hexad_select::middle);
+                    case 7:
+                        return indirect_load(op, hexad_select::high);
+                    case 8:
+                        // LAD, with the A flag clear
+                        e.move_immediate(eax, op.low12());
+                        write(0, eax);
+                        return true;
+                    case 9:
+                        return indirect_load(op, hexad_select::full_word);
+                    case -1:
+                        // MOV (the source is Z)
+                        read(eax, op.z);
+                        write(op.y, eax);
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+
+            // Load through the address in Y into Z
+            bool indirect_load(const Opcode& op, hexad_select type)
+            {
+                read(esi, op.y);
+                read(edx, op.z);
+                e.call(helpers_.load[static_cast<int>(type)]);
+                write(op.z, eax);
+                set_sign_from_eax();
+                return true;
+            }
+
+            // Store Y through the address in Z
+            bool indirect_store(const Opcode& op)
+            {
+                hexad_select type;
+
+                switch (op.m)
+                {
+                    case 5:
+                        type = hexad_select::low;
+                        break;
+                    case 6:
+                        type = hexad_select::middle;
+                        break;
+                    case 7:
+                        type = hexad_select::high;
+                        break;
+                    case 9:
+                        type = hexad_select::full_word;
+                        break;
+                    default:
+                        return false;
+                }
+
+                read(esi, op.z);
+                read(edx, op.y);
+                e.call(helpers_.store[static_cast<int>(type)]);
+                e.save_result();
+
+                read(eax, op.y);
+                set_sign_from_eax();
+
+                // If the store hit a translated block (maybe this one),
+                // let the interpreter pick up from the next instruction
+                const auto unchanged { e.new_label() };
+                e.test_saved_result();
+                e.jump(equal, unchanged);
+                exit_to(next_address(address_), index_ + 1);
+                e.bind(unchanged);
+
+                return true;
+            }
+
+            bool branch(const Opcode& op)
+            {
+                switch (op.m)
+                {
+                    case 1:
+                        // BRR
+                        go_to(branch_target(op.low12()));
+                        return true;
+                    case -1:
+                        // BRS
+                        go_to(branch_target(op.low6()));
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+
+            bool flag_branch(const Opcode& op)
+            {
+                // Other flags are left to the interpreter
+                if (op.m != static_cast<int>(flags::carry) && op.m != static_cast<int>(flags::sign))
+                {
+                    return false;
+                }
+
+                const auto target { op.o - 12 };
+                const auto not_taken { e.new_label() };
+
+                if (op.m == static_cast<int>(flags::carry))
+                {
+                    e.compare_field(carry_field, target);
+                    e.jump(not_equal, not_taken);
+                }
+                else
+                {
+                    // S is the sign of the result, so compare that with 0
+                    e.compare_field(result_field, 0);
+                    e.jump(target > 0 ? less_equal : (target < 0 ? greater_equal : not_equal), not_taken);
+                }
+
+                go_to(branch_target(op.low12()));
+
+                e.bind(not_taken);
+                go_to(next_address(address_));
+                return true;
+            }
+        };
+    }
+
+    Jit::Jit()
+    {
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+        auto p { mmap(nullptr, buffer_size, PROT_READ | PROT_WRITE | PROT_EXEC,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+
+        if (p != MAP_FAILED)
+        {
+            buffer_ = static_cast<std::uint8_t*>(p);
+        }
+#endif
+    }
+
+    Jit::~Jit()
+    {
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+        if (buffer_ != nullptr)
+        {
+            munmap(buffer_, buffer_size);
+        }
+#endif
+    }
+
+    void Jit::reset() noexcept
+    {
+        used_ = 0;
+        blocks_.clear();
+        flushed_ = true;
+    }
+
+    const CompiledBlock* Jit::compile(const Cpu& cpu, const int address, const Block& block)
+    {
+        if (!available())
+        {
+            return nullptr;
+        }
+
+        using hs = hexad_select;
+
+        static const Helpers helpers {
+            {
+                reinterpret_cast<const void*>(&Cpu::jit_load<hs::low>),
+                reinterpret_cast<const void*>(&Cpu::jit_load<hs::middle>),
+                reinterpret_cast<const void*>(&Cpu::jit_load<hs::high>),
+                reinterpret_cast<const void*>(&Cpu::jit_load<hs::full_word>)
+            },
+            {
+                reinterpret_cast<const void*>(&Cpu::jit_store<hs::low>),
+                reinterpret_cast<const void*>(&Cpu::jit_store<hs::middle>),
+                reinterpret_cast<const void*>(&Cpu::jit_store<hs::high>),
+                reinterpret_cast<const void*>(&Cpu::jit_store<hs::full_word>)
+            }
+        };
+
+        BlockCompiler compiler { address, helpers };
+        auto current { address };
+        auto compiled { 0 };
+        auto ended { false };
+
+        for (auto i = 0u; i < block.length; ++i)
+        {
+            const Opcode op { cpu.memory.peek_word(current) };
+
+            if (!compiler.instruction(op, current, i))
+            {
+                break;
+            }
+
+            ++compiled;
+
+            // Branches emit their own exits
+            if (op.o >= 10 && op.o <= 13)
+            {
+                ended = true;
+                break;
+            }
+
+            current = next_address(current);
+        }
+
+        if (compiled == 0)
+        {
+            return nullptr;
+        }
+
+        if (!ended)
+        {
+            // Either the block ran out, or the next instruction
+            // is one for the interpreter
+            compiler.exit_to(current, compiled);
+        }
+
+        compiler.finish();
+
+        const auto& code { compiler.e.code };
+
+        if (used_ + code.size() > buffer_size)
+        {
+            reset();
+        }
+
+        std::memcpy(buffer_ + used_, code.data(), code.size());
+
+        auto native { std::make_unique<CompiledBlock>(compiler.result) };
+        native->code = reinterpret_cast<CompiledBlock::entry_point>(buffer_ + used_);
+
+        // Keep each block's code 16-byte aligned
+        used_ += (code.size() + 15) & ~std::size_t { 15 };
+
+        blocks_.push_back(std::move(native));
+        return blocks_.back().get();
+    }
+}
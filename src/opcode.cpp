@@ -1,26 +1,30 @@
 #include "opcode.hpp"
 #include "ternary_math.hpp"
+#include "convert.hpp"
 
 namespace ternary
 {
     Opcode::Opcode(const Word& w):
         value(w),
-        o(shift_right(w.high().get(), 3)),
-        m(low_trits(w.high().get(), 3)),
-        t(shift_right(w.middle().get(), 3)),
-        x(low_trits(w.middle().get(), 3)),
-        y(shift_right(w.low().get(), 3)),
-        z(low_trits(w.low().get(), 3))
+        o(hexad_to_triads(w.high().get())[0]),
+        m(hexad_to_triads(w.high().get())[1]),
+        t(hexad_to_triads(w.middle().get())[0]),
+        x(hexad_to_triads(w.middle().get())[1]),
+        y(hexad_to_triads(w.low().get())[0]),
+        z(hexad_to_triads(w.low().get())[1])
     {}
 
     Opcode::Opcode(int o_, int m_, int t_, int x_, int y_, int z_):
-        value({o_ * pow3(3) + m_, t_ * pow3(3) + x_, y_ * pow3(3) + z_}),
+        value({triads_to_hexad(o_, m_), triads_to_hexad(t_, x_), triads_to_hexad(y_, z_)}),
         o(o_), m(m_), t(t_), x(x_), y(y_), z(z_)
     {}
 
+    // The immediates are read straight from the hexads, which already
+    // hold the fields together
+
     int Opcode::low6() const
     {
-        return y * pow3(3) + z;
+        return value.low().get();
     }
 
     int Opcode::low9() const
@@ -30,6 +34,6 @@ namespace ternary
 
     int Opcode::low12() const
     {
-        return t * pow3(9) + low9();
+        return value.middle().get() * pow3(6) + low6();
     }
-}
\ No newline at end of file
+}
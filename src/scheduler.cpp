@@ -0,0 +1,31 @@
+#include "scheduler.hpp"
+
+namespace ternary
+{
+    constexpr Scheduler::time Scheduler::never;
+
+    void Scheduler::run_due()
+    {
+        while (!queue_.empty() && queue_.top().when <= now_)
+        {
+            const auto event { queue_.top() };
+            queue_.pop();
+
+            const auto found { actions_.find(event.id) };
+
+            if (found == actions_.end())
+            {
+                // Cancelled
+                continue;
+            }
+
+            // The action may schedule more events, so take it out first
+            const auto action { std::move(found->second) };
+            actions_.erase(found);
+
+            action();
+        }
+
+        next_ = queue_.empty() ? never : queue_.top().when;
+    }
+}
@@ -244,7 +244,95 @@ void Shell::handle_command(const std::string& input)
 
             ip_ = cpu_.get_instruction_pointer();
 
-            cpu_.run();
+            const auto result { cpu_.run() };
+            repl_.print("Stopped (%s) after %zu instructions\n", to_string(result.reason).c_str(), result.retired);
+
+            if (!result.error.empty())
+            {
+                repl_.print("%s\n", result.error.c_str());
+            }
+
+            if (result.reason == stop_reason::watchpoint)
+            {
+                for (const auto& hit : cpu_.watch_hits())
+                {
+                    const auto kind { (hit.kind == watch_read) ? "read" : (hit.kind == watch_write) ? "write" : "change" };
+
+                    repl_.print("Watchpoint %zu: %s at %d by IP %d (%d -> %d)\n", hit.id, kind,
+                        hit.address, hit.ip, hit.old_value, hit.new_value);
+                }
+            }
+        }
+        else if (matches[1] == "watch")
+        {
+            ////
+            // Stop on writes to a range of memory
+            ////
+
+            std::smatch watch_matches;
+            std::string rest { matches[2].str() };
+            if (std::regex_match(rest, watch_matches, match_range))
+            {
+                const auto first { word_to_value(watch_matches[1].str()) };
+                const auto last { watch_matches[2].str().empty() ? first + 2 : word_to_value(watch_matches[2].str()) };
+
+                try
+                {
+                    const auto id { cpu_.add_watchpoint({ first, last, watch_write }) };
+                    repl_.print("Watchpoint %zu\n", id);
+                }
+                catch (const std::out_of_range&)
+                {
+                    repl_.print("Invalid memory range\n");
+                }
+            }
+            else
+            {
+                repl_.print("Invalid format\n");
+            }
+        }
+        else if (matches[1] == "unwatch")
+        {
+            const std::string rest { matches[2].str() };
+
+            if (std::regex_match(rest, std::regex { R"([0-9]{1,9})" }))
+            {
+                cpu_.remove_watchpoint(std::stoul(rest));
+            }
+            else
+            {
+                repl_.print("Invalid watchpoint\n");
+            }
+        }
+        else if (matches[1] == "device" || matches[1] == "devices")
+        {
+            ////
+            // List devices, or load one from a plugin
+            ////
+
+            std::smatch device_matches;
+            std::string rest { matches[2].str() };
+
+            if (rest.empty())
+            {
+                for (const auto d : cpu_.get_devices())
+                {
+                    const auto range { d->ports() };
+                    repl_.print("%s: ports %d to %d\n", d->name().c_str(), range.first, range.first + range.count - 1);
+                }
+            }
+            else if (std::regex_match(rest, device_matches, std::regex { R"((\S+)(?:\s+(.*))?)" }))
+            {
+                try
+                {
+                    const auto& device { cpu_.load_device(device_matches[1].str(), device_matches[2].str()) };
+                    repl_.print("Loaded %s\n", device.name().c_str());
+                }
+                catch (const std::exception& e)
+                {
+                    repl_.print("Can't load device: %s\n", e.what());
+                }
+            }
         }
         else if (matches[1] == "ip")
         {
@@ -0,0 +1,132 @@
+#include "timer.hpp"
+
+namespace ternary
+{
+    int IntervalTimer::read(int port)
+    {
+        switch (port - base_port)
+        {
+            case 0:
+                return mode_;
+            case 1:
+                return interval_;
+            case 2:
+                return count();
+            default:
+                return 0;
+        }
+    }
+
+    void IntervalTimer::write(int port, int value)
+    {
+        switch (port - base_port)
+        {
+            case 0:
+                if (value == 0)
+                {
+                    stop();
+                }
+                else
+                {
+                    start((value > 0) ? periodic : one_shot, interval_);
+                }
+                break;
+            case 1:
+                interval_ = value;
+                break;
+            default:
+                break;
+        }
+    }
+
+    void IntervalTimer::reset()
+    {
+        stop();
+        interval_ = 0;
+        line_.lower();
+    }
+
+    std::vector<int> IntervalTimer::save() const
+    {
+        return { mode_, interval_, count() };
+    }
+
+    void IntervalTimer::restore(const std::vector<int>& state)
+    {
+        if (state.size() != 3)
+        {
+            return;
+        }
+
+        stop();
+        interval_ = state[1];
+
+        if (state[0] != stopped && scheduler_ != nullptr)
+        {
+            mode_ = (state[0] > 0) ? periodic : one_shot;
+            arm(scheduler_->now() + state[2]);
+        }
+    }
+
+    /**
+     * @brief Start the timer, which stops it first if it's running.
+     * 
+     * @param m Periodic or one-shot
+     * @param interval The number of instructions until it runs out
+     */
+    void IntervalTimer::start(const timer_mode m, const int interval)
+    {
+        stop();
+        interval_ = interval;
+
+        if (m == stopped || interval <= 0 || scheduler_ == nullptr)
+        {
+            return;
+        }
+
+        mode_ = m;
+        arm(scheduler_->now() + interval);
+    }
+
+    void IntervalTimer::stop()
+    {
+        if (scheduler_ != nullptr && mode_ != stopped)
+        {
+            scheduler_->cancel(event_);
+        }
+
+        mode_ = stopped;
+    }
+
+    int IntervalTimer::count() const noexcept
+    {
+        if (mode_ == stopped || scheduler_ == nullptr)
+        {
+            return 0;
+        }
+
+        return static_cast<int>(deadline_ - scheduler_->now());
+    }
+
+    void IntervalTimer::arm(const Scheduler::time when)
+    {
+        deadline_ = when;
+        event_ = scheduler_->schedule_at(when, [this]() { expire(); });
+    }
+
+    void IntervalTimer::expire()
+    {
+        line_.raise();
+
+        if (mode_ == periodic)
+        {
+            // From the deadline, not the time now, so the period doesn't
+            // drift if the CPU was late getting here
+            arm(deadline_ + interval_);
+        }
+        else
+        {
+            mode_ = stopped;
+        }
+    }
+}
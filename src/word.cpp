@@ -1,12 +1,37 @@
 #include <string>
 #include <tuple>
 #include <algorithm>
+#include <array>
 
 #include "word.hpp"
+#include "double_word.hpp"
 #include "ternary_math.hpp"
 
 namespace ternary
 {
+    namespace
+    {
+        template<std::size_t... Is>
+        constexpr auto generate_powers_of_3(std::index_sequence<Is...>) noexcept
+            -> std::array<long long, sizeof...(Is)>
+        {
+            return {{ pow3<long long>(Is)... }};
+        }
+
+        // Enough for a shift or rotate through carry of a whole word
+        constexpr auto powers_of_3 { generate_powers_of_3(std::make_index_sequence<Word::word_size + 2>{}) };
+
+        template<std::size_t... Is>
+        constexpr auto generate_shifts(std::index_sequence<Is...>) noexcept
+            -> std::array<int (*)(int), sizeof...(Is)>
+        {
+            return {{ &shift_right<Is, int>... }};
+        }
+
+        // shift_right_by[n] is shift_right<n>, so each one divides by a constant
+        constexpr auto shift_right_by { generate_shifts(std::make_index_sequence<Word::word_size + 1>{}) };
+    }
+
     std::string Word::value_string() const noexcept
     {
         std::string result { "%" };
@@ -28,61 +53,49 @@ namespace ternary
         return result;
     }
 
-    std::string Word::raw_trit_string() const noexcept
+    Word::trit_container Word::trits() const noexcept
     {
-        auto result { high_.trit_string() };
-        result += middle_.trit_string();
-        result += low_.trit_string();
-
-        return result;
-    }
+        trit_container result;
 
-    addition_result add(const Word& lhs, Word rhs) noexcept
-    {
-        // Note: This is the only case where we *don't* use only
-        // const refs for Word arguments. We're effectively using
-        // the `rhs` as a temporary accumulator variable, so it
-        // can't be const. But we also don't want to change the
-        // original, so it has to be passed by value.
-        Hexad low, middle, high;
-        int lowc, midc, highc;
+        // Compose from the hexads' table rows, low to high
+        const auto& lt { hexad_to_trits(low_.get()) };
+        const auto& mt { hexad_to_trits(middle_.get()) };
+        const auto& ht { hexad_to_trits(high_.get()) };
 
-        std::tie(low, lowc) = add_with_carry(lhs.low(), rhs.low());
-        rhs.set_middle(rhs.middle().get() + lowc);
-        std::tie(middle, midc) = add_with_carry(lhs.middle(), rhs.middle());
-        rhs.set_high(rhs.high().get() + midc);
-        std::tie(high, highc) = add_with_carry(lhs.high(), rhs.high());
+        std::copy(lt.begin(), lt.end(), result.begin());
+        std::copy(mt.begin(), mt.end(), result.begin()+middle_power);
+        std::copy(ht.begin(), ht.end(), result.begin()+high_power);
 
-        return { {high, middle, low}, highc };
+        return result;
     }
 
-    addition_result add(const Word& lhs, Word::value_type rhs) noexcept
+    std::string Word::raw_trit_string() const noexcept
     {
-        return add(lhs, Word{ rhs });
-    }
+        auto result { high_.trit_string() };
+        result += middle_.trit_string();
+        result += low_.trit_string();
 
-    addition_result sub(const Word& lhs, const Word& rhs) noexcept
-    {
-        return add(lhs, sti(rhs));
+        return result;
     }
 
-    addition_result sub(const Word& lhs, Word::value_type rhs) noexcept
+    addition_result add_by_hexads(const Word& lhs, const Word& rhs) noexcept
     {
-        return add(lhs, Word{ -rhs });
-    }
+        // Each carry goes into the sum for the next hexad up, which
+        // can briefly be outside the range of a hexad. (Adding it
+        // to the rhs hexad first would wrap it, losing the carry.)
+        const auto low_sum { lhs.low().get() + rhs.low().get() };
+        const auto lowc { shift_right<Hexad::width>(low_sum) };
+        const auto middle_sum { lhs.middle().get() + rhs.middle().get() + lowc };
+        const auto midc { shift_right<Hexad::width>(middle_sum) };
+        const auto high_sum { lhs.high().get() + rhs.high().get() + midc };
+        const auto highc { shift_right<Hexad::width>(high_sum) };
 
-    multiplication_result mul(const Word& lhs, const Word& rhs) noexcept
-    {
-        return mul(lhs, rhs.value());
+        return { {high_sum, middle_sum, low_sum}, highc };
     }
 
-    multiplication_result mul(const Word& lhs, Word::value_type rhs) noexcept
+    addition_result sub_by_hexads(const Word& lhs, const Word& rhs) noexcept
     {
-        long long result = lhs.value() * static_cast<long long>(rhs);
-        return {
-            { static_cast<Word::value_type>(low_trits(result, Word::word_size)) },
-            { static_cast<Word::value_type>(shift_right(result, Word::word_size)) }
-        };
+        return add_by_hexads(lhs, sti(rhs));
     }
 
     division_result div(const Word& lhs, const Word& rhs) noexcept
@@ -98,26 +111,6 @@ namespace ternary
         return { {d}, {r} };
     }
 
-    division_result div(division_dividend lhs, const Word& rhs) noexcept
-    {
-        return div(lhs, rhs.value());
-    }
-
-    division_result div(division_dividend lhs, Word::value_type rhs) noexcept
-    {
-        long long dividend = lhs.first.value() * pow3<long long>(Word::word_size) + lhs.second.value();
-
-        // Note: double-precision division can overflow
-        // TODO We should check for this
-        auto d { dividend / rhs };
-        auto r { dividend % rhs };
-
-        return {
-            {static_cast<Word::value_type>(d)},
-            {static_cast<Word::value_type>(r)}
-        };
-    }
-
     shift_result shl(const Word& operand, const Word& places) noexcept
     {
         return shl(operand, places.value());
@@ -125,30 +118,20 @@ namespace ternary
 
     shift_result shl(const Word& operand, Word::value_type places) noexcept
     {
-        if (places > Word::word_size + 1)
+        if (places < 0 || places > Word::word_size)
         {
             return { {0}, 0 };
         }
+        else if (places == 0)
+        {
+            return { operand, 0 };
+        }
 
-        Word::trit_container_with_carry trits;
-        auto ht { operand.high().trits() };
-        auto mt { operand.middle().trits() };
-        auto lt { operand.low().trits() };
-
-        std::copy(lt.begin(), lt.end(), trits.begin());
-        std::copy(mt.begin(), mt.end(), trits.begin()+Word::middle_power);
-        std::copy(ht.begin(), ht.end(), trits.begin()+Word::high_power);
-        trits[Word::word_size] = 0;
-
-        // Shift isn't in STL until C++20, but we can fake it with rotate
-        std::rotate(trits.rbegin(), trits.rbegin()+places, trits.rend());
-        std::fill_n(trits.begin(), places, 0);
-
-        auto carry { trits[Word::word_size] };
-
-        trits[Word::word_size] = 0;
+        // Multiplying by 3**places moves the top trits past the
+        // end of the word. The last one shifted out is the carry.
+        const auto shifted { detail::split_trits<Word::word_size>(operand.value() * powers_of_3[places]) };
 
-        return { { to_decimal(trits) }, carry };
+        return { { static_cast<Word::value_type>(shifted.first) }, nth_trit<0>(static_cast<int>(shifted.second)) };
     }
 
     shift_result shr(const Word& operand, const Word& places) noexcept
@@ -158,7 +141,7 @@ namespace ternary
 
     shift_result shr(const Word& operand, Word::value_type places) noexcept
     {
-        if (places > Word::word_size + 1)
+        if (places < 0 || places > Word::word_size)
         {
             return { {0}, 0 };
         }
@@ -167,25 +150,12 @@ namespace ternary
             return { operand, 0 };
         }
 
-        Word::trit_container_with_carry trits;
-        auto ht { operand.high().trits() };
-        auto mt { operand.middle().trits() };
-        auto lt { operand.low().trits() };
+        // Shift all but the last place, so the trit we're
+        // about to shift out is the lowest one.
+        const auto shifted { shift_right_by[places - 1](operand.value()) };
+        const auto carry { nth_trit<0>(shifted) };
 
-        std::copy(lt.begin(), lt.end(), trits.begin());
-        std::copy(mt.begin(), mt.end(), trits.begin()+Word::middle_power);
-        std::copy(ht.begin(), ht.end(), trits.begin()+Word::high_power);
-        trits[Word::word_size] = 0;
-
-        // Shift isn't in STL until C++20, but we can fake it with rotate
-        std::rotate(trits.begin(), trits.begin()+places, trits.end());
-        std::fill_n(trits.rbegin()+1, places, 0); // +1 because carry
-
-        auto carry { trits[Word::word_size] };
-
-        trits[Word::word_size] = 0;
-
-        return { { to_decimal(trits) }, carry };
+        return { { (shifted - carry) / 3 }, carry };
     }
 
     shift_result rol(const Word& operand, const Word& places) noexcept
@@ -195,29 +165,22 @@ namespace ternary
 
     shift_result rol(const Word& operand, Word::value_type places) noexcept
     {
-        if (places > Word::word_size + 1)
+        if (places < 0 || places > Word::word_size + 1)
         {
             return { {0}, 0 };
         }
-        else if (places == 0)
+
+        const auto p { places % Word::word_size };
+
+        if (p == 0)
         {
             return { operand, 0 };
         }
 
-        Word::trit_container trits;
-        auto ht { operand.high().trits() };
-        auto mt { operand.middle().trits() };
-        auto lt { operand.low().trits() };
-
-        std::copy(lt.begin(), lt.end(), trits.begin());
-        std::copy(mt.begin(), mt.end(), trits.begin()+Word::middle_power);
-        std::copy(ht.begin(), ht.end(), trits.begin()+Word::high_power);
-
-        std::rotate(trits.rbegin(), trits.rbegin()+places, trits.rend());
-
-        trits[Word::word_size] = 0;
+        // The trits shifted off the top come back in at the bottom
+        const auto shifted { detail::split_trits<Word::word_size>(operand.value() * powers_of_3[p]) };
 
-        return { { to_decimal(trits) }, 0 };
+        return { { static_cast<Word::value_type>(shifted.first + shifted.second) }, 0 };
     }
 
     shift_result ror(const Word& operand, const Word& places) noexcept
@@ -227,29 +190,12 @@ namespace ternary
 
     shift_result ror(const Word& operand, Word::value_type places) noexcept
     {
-        if (places > Word::word_size + 1)
+        if (places < 0 || places > Word::word_size + 1)
         {
             return { {0}, 0 };
         }
-        else if (places == 0)
-        {
-            return { operand, 0 };
-        }
-
-        Word::trit_container trits;
-        auto ht { operand.high().trits() };
-        auto mt { operand.middle().trits() };
-        auto lt { operand.low().trits() };
 
-        std::copy(lt.begin(), lt.end(), trits.begin());
-        std::copy(mt.begin(), mt.end(), trits.begin()+Word::middle_power);
-        std::copy(ht.begin(), ht.end(), trits.begin()+Word::high_power);
-
-        std::rotate(trits.begin(), trits.begin()+places, trits.end());
-
-        trits[Word::word_size] = 0;
-
-        return { { to_decimal(trits) }, 0 };
+        return rol(operand, (Word::word_size - places % Word::word_size) % Word::word_size);
     }
 
     shift_result rcl(const Word& operand, int carry, const Word& places) noexcept
@@ -259,7 +205,7 @@ namespace ternary
 
     shift_result rcl(const Word& operand, int carry, Word::value_type places) noexcept
     {
-        if (places > Word::word_size + 1)
+        if (places < 0 || places > Word::word_size + 1)
         {
             return { {0}, 0 };
         }
@@ -268,23 +214,14 @@ namespace ternary
             return { operand, carry };
         }
 
-        Word::trit_container_with_carry trits;
-        auto ht { operand.high().trits() };
-        auto mt { operand.middle().trits() };
-        auto lt { operand.low().trits() };
-
-        std::copy(lt.begin(), lt.end(), trits.begin());
-        std::copy(mt.begin(), mt.end(), trits.begin()+Word::middle_power);
-        std::copy(ht.begin(), ht.end(), trits.begin()+Word::high_power);
-        trits[Word::word_size] = 0;
-
-        std::rotate(trits.rbegin(), trits.rbegin()+places, trits.rend());
+        // Rotate 19 trits, with the carry as the top one, then split
+        // it back off. The carry trit starts out as 0, not the carry
+        // passed in; only the carry out is kept.
+        constexpr auto width { Word::word_size + 1 };
+        const auto shifted { detail::split_trits<width>(operand.value() * powers_of_3[places]) };
+        const auto rotated { detail::split_trits<Word::word_size>(shifted.first + shifted.second) };
 
-        carry = trits[Word::word_size];
-
-        trits[Word::word_size] = 0;
-
-        return { { to_decimal(trits) }, carry };
+        return { { static_cast<Word::value_type>(rotated.first) }, static_cast<int>(rotated.second) };
     }
 
     shift_result rcr(const Word& operand, int carry, const Word& places) noexcept
@@ -294,7 +231,7 @@ namespace ternary
 
     shift_result rcr(const Word& operand, int carry, Word::value_type places) noexcept
     {
-        if (places > Word::word_size + 1)
+        if (places < 0 || places > Word::word_size + 1)
         {
             return { {0}, 0 };
         }
@@ -303,23 +240,7 @@ namespace ternary
             return { operand, carry };
         }
 
-        Word::trit_container_with_carry trits;
-        auto ht { operand.high().trits() };
-        auto mt { operand.middle().trits() };
-        auto lt { operand.low().trits() };
-
-        std::copy(lt.begin(), lt.end(), trits.begin());
-        std::copy(mt.begin(), mt.end(), trits.begin()+Word::middle_power);
-        std::copy(ht.begin(), ht.end(), trits.begin()+Word::high_power);
-        trits[Word::word_size] = 0;
-
-        std::rotate(trits.begin(), trits.begin()+places, trits.end());
-
-        carry = trits[Word::word_size];
-
-        trits[Word::word_size] = 0;
-
-        return { { to_decimal(trits) }, carry };
+        return rcl(operand, 0, Word::word_size + 1 - places);
     }
 
     Word sti(const Word& operand) noexcept
@@ -354,7 +275,7 @@ namespace ternary
         return {
             trit_minimum(lhs.high(), rhs.high()),
             trit_minimum(lhs.middle(), rhs.middle()),
-            trit_maximum(lhs.low(), rhs.low())
+            trit_minimum(lhs.low(), rhs.low())
         };
     }
 
@@ -421,14 +342,7 @@ namespace ternary
 
         int16_t result { 0 };
 
-        Word::trit_container trits;
-        auto ht { operand.high().trits() };
-        auto mt { operand.middle().trits() };
-        auto lt { operand.low().trits() };
-
-        std::copy(lt.begin(), lt.end(), trits.begin());
-        std::copy(mt.begin(), mt.end(), trits.begin()+Word::middle_power);
-        std::copy(ht.begin(), ht.end(), trits.begin()+Word::high_power);
+        auto trits { operand.trits() };
 
         for (auto i = 0; i < 16; ++i)
         {
@@ -0,0 +1,220 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "cpu.hpp"
+#include "aot.hpp"
+#include "timer.hpp"
+
+#include "test_program.hpp"
+
+using ternary::Cpu;
+using ternary::AotTranslator;
+using ternary::IntervalTimer;
+using ternary::execution_mode;
+
+using namespace test_program;
+
+struct AotFixture
+{
+    AotFixture()
+    {
+        for (auto c : { stepped.get(), compiled.get() })
+        {
+            c->reset();
+            c->set_instruction_pointer(origin);
+            c->set_reg(stack_register, stack);
+        }
+    }
+
+    ~AotFixture() = default;
+
+    // Put the same program in both CPUs, and keep it as an image
+    void program(std::initializer_list<int> words)
+    {
+        load({ stepped.get(), compiled.get() }, origin, words);
+
+        auto address { origin };
+
+        for (auto w : words)
+        {
+            const ternary::Word word { w };
+
+            image[address] = word.low();
+            image[address + 1] = word.middle();
+            image[address + 2] = word.high();
+
+            address += 3;
+        }
+    }
+
+    // Compile the image and load it into the second CPU
+    void compile()
+    {
+        const auto tmp { std::getenv("TMPDIR") };
+        const std::string dir { (tmp != nullptr && *tmp != '\0') ? tmp : "/tmp" };
+
+        compiled->load_image(AotTranslator { image }.build(dir + "/trireme-aot-test"));
+    }
+
+    // Run both CPUs to a breakpoint, returning the instruction count
+    std::size_t run()
+    {
+        std::size_t steps { 1 };
+        std::size_t retired { 0 };
+
+        while (!stepped->step())
+        {
+            ++steps;
+        }
+
+        while (true)
+        {
+            const auto result { compiled->step_block() };
+            retired += result.retired;
+
+            if (result.breakpoint)
+            {
+                break;
+            }
+        }
+
+        BOOST_TEST(retired == steps);
+        return retired;
+    }
+
+    void check_same_state()
+    {
+        for (auto r = -13; r <= 13; ++r)
+        {
+            BOOST_TEST(stepped->get_register(r).value() == compiled->get_register(r).value());
+        }
+
+        BOOST_TEST(stepped->get_instruction_pointer().value() == compiled->get_instruction_pointer().value());
+    }
+
+    std::unique_ptr<Cpu> stepped { new Cpu() };
+    std::unique_ptr<Cpu> compiled { new Cpu() };
+
+    AotTranslator::data_map image;
+
+    static constexpr int stack_register { -6 };
+    static constexpr int stack { 2999 };
+};
+
+constexpr int AotFixture::stack;
+
+BOOST_FIXTURE_TEST_SUITE(aot, AotFixture)
+
+BOOST_AUTO_TEST_CASE(translator_finds_blocks)
+{
+    program({
+        ldi(1, 10),
+        // loop:
+        dec(1),
+        bps(-3),
+        brk()
+    });
+
+    const AotTranslator translator { image };
+    const auto& leaders { translator.leaders() };
+    const auto start { origin };
+
+    BOOST_TEST(translator.code().size() == 4u);
+    BOOST_TEST(leaders.count(start) == 1u);
+    BOOST_TEST(leaders.count(start + 3) == 1u);
+
+    // After the branch, where the interpreter would start a block
+    BOOST_TEST(leaders.count(start + 9) == 1u);
+    BOOST_TEST(leaders.count(start + 6) == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(compiled_calls_match_stepping)
+{
+    program({
+        ldi(1, 50),
+        ldi(2, 0),
+        // loop:
+        cal(17),
+        dec(1),
+        bps(-6),
+        brk(),
+        // 17: add rA into rB, and double it
+        add(1, 2),
+        mui(2, 2),
+        ret()
+    });
+
+    compile();
+    run();
+    check_same_state();
+    BOOST_TEST(compiled->get_register(stack_register).value() == stack);
+}
+
+BOOST_AUTO_TEST_CASE(store_into_compiled_code_falls_back)
+{
+    // Rewrite the LDI rC, 1 in the loop as LDI rC, 7, part of the way
+    // through; the compiled code must stop using its old translation
+    stepped->set_reg(6, ldi(3, 7));
+    compiled->set_reg(6, ldi(3, 7));
+    stepped->set_reg(4, origin + 6);
+    compiled->set_reg(4, origin + 6);
+
+    program({
+        ldi(1, 20),
+        ldi(5, 10),
+        // loop:
+        ldi(3, 1),
+        add(3, 2),
+        dec(5),
+        bps(6),
+        stw(6, 4),
+        // no_store:
+        dec(1),
+        bps(-18),
+        brk()
+    });
+
+    compile();
+    run();
+    check_same_state();
+    BOOST_TEST(compiled->get_register(2).value() == 10 * 1 + 10 * 7);
+}
+
+BOOST_AUTO_TEST_CASE(compiled_timer_start_matches_stepping)
+{
+    // The compiled program has to stop after starting the timer, or it
+    // would run past the point where the timer fires
+    program({
+        inc(2, 1),
+        inc(2, 1),
+        inc(2, 1),
+        ldi(1, 8),
+        out(1, IntervalTimer::base_port + 1),
+        ldi(1, -1),
+        out(1, IntervalTimer::base_port),
+        // spin:
+        inc(2, 1),
+        brs(-3)
+    });
+
+    compile();
+    stepped->set_execution_mode(execution_mode::step);
+
+    for (const auto steps : { 10, 4, 1 })
+    {
+        stepped->run_for(steps);
+        compiled->run_for(steps);
+
+        const auto line { stepped->get_timer().line().number() };
+        BOOST_TEST(compiled->get_timer().count() == stepped->get_timer().count());
+        BOOST_TEST(compiled->interrupt_line(line) == stepped->interrupt_line(line));
+        BOOST_TEST(compiled->get_register(2).value() == stepped->get_register(2).value());
+    }
+
+    BOOST_TEST(compiled->interrupt_line(compiled->get_timer().line().number()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
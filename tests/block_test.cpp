@@ -0,0 +1,184 @@
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+
+#include "cpu.hpp"
+#include "block_cache.hpp"
+
+#include "test_program.hpp"
+
+using ternary::Cpu;
+
+using namespace test_program;
+
+struct BlockFixture
+{
+    BlockFixture()
+    {
+        for (auto c : { stepped.get(), blocked.get() })
+        {
+            c->reset();
+            c->set_instruction_pointer(origin);
+            c->set_memory_word(vector_table + 3 * invalid_opcode, handler);
+            c->set_memory_word(handler, brk());
+        }
+    }
+
+    ~BlockFixture() = default;
+
+    // Put the same program in both CPUs
+    void program(std::initializer_list<int> words)
+    {
+        load({ stepped.get(), blocked.get() }, origin, words);
+    }
+
+    // Run both CPUs to a breakpoint, returning the instruction count
+    std::size_t run()
+    {
+        std::size_t steps { 1 };
+        std::size_t retired { 0 };
+
+        while (!stepped->step())
+        {
+            ++steps;
+        }
+
+        while (true)
+        {
+            const auto result { blocked->step_block() };
+            retired += result.retired;
+
+            if (result.breakpoint)
+            {
+                break;
+            }
+        }
+
+        BOOST_TEST(retired == steps);
+        return retired;
+    }
+
+    void check_same_state()
+    {
+        for (auto r = -13; r <= 13; ++r)
+        {
+            BOOST_TEST(stepped->get_register(r).value() == blocked->get_register(r).value());
+        }
+
+        BOOST_TEST(stepped->get_instruction_pointer().value() == blocked->get_instruction_pointer().value());
+    }
+
+    std::unique_ptr<Cpu> stepped { new Cpu() };
+    std::unique_ptr<Cpu> blocked { new Cpu() };
+
+    static constexpr int invalid_opcode { 4 };
+    static constexpr int handler { 4998 };
+};
+
+constexpr int BlockFixture::handler;
+
+BOOST_FIXTURE_TEST_SUITE(blocks, BlockFixture)
+
+BOOST_AUTO_TEST_CASE(countdown_loop_matches_stepping)
+{
+    program({
+        ldi(1, 100),
+        ldi(2, 0),
+        // loop:
+        add(1, 2),
+        dec(1),
+        bps(-6),
+        brk()
+    });
+
+    BOOST_TEST(run() == 2 + 3 * 100 + 1);
+    check_same_state();
+    BOOST_TEST(blocked->get_register(2).value() == 5050);
+}
+
+BOOST_AUTO_TEST_CASE(compare_and_branch_fuses)
+{
+    program({
+        ldi(1, 0),
+        // loop:
+        encode(4, 11, 1, 0, 0, 1),  // INC rA
+        mov(2, 1),
+        shr(2, 1),
+        cmi(1, 30),
+        bzs(6),
+        encode(10, 1, 0, 0, 0, -15),  // BRR loop
+        brk()
+    });
+
+    run();
+    check_same_state();
+    BOOST_TEST(blocked->get_register(1).value() == 30);
+    BOOST_TEST(blocked->get_register(2).value() == 10);
+}
+
+BOOST_AUTO_TEST_CASE(write_into_block_invalidates_it)
+{
+    // STR rB, origin + 6 replaces the LDI rC, 1 later in the same block
+    blocked->set_reg(2, ldi(3, 7));
+    program({
+        encode(-9, 2, 0, 0, 0, 5),
+        encode(0, -11, 0, 0, 0, 0),
+        ldi(3, 1),
+        brk()
+    });
+
+    // The block stops after the write...
+    const auto result { blocked->step_block() };
+    BOOST_TEST(result.retired == 1u);
+    BOOST_TEST(blocked->get_instruction_pointer().value() == origin + 3);
+
+    // ...and the rest is translated again
+    blocked->step_block();
+    BOOST_TEST(blocked->get_register(3).value() == 7);
+}
+
+BOOST_AUTO_TEST_CASE(interrupt_leaves_block)
+{
+    program({
+        ldi(1, 1),
+        encode(0, 0, 0, 0, 0, 0),   // undefined
+        ldi(1, 2),
+        brk()
+    });
+
+    const auto result { blocked->step_block() };
+
+    BOOST_TEST(result.retired == 2u);
+    BOOST_TEST(blocked->get_instruction_pointer().value() == handler);
+    BOOST_TEST(blocked->get_register(1).value() == 1);
+
+    stepped->step();
+    stepped->step();
+    check_same_state();
+}
+
+BOOST_AUTO_TEST_CASE(cache_discards_covering_blocks)
+{
+    ternary::BlockCache<12> cache {};
+
+    auto block { cache.lookup(origin) };
+    BOOST_REQUIRE(block != nullptr);
+    BOOST_TEST(cache.lookup(origin + 1) == nullptr);
+
+    block->ops.resize(3);
+    block->length = 3;
+    cache.commit(origin);
+
+    // Outside the block
+    const auto before { cache.generation() };
+    cache.invalidate(origin + 9);
+    BOOST_TEST(cache.generation() == before);
+    BOOST_TEST(block->translated());
+
+    // The middle hexad of the last word
+    cache.invalidate(origin + 7);
+    BOOST_TEST(cache.generation() != before);
+    BOOST_TEST(!block->translated());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
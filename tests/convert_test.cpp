@@ -44,4 +44,38 @@ BOOST_AUTO_TEST_CASE(convert_to_triad_string)
     BOOST_TEST(triad_to_string(negativeValue) == "z");
 }
 
+BOOST_AUTO_TEST_CASE(convert_hexad_tables)
+{
+    BOOST_TEST(hexad_to_trit_string(224) == "+0-+0-");
+    BOOST_TEST(hexad_to_trit_string(-364) == "------");
+    BOOST_TEST(hexad_to_string(positiveValue) == "By");
+    BOOST_TEST(hexad_to_string(zeroValue) == "00");
+    BOOST_TEST(hexad_to_string(364) == "MM");
+}
+
+BOOST_AUTO_TEST_CASE(convert_tables_match_reference)
+{
+    // Check the table-driven conversions against the direct ones,
+    // over a range of values wider than a word
+    for (auto v = -200000000; v <= 200000000; v += 4999)
+    {
+        const auto tr { to_trits<int, 18>(v) };
+        const auto ref { detail::to_trits_impl(v, std::make_index_sequence<18>{}) };
+
+        BOOST_TEST(tr == ref);
+        BOOST_TEST(to_decimal(tr) == detail::to_decimal_impl(ref, 17));
+    }
+
+    for (auto v = -364; v <= 364; ++v)
+    {
+        BOOST_TEST(to_decimal(hexad_to_trits(v)) == v);
+        BOOST_TEST(hexad_to_string(v) == triad_to_string(shift_right(v, 3)) + triad_to_string(low_trits(v, 3)));
+
+        const auto& triads { hexad_to_triads(v) };
+        BOOST_TEST(triads[0] == shift_right(v, 3));
+        BOOST_TEST(triads[1] == low_trits(v, 3));
+        BOOST_TEST(triads_to_hexad(triads[0], triads[1]) == v);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include <boost/test/unit_test.hpp>
+
+#include "cpu.hpp"
+#include "opcode.hpp"
+#include "word.hpp"
+
+using ternary::Cpu;
+using ternary::Opcode;
+
+struct CpuFixture
+{
+    CpuFixture()
+    {
+        cpu.reset();
+        cpu.set_instruction_pointer(origin);
+    }
+
+    ~CpuFixture() = default;
+
+    // Encode an instruction from its fields
+    static int encode(int o, int m, int t, int x, int y, int z)
+    {
+        return Opcode { o, m, t, x, y, z }.value.value();
+    }
+
+    // LDI rX, imm
+    static int ldi(int reg, int imm) { return encode(8, 0, 0, reg, 0, imm); }
+
+    // STR rX, address
+    static int str(int reg, int address)
+    {
+        return encode(-9, reg, shift_right(address, 9), low_trits(shift_right(address, 6), 3),
+            low_trits(shift_right(address, 3), 3), low_trits(address, 3));
+    }
+
+    Cpu cpu {};
+
+    // A word-aligned address well away from the boot vectors
+    static constexpr int origin { -1 };
+
+    // The interrupt vector table that reset() points CR2 to (%00ww0n)
+    static constexpr int vector_table { -204121 };
+    static constexpr int handler { 4998 };
+};
+
+constexpr int CpuFixture::handler;
+
+BOOST_FIXTURE_TEST_SUITE(cpu, CpuFixture)
+
+BOOST_AUTO_TEST_CASE(repeated_execution)
+{
+    cpu.set_memory_word(origin, ldi(1, 5));
+
+    for (auto i = 0; i < 3; ++i)
+    {
+        cpu.set_instruction_pointer(origin);
+        cpu.step();
+
+        BOOST_TEST(cpu.get_register(1).value() == 5);
+        BOOST_TEST(cpu.get_instruction_pointer().value() == origin + 3);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(host_write_invalidates_decoded_instruction)
+{
+    cpu.set_memory_word(origin, ldi(1, 5));
+    cpu.step();
+    BOOST_TEST(cpu.get_register(1).value() == 5);
+
+    cpu.set_memory_word(origin, ldi(1, 7));
+    cpu.set_instruction_pointer(origin);
+    cpu.step();
+    BOOST_TEST(cpu.get_register(1).value() == 7);
+}
+
+BOOST_AUTO_TEST_CASE(self_modifying_code)
+{
+    cpu.set_memory_word(origin, ldi(1, 1));
+    cpu.set_memory_word(origin + 3, str(2, origin));
+    cpu.set_reg(2, ldi(1, 2));
+
+    cpu.step();
+    cpu.step();
+    BOOST_TEST(cpu.get_register(1).value() == 1);
+    BOOST_TEST(cpu.get_memory_word(origin).value() == ldi(1, 2));
+
+    cpu.set_instruction_pointer(origin);
+    cpu.step();
+    BOOST_TEST(cpu.get_register(1).value() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(partial_overwrite_invalidates_decoded_instruction)
+{
+    cpu.set_memory_word(origin, ldi(1, 5));
+    cpu.step();
+
+    // Rewrite only the low hexad (the immediate)
+    cpu.set_memory(origin, 9);
+    cpu.set_instruction_pointer(origin);
+    cpu.step();
+    BOOST_TEST(cpu.get_register(1).value() == 9);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_opcode_vectors_to_handler)
+{
+    cpu.set_memory_word(vector_table + 3 * 4, handler);
+    cpu.set_memory_word(origin, encode(0, 0, 0, 0, 0, 0));
+
+    BOOST_TEST(!cpu.step());
+    BOOST_TEST(cpu.get_instruction_pointer().value() == handler);
+}
+
+BOOST_AUTO_TEST_CASE(divide_by_zero_leaves_destination)
+{
+    cpu.set_memory_word(vector_table, handler);
+    cpu.set_reg(1, 42);
+
+    // DVI rA, rA, 0
+    cpu.set_memory_word(origin, encode(2, -9, 1, 1, 0, 0));
+
+    BOOST_TEST(!cpu.step());
+    BOOST_TEST(cpu.get_register(1).value() == 42);
+    BOOST_TEST(cpu.get_instruction_pointer().value() == handler);
+}
+
+BOOST_AUTO_TEST_CASE(breakpoint_reports_to_host)
+{
+    cpu.set_memory_word(vector_table + 3 * 1, handler);
+    cpu.set_memory_word(origin, encode(0, -12, 0, 0, 0, 0));
+
+    BOOST_TEST(cpu.step());
+    BOOST_TEST(cpu.get_instruction_pointer().value() == handler);
+
+    // The next instruction isn't affected by the last interrupt
+    cpu.set_memory_word(handler, ldi(1, 3));
+    BOOST_TEST(!cpu.step());
+    BOOST_TEST(cpu.get_register(1).value() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(multiply_divide_through_overflow_register)
+{
+    cpu.set_reg(1, 123456789);
+    cpu.set_reg(12, 5);
+
+    // MLI rA, rA, 100
+    cpu.set_memory_word(origin, encode(2, -6, 1, 1, 4, -8));
+    // DVI rA, rA, 100
+    cpu.set_memory_word(origin + 3, encode(2, -9, 1, 1, 4, -8));
+
+    cpu.step();
+    BOOST_TEST(cpu.get_register(-2).value() == shift_right(12345678900LL, 18));
+    BOOST_TEST(cpu.get_register(1).value() == low_trits(12345678900LL, 18));
+
+    cpu.step();
+    BOOST_TEST(cpu.get_register(1).value() == 123456789);
+    BOOST_TEST(cpu.get_register(-8).value() == 0);
+
+    // The overflow register is separate from the general registers
+    BOOST_TEST(cpu.get_register(12).value() == 5);
+}
+
+BOOST_AUTO_TEST_CASE(call_returns_to_following_instruction)
+{
+    constexpr int subroutine { 29 };
+    cpu.set_reg(-6, 2999);
+
+    // CAL subroutine
+    cpu.set_memory_word(origin, encode(10, 0, 0, 0, 1, 2));
+    // LDI rA, 5
+    cpu.set_memory_word(origin + 3, ldi(1, 5));
+    // subroutine: RET
+    cpu.set_memory_word(subroutine, encode(10, -13, 0, 0, 0, 0));
+
+    cpu.step();
+    BOOST_TEST(cpu.get_instruction_pointer().value() == subroutine);
+    BOOST_TEST(cpu.get_register(-6).value() == 2996);
+
+    cpu.step();
+    BOOST_TEST(cpu.get_instruction_pointer().value() == origin + 3);
+    BOOST_TEST(cpu.get_register(-6).value() == 2999);
+
+    cpu.step();
+    BOOST_TEST(cpu.get_register(1).value() == 5);
+}
+
+BOOST_AUTO_TEST_CASE(words_wrap_around_memory)
+{
+    constexpr int top { 265720 };
+    const ternary::Word value { 100, -200, 300 };
+
+    // The middle and high hexads go at the bottom of memory
+    cpu.set_memory_word(top, value.value());
+
+    BOOST_TEST(cpu.get_memory(top).get() == 300);
+    BOOST_TEST(cpu.get_memory(-top).get() == -200);
+    BOOST_TEST(cpu.get_memory(-top + 1).get() == 100);
+    BOOST_TEST(cpu.get_memory_word(top).value() == value.value());
+
+    // Addresses outside memory wrap too
+    BOOST_TEST(cpu.get_memory_word(top + 531441).value() == value.value());
+    BOOST_TEST(cpu.get_memory_word(-top - 2).value() == cpu.get_memory_word(top - 1).value());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,195 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "debug_io.hpp"
+
+using ternary::DebugIo;
+using ternary::flush_policy;
+
+struct DebugIoFixture
+{
+    DebugIoFixture()
+    {
+        debug.set_sink(std::unique_ptr<ternary::DebugSink> { new ternary::CaptureSink(output) });
+    }
+
+    void input(const std::string& text)
+    {
+        debug.set_source(std::unique_ptr<ternary::DebugSource> { new ternary::StringSource(text) });
+    }
+
+    void write_string(const std::string& s)
+    {
+        for (auto c : s)
+        {
+            debug.write(c);
+        }
+
+        debug.write(0);
+    }
+
+    // Mode is the high trit of the control port, and a request for
+    // input the low trit
+    static constexpr int characters { 0 };
+    static constexpr int integers { 3 };
+    static constexpr int words { -3 };
+    static constexpr int request { 1 };
+
+    std::string output;
+    DebugIo debug;
+};
+
+constexpr int DebugIoFixture::characters;
+constexpr int DebugIoFixture::integers;
+constexpr int DebugIoFixture::words;
+constexpr int DebugIoFixture::request;
+
+BOOST_FIXTURE_TEST_SUITE(debug_io, DebugIoFixture)
+
+BOOST_AUTO_TEST_CASE(input_is_read_a_line_at_a_time)
+{
+    input("hi\nyo");
+
+    debug.write_control(request);
+    BOOST_TEST(debug.read_control() == request);
+    BOOST_TEST(debug.read() == 'h');
+    BOOST_TEST(debug.read_control() == 0);
+    BOOST_TEST(debug.read() == 'i');
+    BOOST_TEST(debug.read() == 0);
+    BOOST_TEST(debug.read() == 0);
+
+    debug.write_control(request);
+    BOOST_TEST(debug.read() == 'y');
+    BOOST_TEST(debug.read() == 'o');
+    BOOST_TEST(debug.read() == 0);
+
+    // Past the end of the input, there's nothing to read
+    debug.write_control(request);
+    BOOST_TEST(debug.read() == 0);
+
+    // Each request shows a prompt
+    BOOST_TEST(output == "> > > ");
+}
+
+BOOST_AUTO_TEST_CASE(output_modes)
+{
+    write_string("abc");
+
+    debug.write_control(integers);
+    debug.write(-42);
+
+    debug.write_control(words);
+    debug.write(4);
+
+    debug.write_control(characters);
+    write_string("");
+    debug.flush();
+
+    BOOST_TEST(output == "abc\n-42\n" + ternary::Word { 4 }.value_string() + "\n\n");
+}
+
+BOOST_AUTO_TEST_CASE(output_is_buffered_until_flushed)
+{
+    write_string("one");
+    write_string("two");
+    BOOST_TEST(output.empty());
+
+    debug.flush();
+    BOOST_TEST(output == "one\ntwo\n");
+
+    // Waiting for input flushes first
+    input("");
+    write_string("three");
+    debug.write_control(request);
+    debug.read();
+    BOOST_TEST(output == "one\ntwo\nthree\n> ");
+}
+
+BOOST_AUTO_TEST_CASE(flush_policies)
+{
+    debug.set_flush_policy(flush_policy::every_line);
+    write_string("line");
+    BOOST_TEST(output == "line\n");
+
+    // A partial line waits for the rest
+    debug.write('x');
+    BOOST_TEST(output == "line\n");
+
+    debug.set_flush_policy(flush_policy::when_full);
+    debug.set_block_size(8);
+    write_string("y");
+    BOOST_TEST(output == "line\n");
+    write_string("1234");
+    BOOST_TEST(output == "line\nxy\n1234\n");
+
+    // Even a line longer than a block waits to be ended
+    output.clear();
+    for (auto i = 0; i < 8; ++i)
+    {
+        debug.write('a');
+    }
+    debug.flush();
+    BOOST_TEST(output.empty());
+    debug.write(0);
+    BOOST_TEST(output == "aaaaaaaa\n");
+}
+
+BOOST_AUTO_TEST_CASE(numbers_replace_an_unended_line)
+{
+    write_string("kept");
+    debug.write('a');
+    debug.write('b');
+
+    debug.write_control(integers);
+    debug.write(5);
+    debug.flush();
+
+    BOOST_TEST(output == "kept\n5\n");
+}
+
+BOOST_AUTO_TEST_CASE(changing_sink_flushes)
+{
+    std::string second;
+
+    write_string("first");
+    debug.set_sink(std::unique_ptr<ternary::DebugSink> { new ternary::CaptureSink(second) });
+    write_string("second");
+    debug.flush();
+
+    BOOST_TEST(output == "first\n");
+    BOOST_TEST(second == "second\n");
+}
+
+BOOST_AUTO_TEST_CASE(stdio_streams)
+{
+    const auto file { std::tmpfile() };
+    BOOST_REQUIRE(file != nullptr);
+
+    debug.set_sink(std::unique_ptr<ternary::DebugSink> { new ternary::StdioSink(file) });
+    write_string("piped");
+    debug.write_control(integers);
+    debug.write(7);
+    debug.flush();
+
+    std::rewind(file);
+    debug.set_sink(std::unique_ptr<ternary::DebugSink> { new ternary::CaptureSink(output) });
+    debug.set_source(std::unique_ptr<ternary::DebugSource> { new ternary::StdioSource(file) });
+    debug.write_control(request);
+    BOOST_TEST(debug.read() == 'p');
+    BOOST_TEST(debug.read() == 'i');
+
+    debug.write_control(request);
+    BOOST_TEST(debug.read() == '7');
+    BOOST_TEST(debug.read() == 0);
+
+    debug.write_control(request);
+    BOOST_TEST(debug.read() == 0);
+    BOOST_TEST(output == "> > > ");
+
+    std::fclose(file);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,236 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cpu.hpp"
+#include "device.hpp"
+
+#include "test_program.hpp"
+
+using ternary::Cpu;
+using ternary::Device;
+using ternary::InterruptLine;
+using ternary::PortRange;
+using ternary::stop_reason;
+
+using namespace test_program;
+
+namespace
+{
+    // Two ports that keep what's written to them, and count ticks
+    class Latch final : public Device
+    {
+        public:
+        explicit Latch(int first): first_(first) {}
+
+        std::string name() const override { return "latch"; }
+        PortRange ports() const override { return { first_, 2 }; }
+
+        int read(int port) override { return values[port - first_]; }
+        void write(int port, int value) override { values[port - first_] = value; }
+
+        void reset() override { ++resets; }
+
+        bool ticks() const override { return true; }
+        void tick(std::size_t retired) override { ticked += retired; }
+
+        std::vector<int> save() const override { return { values[0], values[1] }; }
+        void restore(const std::vector<int>& state) override
+        {
+            values[0] = state.at(0);
+            values[1] = state.at(1);
+        }
+
+        int interrupt_lines() const override { return 2; }
+        void connect(int index, InterruptLine line) override { lines[index] = line; }
+
+        int values[2] {};
+        int resets { 0 };
+        std::size_t ticked { 0 };
+        InterruptLine lines[2] {};
+
+        private:
+        int first_;
+    };
+}
+
+struct DeviceFixture
+{
+    DeviceFixture()
+    {
+        cpu->reset();
+        cpu->set_instruction_pointer(origin);
+    }
+
+    void program(std::initializer_list<int> words)
+    {
+        load({ cpu.get() }, origin, words);
+    }
+
+    std::unique_ptr<Cpu> cpu { new Cpu() };
+
+    static constexpr int port { 300 };
+};
+
+constexpr int DeviceFixture::port;
+
+BOOST_FIXTURE_TEST_SUITE(device, DeviceFixture)
+
+BOOST_AUTO_TEST_CASE(guest_uses_attached_devices)
+{
+    auto& latch { cpu->attach<Latch>(port) };
+
+    program({
+        ldi(1, 42),
+        out(1, port + 1),
+        in(port, 2),
+        brk()
+    });
+
+    latch.values[0] = -17;
+
+    for (const auto mode : { ternary::execution_mode::step, ternary::execution_mode::block })
+    {
+        cpu->set_instruction_pointer(origin);
+        cpu->set_execution_mode(mode);
+        latch.ticked = 0;
+
+        const auto result { cpu->run_for(100) };
+
+        BOOST_TEST((result.reason == stop_reason::halt));
+        BOOST_TEST(latch.values[1] == 42);
+        BOOST_TEST(cpu->get_register(2).value() == -17);
+        BOOST_TEST(latch.ticked == result.retired);
+    }
+
+    const auto& devices { cpu->get_devices() };
+    BOOST_TEST(devices.size() == 4u);
+    BOOST_TEST(devices[0]->name() == "debug");
+    BOOST_TEST(devices[1]->name() == "interrupts");
+    BOOST_TEST(devices[2]->name() == "timer");
+    BOOST_TEST(devices[3] == &latch);
+}
+
+BOOST_AUTO_TEST_CASE(ports_cant_be_shared)
+{
+    cpu->attach<Latch>(port);
+
+    BOOST_CHECK_THROW(cpu->attach<Latch>(port + 1), std::invalid_argument);
+    BOOST_CHECK_THROW(cpu->attach(std::unique_ptr<Device> { new Latch(ternary::DebugIo::base_port) }),
+        std::invalid_argument);
+
+    // Nothing was attached by the ones that failed
+    BOOST_TEST(cpu->get_devices().size() == 4u);
+    BOOST_CHECK_NO_THROW(cpu->attach(std::unique_ptr<Device> { new Latch(port + 2) }));
+}
+
+BOOST_AUTO_TEST_CASE(debug_output_is_flushed_after_each_step)
+{
+    std::string output;
+    auto& debug { cpu->get_debug_io() };
+    debug.set_sink(std::unique_ptr<ternary::DebugSink> { new ternary::CaptureSink(output) });
+
+    const auto debug_out { ternary::DebugIo::base_port - 2 };
+    program({ ldi(1, 'h'), out(1, debug_out), ldi(1, 0), out(1, debug_out), brk() });
+
+    for (auto i = 0; i < 3; ++i)
+    {
+        cpu->step();
+        BOOST_TEST(output.empty());
+    }
+
+    cpu->step();
+    BOOST_TEST(output == "h\n");
+}
+
+BOOST_AUTO_TEST_CASE(reset_save_and_restore)
+{
+    auto& latch { static_cast<Latch&>(cpu->attach(std::unique_ptr<Device> { new Latch(port) })) };
+
+    cpu->reset();
+    BOOST_TEST(latch.resets == 1);
+
+    latch.values[0] = 5;
+    latch.values[1] = -6;
+    const auto saved { cpu->save_devices() };
+    BOOST_TEST(saved.size() == 4u);
+
+    latch.values[0] = latch.values[1] = 0;
+    cpu->restore_devices(saved);
+    BOOST_TEST(latch.values[0] == 5);
+    BOOST_TEST(latch.values[1] == -6);
+}
+
+BOOST_AUTO_TEST_CASE(interrupt_lines_are_numbered_in_order)
+{
+    auto& first { cpu->attach<Latch>(port) };
+    auto& second { cpu->attach<Latch>(port + 2) };
+
+    // The timer has line 0
+    BOOST_TEST(cpu->get_timer().line().number() == 0);
+    BOOST_TEST(first.lines[0].number() == 1);
+    BOOST_TEST(first.lines[1].number() == 2);
+    BOOST_TEST(second.lines[0].number() == 3);
+
+    second.lines[1].raise();
+    BOOST_TEST(cpu->interrupt_line(4));
+    BOOST_TEST(!cpu->interrupt_line(1));
+
+    second.lines[1].lower();
+    BOOST_TEST(!cpu->interrupt_line(4));
+
+    // A line nobody connected does nothing
+    InterruptLine {}.raise();
+    BOOST_TEST(!cpu->interrupt_line(-1));
+}
+
+BOOST_AUTO_TEST_CASE(plugins_are_loaded)
+{
+    if (!ternary::DevicePlugin::supported())
+    {
+        return;
+    }
+
+    // Build a plugin against the headers next to these tests
+    std::string include { __FILE__ };
+    include = include.substr(0, include.rfind("tests")) + "include";
+
+    const auto tmp { std::getenv("TMPDIR") };
+    const std::string stem { std::string { (tmp != nullptr && *tmp != '\0') ? tmp : "/tmp" } + "/trireme-device-test" };
+
+    {
+        std::ofstream source { stem + ".cpp" };
+        source << "#include \"device.hpp\"\n"
+            "struct Constant final : ternary::Device {\n"
+            "    explicit Constant(const std::string& args): value(std::stoi(args)) {}\n"
+            "    std::string name() const override { return \"constant\"; }\n"
+            "    ternary::PortRange ports() const override { return { 500, 1 }; }\n"
+            "    int read(int) override { return value; }\n"
+            "    int value;\n"
+            "};\n"
+            "TRIREME_DEVICE_PLUGIN(Constant)\n";
+    }
+
+    const auto command { "c++ -std=c++14 -shared -fPIC -I'" + include + "' -o '" + stem + ".so' '" + stem + ".cpp'" };
+    BOOST_REQUIRE(std::system(command.c_str()) == 0);
+
+    auto& device { cpu->load_device(stem + ".so", "123") };
+    BOOST_TEST(device.name() == "constant");
+
+    program({
+        in(500, 1),
+        brk()
+    });
+
+    cpu->run_for(10);
+    BOOST_TEST(cpu->get_register(1).value() == 123);
+
+    BOOST_CHECK_THROW(cpu->load_device(stem + ".missing"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,92 @@
+#include <boost/test/unit_test.hpp>
+
+#include "word.hpp"
+#include "double_word.hpp"
+#include "ternary_math.hpp"
+
+using ternary::Word;
+using ternary::DoubleWord;
+
+struct DoubleWordFixture
+{
+    DoubleWordFixture() = default;
+    ~DoubleWordFixture() = default;
+
+    Word maxWord { ternary::MAX_WORD };
+    Word minWord { ternary::MIN_WORD };
+    Word smallPositive { 42 };
+    Word largeNegative { -123456789 };
+};
+
+BOOST_FIXTURE_TEST_SUITE(double_word, DoubleWordFixture)
+
+BOOST_AUTO_TEST_CASE(split_and_join)
+{
+    const DoubleWord d { largeNegative, smallPositive };
+    BOOST_TEST(d.high().value() == largeNegative.value());
+    BOOST_TEST(d.low().value() == smallPositive.value());
+    BOOST_TEST(d.value() == -123456789LL * pow3<long long>(18) + 42);
+
+    const DoubleWord top { maxWord, maxWord };
+    BOOST_TEST(top.value() == DoubleWord::max_value);
+    BOOST_TEST(top.high().value() == maxWord.value());
+    BOOST_TEST(top.low().value() == maxWord.value());
+
+    const DoubleWord bottom { DoubleWord::min_value };
+    BOOST_TEST(bottom.high().value() == minWord.value());
+    BOOST_TEST(bottom.low().value() == minWord.value());
+}
+
+BOOST_AUTO_TEST_CASE(overflow)
+{
+    const Word zero { 0 };
+    const Word one { 1 };
+    const Word minus_one { -1 };
+
+    BOOST_TEST(DoubleWord(zero, maxWord).overflow() == 0);
+    BOOST_TEST(DoubleWord(zero, minWord).overflow() == 0);
+    BOOST_TEST(DoubleWord(one, minWord).overflow() == 1);
+    BOOST_TEST(DoubleWord(minus_one, maxWord).overflow() == -1);
+}
+
+BOOST_AUTO_TEST_CASE(multiply)
+{
+    const auto p1 { mul(smallPositive, largeNegative) };
+    BOOST_TEST(p1.value() == 42LL * -123456789);
+    BOOST_TEST(p1.overflow() == -1);
+
+    // The largest possible product still fits
+    const auto p2 { mul(maxWord, maxWord) };
+    BOOST_TEST(p2.value() == static_cast<long long>(maxWord.value()) * maxWord.value());
+    BOOST_TEST(DoubleWord(p2.high(), p2.low()).value() == p2.value());
+
+    const auto p3 { mul(smallPositive, -3) };
+    BOOST_TEST(p3.high().value() == 0);
+    BOOST_TEST(p3.low().value() == -126);
+    BOOST_TEST(p3.overflow() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(divide)
+{
+    // Round toward zero, remainder follows the dividend
+    const auto q1 { div(DoubleWord { -100 }, Word { 7 }) };
+    BOOST_TEST(q1.first.value() == -14);
+    BOOST_TEST(q1.second.value() == -2);
+    BOOST_TEST(q1.first.overflow() == 0);
+
+    // A product divides back exactly
+    const auto q2 { div(mul(largeNegative, maxWord), maxWord) };
+    BOOST_TEST(q2.first.value() == largeNegative.value());
+    BOOST_TEST(q2.second.value() == 0);
+
+    // The quotient doesn't always fit in a word
+    const auto q3 { div(DoubleWord { Word { 1 }, Word { 0 } }, 2) };
+    BOOST_TEST(q3.first.value() == pow3<long long>(18) / 2);
+    BOOST_TEST(q3.first.overflow() == 0);
+
+    const auto q4 { div(DoubleWord { Word { -5 }, Word { 0 } }, Word { 2 }) };
+    BOOST_TEST(q4.first.overflow() == -1);
+    BOOST_TEST(q4.first.low().value() == low_trits(q4.first.value(), 18));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
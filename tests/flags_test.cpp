@@ -0,0 +1,66 @@
+#include <boost/test/unit_test.hpp>
+
+#include "flags.hpp"
+#include "registers.hpp"
+
+using ternary::FlagRegister;
+using ternary::Registers;
+using ternary::flags;
+
+struct FlagsFixture
+{
+    FlagsFixture() = default;
+    ~FlagsFixture() = default;
+
+    FlagRegister f {};
+    Registers r {};
+};
+
+BOOST_FIXTURE_TEST_SUITE(flag_register, FlagsFixture)
+
+BOOST_AUTO_TEST_CASE(sign_comes_from_result)
+{
+    f.set_result(-12345);
+    BOOST_TEST(f.get_flag(flags::sign) == -1);
+
+    f.set_result(0);
+    BOOST_TEST(f.get_flag(flags::sign) == 0);
+
+    f.set_result(193710244);
+    BOOST_TEST(f.get_flag(flags::sign) == 1);
+    BOOST_TEST(f.get().value() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(whole_register_is_composed)
+{
+    f.set_flag(flags::interrupt, 1);
+    f.set_flag(flags::direction, -1);
+    f.set_carry(-1);
+    f.set_result(-7);
+
+    // I = +, D = -, S = -, C = -
+    BOOST_TEST(f.get().value() == 6561 - 9 - 3 - 1);
+
+    // Changing one flag leaves the others alone
+    f.set_flag(flags::direction, 0);
+    f.set_flag(flags::sign, 1);
+    BOOST_TEST(f.get().value() == 6561 + 3 - 1);
+    BOOST_TEST(f.get_flag(flags::interrupt) == 1);
+    BOOST_TEST(f.get_flag(flags::carry) == -1);
+}
+
+BOOST_AUTO_TEST_CASE(zero_register_stays_zero)
+{
+    r.set(-13, 100);
+    r.set(13, 200);
+    r.set(-12, { 300 });
+
+    BOOST_TEST(r.get(-13).value() == 0);
+    BOOST_TEST(r.value(13) == 200);
+    BOOST_TEST(r.get(-12).value() == 300);
+
+    r.clear_all();
+    BOOST_TEST(r.value(13) == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,233 @@
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <string>
+
+#include "cpu.hpp"
+#include "device.hpp"
+#include "interrupt_controller.hpp"
+
+#include "test_program.hpp"
+
+using ternary::Cpu;
+using ternary::Device;
+using ternary::InterruptController;
+using ternary::InterruptLine;
+using ternary::PortRange;
+using ternary::execution_mode;
+using ternary::stop_reason;
+
+using namespace test_program;
+
+namespace
+{
+    // One port: writing +1 raises its line, and anything else lowers it
+    class Doorbell final : public Device
+    {
+        public:
+        std::string name() const override { return "doorbell"; }
+        PortRange ports() const override { return { port, 1 }; }
+
+        void write(int, int value) override { (value == 1) ? line.raise() : line.lower(); }
+
+        int interrupt_lines() const override { return 1; }
+        void connect(int, InterruptLine l) override { line = l; }
+
+        static constexpr int port { 300 };
+        InterruptLine line {};
+    };
+}
+
+struct InterruptFixture
+{
+    InterruptFixture()
+    {
+        cpu->reset();
+        cpu->set_instruction_pointer(origin);
+    }
+
+    void program(int address, std::initializer_list<int> words)
+    {
+        load({ cpu.get() }, address, words);
+    }
+
+    // Point the vector for a device line at a handler that saves CR3 in
+    // rC and the flags in rD, then stops
+    void install_handler(int line)
+    {
+        cpu->set_memory_word(vector_table + 3 * (InterruptController::first_vector + line), handler);
+        program(handler, { lsr(3, 3), lsr(4, 1), brk() });
+    }
+
+    // Enable interrupts, ring the bell, and spin
+    void ring_and_spin()
+    {
+        program(origin, {
+            pfi(),
+            ldi(1, 1),
+            out(1, Doorbell::port),
+            // spin:
+            inc(2, 1),
+            brs(-3)
+        });
+    }
+
+    std::unique_ptr<Cpu> cpu { new Cpu() };
+    InterruptController controller {};
+
+    static constexpr int handler { 4998 };
+};
+
+constexpr int InterruptFixture::handler;
+
+BOOST_FIXTURE_TEST_SUITE(interrupts, InterruptFixture)
+
+BOOST_AUTO_TEST_CASE(highest_priority_goes_first)
+{
+    BOOST_TEST(controller.allocate(3) == 0);
+    BOOST_TEST(controller.allocate(InterruptController::max_lines) == -1);
+
+    controller.set(2, true);
+    controller.set(1, true);
+    BOOST_TEST(controller.active());
+    BOOST_TEST(controller.next() == 1);
+
+    controller.set_priority(2, 5);
+    BOOST_TEST(controller.next() == 2);
+
+    controller.mask(2, true);
+    BOOST_TEST(controller.next() == 1);
+
+    BOOST_TEST(controller.acknowledge() == 1);
+    BOOST_TEST(!controller.active());
+
+    // Still pending behind the mask, and the line is still up
+    BOOST_TEST(controller.pending(2));
+    BOOST_TEST(controller.level(2));
+
+    controller.set(2, false);
+    controller.mask(2, false);
+    BOOST_TEST(controller.next() == -1);
+}
+
+BOOST_AUTO_TEST_CASE(guest_programs_the_controller)
+{
+    const auto base { InterruptController::base_port };
+
+    controller.allocate(4);
+    controller.set(0, true);
+    controller.set(3, true);
+
+    controller.write(base, 3);
+    controller.write(base + 1, 1);
+    BOOST_TEST(controller.masked(3));
+    BOOST_TEST(controller.read(base + 3) == 0);
+
+    controller.write(base + 1, 0);
+    controller.write(base + 2, 2);
+    BOOST_TEST(controller.read(base + 2) == 2);
+    BOOST_TEST(controller.read(base + 3) == 3);
+
+    // Clearing by hand, for polling
+    controller.write(base + 3, 3);
+    controller.write(base + 3, 0);
+    BOOST_TEST(controller.read(base + 3) == -1);
+
+    const auto saved { controller.save() };
+    controller.reset();
+    BOOST_TEST(controller.priority(3) == 0);
+
+    controller.restore(saved);
+    BOOST_TEST(controller.priority(3) == 2);
+    BOOST_TEST(controller.level(0));
+}
+
+BOOST_AUTO_TEST_CASE(devices_interrupt_the_guest)
+{
+    auto& bell { cpu->attach<Doorbell>() };
+    install_handler(bell.line.number());
+    ring_and_spin();
+
+    for (const auto mode : { execution_mode::step, execution_mode::block, execution_mode::jit })
+    {
+        cpu->reset();
+        cpu->set_instruction_pointer(origin);
+        cpu->set_execution_mode(mode);
+
+        const auto result { cpu->run_for(1000) };
+
+        BOOST_TEST((result.reason == stop_reason::halt));
+
+        // Interrupted somewhere in the spin loop, with interrupts off
+        const auto returned { cpu->get_register(3).value() };
+        BOOST_TEST((returned == origin + 9 || returned == origin + 12));
+        BOOST_TEST(nth_trit(cpu->get_register(4).value(), 8) == 0);
+        BOOST_TEST(!cpu->get_interrupt_controller().pending(bell.line.number()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(interrupts_wait_for_the_flag)
+{
+    auto& bell { cpu->attach<Doorbell>() };
+    install_handler(bell.line.number());
+    ring_and_spin();
+
+    // Without PFI, the bell rings but nothing happens
+    cpu->set_memory_word(origin, inc(2, 0));
+
+    auto result { cpu->run_for(100) };
+    BOOST_TEST((result.reason == stop_reason::budget));
+    BOOST_TEST(cpu->get_interrupt_controller().pending(bell.line.number()));
+
+    // Nor while the line is masked
+    cpu->get_interrupt_controller().mask(bell.line.number(), true);
+    cpu->set_flag(ternary::flags::interrupt, 1);
+    result = cpu->run_for(100);
+    BOOST_TEST((result.reason == stop_reason::budget));
+
+    cpu->get_interrupt_controller().mask(bell.line.number(), false);
+    result = cpu->run_for(100, true);
+    BOOST_TEST((result.reason == stop_reason::interrupt));
+    BOOST_TEST(cpu->get_instruction_pointer().value() == handler);
+}
+
+BOOST_AUTO_TEST_CASE(interrupts_come_as_soon_as_a_line_is_raised)
+{
+    auto& bell { cpu->attach<Doorbell>() };
+    install_handler(bell.line.number());
+    program(origin, { inc(2, 1), inc(2, 1), inc(2, 1), inc(2, 1) });
+
+    // Interrupts have been on for a while, with nothing pending
+    cpu->set_flag(ternary::flags::interrupt, 1);
+    cpu->step();
+    cpu->step();
+
+    bell.line.raise();
+    cpu->step();
+    BOOST_TEST(cpu->get_instruction_pointer().value() == handler);
+}
+
+BOOST_AUTO_TEST_CASE(instruction_after_pfi_always_runs)
+{
+    auto& bell { cpu->attach<Doorbell>() };
+    install_handler(bell.line.number());
+    program(origin, { inc(2, 1), zfi(), inc(2, 1), pfi(), inc(2, 1), inc(2, 1) });
+
+    // Interrupts were on, with a line pending, but not since the ZFI
+    cpu->set_flag(ternary::flags::interrupt, 1);
+    bell.line.raise();
+    cpu->step();
+    bell.line.lower();
+    cpu->step();
+    cpu->step();
+
+    bell.line.raise();
+    cpu->step();
+    BOOST_TEST(cpu->get_instruction_pointer().value() == origin + 12);
+
+    cpu->step();
+    BOOST_TEST(cpu->get_instruction_pointer().value() == handler);
+    BOOST_TEST(cpu->get_register(2).value() == 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "io.hpp"
+
+using ternary::Io;
+using ternary::RW;
+
+struct IoFixture
+{
+    Io io {};
+};
+
+BOOST_FIXTURE_TEST_SUITE(io, IoFixture)
+
+BOOST_AUTO_TEST_CASE(unbound_ports_keep_values)
+{
+    io.write(5, 1234);
+    io.write(-9841, -42);
+    io.write_binary(-1, 200);
+
+    BOOST_TEST(io.read(5).value() == 1234);
+    BOOST_TEST(io.read(-9841).value() == -42);
+    BOOST_TEST(io.read_binary(-1) == 200);
+
+    // Port numbers wrap around the 9-trit space
+    BOOST_TEST(io.read(5 + 19683).value() == 1234);
+    BOOST_TEST(io.read(6).value() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(handlers_take_over_ports)
+{
+    std::vector<int> written;
+    auto count { 0 };
+
+    BOOST_TEST(io.bind(-3, Io::write_handler_t { [&written](int v) { written.push_back(v); } }));
+    BOOST_TEST(io.bind(-3, Io::read_function { [](void* c, int) { return ++*static_cast<int*>(c); } }, &count));
+
+    // Only one handler in each direction
+    BOOST_TEST(!io.bind(-3, Io::write_handler_t { [](int) {} }));
+
+    io.write(-3, 7);
+    io.write_binary(-3, 8);
+
+    BOOST_TEST(io.read(-3).value() == 1);
+    BOOST_TEST(io.read_binary(-3) == 2);
+    BOOST_TEST((written == std::vector<int> { 7, 8 }));
+
+    // Without its handler, the port stores values again
+    io.unbind(-3, RW::write);
+    io.write(-3, 9);
+
+    BOOST_TEST(written.size() == 2u);
+    BOOST_TEST(io.bind(-3, Io::write_function { [](void* c, int, int v) { *static_cast<int*>(c) = v; } }, &count));
+
+    io.write(-3, 100);
+    BOOST_TEST(count == 100);
+}
+
+BOOST_AUTO_TEST_CASE(handlers_get_their_port)
+{
+    auto last { 0 };
+
+    BOOST_TEST(!io.bound(10, RW::read));
+
+    for (auto port = 10; port < 13; ++port)
+    {
+        BOOST_TEST(io.bind(port, Io::read_function { [](void* c, int p) { return *static_cast<int*>(c) = p; } }, &last));
+    }
+
+    BOOST_TEST(io.bound(10, RW::read));
+    BOOST_TEST(!io.bound(10, RW::write));
+
+    BOOST_TEST(io.read(11).value() == 11);
+    BOOST_TEST(last == 11);
+
+    // Aliases are wrapped into the port space
+    BOOST_TEST(io.read(12 - 19683).value() == 12);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,190 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <memory>
+
+#include "cpu.hpp"
+#include "jit.hpp"
+
+#include "test_program.hpp"
+
+using ternary::Cpu;
+
+using namespace test_program;
+
+struct JitFixture
+{
+    JitFixture()
+    {
+        for (auto c : { stepped.get(), compiled.get() })
+        {
+            c->reset();
+            c->set_instruction_pointer(origin);
+            c->set_memory_word(vector_table + 3 * invalid_opcode, handler);
+            c->set_memory_word(handler, brk());
+        }
+
+        compiled->set_execution_mode(ternary::execution_mode::jit);
+    }
+
+    ~JitFixture() = default;
+
+    // Put the same program in both CPUs
+    void program(std::initializer_list<int> words)
+    {
+        load({ stepped.get(), compiled.get() }, origin, words);
+    }
+
+    // Run both CPUs to a breakpoint, returning the instruction count
+    std::size_t run()
+    {
+        std::size_t steps { 1 };
+        std::size_t retired { 0 };
+
+        while (!stepped->step())
+        {
+            ++steps;
+        }
+
+        while (true)
+        {
+            const auto result { compiled->step_block() };
+            retired += result.retired;
+            longest = std::max(longest, result.retired);
+
+            if (result.breakpoint)
+            {
+                break;
+            }
+        }
+
+        BOOST_TEST(retired == steps);
+        return retired;
+    }
+
+    void check_same_state()
+    {
+        for (auto r = -13; r <= 13; ++r)
+        {
+            BOOST_TEST(stepped->get_register(r).value() == compiled->get_register(r).value());
+        }
+
+        BOOST_TEST(stepped->get_instruction_pointer().value() == compiled->get_instruction_pointer().value());
+    }
+
+    std::unique_ptr<Cpu> stepped { new Cpu() };
+    std::unique_ptr<Cpu> compiled { new Cpu() };
+
+    // Most instructions retired by any one call to step_block
+    std::size_t longest { 0 };
+
+    static constexpr int invalid_opcode { 4 };
+    static constexpr int handler { 4998 };
+    static constexpr int data { 299 };
+};
+
+BOOST_FIXTURE_TEST_SUITE(jit, JitFixture)
+
+BOOST_AUTO_TEST_CASE(hot_loop_matches_stepping)
+{
+    program({
+        ldi(1, 100),
+        ldi(2, 0),
+        // loop:
+        add(1, 2),
+        dec(1),
+        bps(-6),
+        brk()
+    });
+
+    BOOST_TEST(run() == 2 + 3 * 100 + 1);
+    check_same_state();
+    BOOST_TEST(compiled->get_register(2).value() == 5050);
+
+    // Once compiled, the loop runs to the end in native code
+    if (ternary::Jit::supported())
+    {
+        BOOST_TEST(longest > 3 * 16u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(loads_and_stores_match_stepping)
+{
+    program({
+        ldi(1, 40),
+        ldi(2, 0),
+        ldi(4, data),
+        // loop:
+        stw(1, 4),
+        ldw(5, 4),
+        add(5, 2),
+        inc(4, 3),
+        dec(1),
+        bps(-15),
+        brk()
+    });
+
+    run();
+    check_same_state();
+    BOOST_TEST(compiled->get_register(2).value() == 820);
+
+    for (auto i = 0; i < 40; ++i)
+    {
+        BOOST_TEST(compiled->get_memory_word(data + 3 * i).value() == 40 - i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(unsupported_instruction_ends_compiled_code)
+{
+    // SHR isn't compiled, so only the first two instructions of the
+    // loop run natively, and the interpreter does the rest
+    program({
+        ldi(1, 0),
+        // loop:
+        inc(1, 1),
+        mov(2, 1),
+        shr(2, 1),
+        cmi(1, 60),
+        bzs(6),
+        encode(10, 1, 0, 0, 0, -15),  // BRR loop
+        brk()
+    });
+
+    run();
+    check_same_state();
+    BOOST_TEST(compiled->get_register(1).value() == 60);
+    BOOST_TEST(compiled->get_register(2).value() == 20);
+}
+
+BOOST_AUTO_TEST_CASE(store_into_compiled_block_is_seen)
+{
+    // After the loop has been compiled and run, rewrite its LDI rC, 1
+    // as LDI rC, 7 and run it again: the new instruction must be used
+    stepped->set_reg(6, ldi(3, 7));
+    compiled->set_reg(6, ldi(3, 7));
+
+    program({
+        ldi(1, 30),
+        ldi(4, origin + 6),
+        // loop:
+        ldi(3, 1),
+        add(3, 2),
+        dec(1),
+        bps(-9),
+        // Second time through?
+        cmi(7, 0),
+        bzs(6),
+        brk(),
+        // Patch the loop and go again
+        stw(6, 4),
+        ldi(1, 30),
+        ldi(7, 1),
+        encode(10, -1, 0, 0, shift_right(-30, 3), low_trits(-30, 3))    // BRS loop
+    });
+
+    run();
+    check_same_state();
+    BOOST_TEST(compiled->get_register(2).value() == 30 * 1 + 30 * 7);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,123 @@
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+
+#include "cpu.hpp"
+#include "memory.hpp"
+#include "opcode.hpp"
+
+using ternary::AdvancedMemory;
+using ternary::Cpu;
+using ternary::Opcode;
+using ternary::architecture;
+using ternary::stop_reason;
+
+struct MemoryFixture
+{
+    static int encode(int o, int m, int t, int x, int y, int z)
+    {
+        return Opcode { o, m, t, x, y, z }.value.value();
+    }
+
+    // LDI rX, imm
+    static int ldi(int reg, int imm) { return encode(8, 0, 0, reg, shift_right(imm, 3), low_trits(imm, 3)); }
+    // STW rX, [rY]
+    static int stw(int src, int addr) { return encode(-10, 9, 0, 0, src, addr); }
+    static int brk() { return encode(0, -12, 0, 0, 0, 0); }
+
+    // Over a gigabyte if it were all there
+    std::unique_ptr<AdvancedMemory> memory { new AdvancedMemory() };
+
+    // Beyond the basic address space, and its 12-trit alias
+    static constexpr int high { 1000000 };
+    static constexpr int alias { -62882 };
+};
+
+BOOST_FIXTURE_TEST_SUITE(memory, MemoryFixture)
+
+BOOST_AUTO_TEST_CASE(pages_are_allocated_on_write)
+{
+    BOOST_TEST(memory->get_word(high).value() == 0);
+    BOOST_TEST(memory->peek(-193710244).get() == 0);
+    BOOST_TEST(memory->pages_used() == 0u);
+
+    memory->set_word(high, 123456);
+
+    BOOST_TEST(memory->pages_used() == 1u);
+    BOOST_TEST(memory->get_word(high).value() == 123456);
+    BOOST_TEST(memory->get_word(alias).value() == 0);
+
+    memory->clear();
+
+    BOOST_TEST(memory->pages_used() == 0u);
+    BOOST_TEST(memory->get_word(high).value() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(words_cross_pages)
+{
+    // Pages are 729 hexads, starting from the bottom of memory
+    const auto boundary { -193710244 + 729 };
+
+    memory->set_word(boundary - 1, -98765);
+
+    BOOST_TEST(memory->pages_used() == 2u);
+    BOOST_TEST(memory->get_word(boundary - 1).value() == -98765);
+    BOOST_TEST(memory->get(boundary - 1).get() == ternary::Word { -98765 }.low().get());
+
+    // And the top of memory wraps around to the bottom
+    memory->set_word(193710244, 4321);
+
+    BOOST_TEST(memory->get_word(193710244).value() == 4321);
+    BOOST_TEST(memory->get(-193710244).get() == ternary::Word { 4321 }.middle().get());
+}
+
+BOOST_AUTO_TEST_CASE(advanced_cpu_uses_full_addresses)
+{
+    for (auto a : { architecture::basic, architecture::advanced })
+    {
+        std::unique_ptr<Cpu> cpu { new Cpu(a) };
+
+        cpu->reset();
+        cpu->set_reg(4, high);
+        cpu->set_reg(1, 777);
+        cpu->set_memory_word(-1, stw(1, 4));
+        cpu->set_instruction_pointer(-1);
+        cpu->step();
+
+        // The basic architecture cuts the address down to 12 trits
+        const auto advanced { a == architecture::advanced };
+
+        BOOST_TEST(cpu->get_memory_word(high).value() == 777);
+        BOOST_TEST(cpu->get_memory_word(alias).value() == (advanced ? 0 : 777));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(advanced_cpu_runs_high_code)
+{
+    std::unique_ptr<Cpu> cpu { new Cpu(architecture::advanced) };
+    constexpr int origin { 5000000 };
+
+    cpu->reset();
+    cpu->set_memory_word(origin, ldi(1, 42));
+    cpu->set_memory_word(origin + 3, brk());
+
+    // Code at the alias mustn't be run (or cached) in its place
+    cpu->set_memory_word(low_trits(origin, 12), ldi(1, 5));
+    cpu->set_instruction_pointer(low_trits(origin, 12));
+    cpu->step();
+
+    cpu->set_instruction_pointer(origin);
+    cpu->set_breakpoint(origin + 3);
+
+    BOOST_TEST(cpu->has_breakpoint(origin + 3));
+    BOOST_TEST(!cpu->has_breakpoint(low_trits(origin + 3, 12)));
+
+    const auto result { cpu->run_for(100) };
+
+    BOOST_TEST((result.reason == stop_reason::breakpoint));
+    BOOST_TEST(cpu->get_register(1).value() == 42);
+    BOOST_TEST(cpu->get_instruction_pointer().value() == origin + 3);
+    BOOST_TEST((cpu->get_architecture() == architecture::advanced));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "word.hpp"
+#include "packed_word.hpp"
+
+using ternary::Word;
+using ternary::Hexad;
+using ternary::PackedWord;
+using ternary::MIN_WORD;
+using ternary::MAX_WORD;
+
+struct PackedWordFixture
+{
+    PackedWordFixture()
+    {
+        // Every hexad value in each position, plus a spread of full words
+        for (auto h = Hexad::min_value; h <= Hexad::max_value; ++h)
+        {
+            samples.emplace_back(h, 0, 0);
+            samples.emplace_back(0, h, 0);
+            samples.emplace_back(0, 0, h);
+        }
+
+        for (auto v = MIN_WORD.value(); v < MAX_WORD.value(); v += 1046527)
+        {
+            samples.emplace_back(v);
+        }
+
+        samples.push_back(MIN_WORD);
+        samples.push_back(MAX_WORD);
+    }
+
+    ~PackedWordFixture() = default;
+
+    std::vector<Word> samples;
+};
+
+BOOST_FIXTURE_TEST_SUITE(packed_word, PackedWordFixture)
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+    for (const auto& w : samples)
+    {
+        BOOST_TEST(PackedWord{w}.value() == w.value());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(trit_masks)
+{
+    // Identifiable pattern: +0-+0- in the low hexad
+    PackedWord p { Word { 224 } };
+
+    BOOST_TEST(p.positive() == 0x24u);
+    BOOST_TEST(p.negative() == 0x09u);
+    BOOST_TEST((p.positive() & p.negative()) == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(unary_operations_match_word)
+{
+    for (const auto& w : samples)
+    {
+        PackedWord p { w };
+
+        BOOST_TEST(sti(p).value() == ternary::sti(w).value());
+        BOOST_TEST(pti(p).value() == ternary::pti(w).value());
+        BOOST_TEST(nti(p).value() == ternary::nti(w).value());
+        BOOST_TEST(fdr(p).value() == ternary::fdr(w).value());
+        BOOST_TEST(rdr(p).value() == ternary::rdr(w).value());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(binary_operations_match_word)
+{
+    for (auto i = 0u; i < samples.size(); i += 7)
+    {
+        for (auto j = 0u; j < samples.size(); j += 11)
+        {
+            const auto& l { samples[i] };
+            const auto& r { samples[j] };
+            PackedWord pl { l };
+            PackedWord pr { r };
+
+            BOOST_TEST(min(pl, pr).value() == ternary::min(l, r).value());
+            BOOST_TEST(max(pl, pr).value() == ternary::max(l, r).value());
+            BOOST_TEST(teq(pl, pr).value() == ternary::teq(l, r).value());
+            BOOST_TEST(tem(pl, pr).value() == ternary::tem(l, r).value());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
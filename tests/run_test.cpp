@@ -0,0 +1,347 @@
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+
+#include "cpu.hpp"
+
+#include "test_program.hpp"
+
+using ternary::Cpu;
+using ternary::execution_mode;
+using ternary::stop_reason;
+using ternary::WatchHit;
+
+using namespace test_program;
+
+struct RunFixture
+{
+    RunFixture()
+    {
+        for (auto c : { reference.get(), cpu.get() })
+        {
+            c->reset();
+            c->set_instruction_pointer(origin);
+            c->set_memory_word(vector_table + 3 * invalid_opcode, handler);
+            c->set_memory_word(handler, brk());
+        }
+    }
+
+    ~RunFixture() = default;
+
+    // A loop that adds 100 down to 1 into rB, then stops
+    void sum_loop()
+    {
+        program({
+            ldi(1, 100),
+            ldi(2, 0),
+            // loop:
+            add(1, 2),
+            dec(1),
+            bps(-6),
+            brk()
+        });
+    }
+
+    void program(std::initializer_list<int> words)
+    {
+        load({ reference.get(), cpu.get() }, origin, words);
+    }
+
+    // Step the reference CPU a number of times, and compare
+    void check_after_steps(std::size_t steps)
+    {
+        for (auto i = 0u; i < steps; ++i)
+        {
+            reference->step();
+        }
+
+        for (auto r = -13; r <= 13; ++r)
+        {
+            BOOST_TEST(reference->get_register(r).value() == cpu->get_register(r).value());
+        }
+
+        BOOST_TEST(reference->get_instruction_pointer().value() == cpu->get_instruction_pointer().value());
+    }
+
+    std::unique_ptr<Cpu> reference { new Cpu() };
+    std::unique_ptr<Cpu> cpu { new Cpu() };
+
+    static constexpr int invalid_opcode { 4 };
+    static constexpr int handler { 4998 };
+    static constexpr int data { 299 };
+
+    static constexpr execution_mode modes[] { execution_mode::step, execution_mode::block, execution_mode::jit };
+};
+
+constexpr int RunFixture::handler;
+constexpr execution_mode RunFixture::modes[];
+
+BOOST_FIXTURE_TEST_SUITE(run, RunFixture)
+
+BOOST_AUTO_TEST_CASE(budget_is_exact)
+{
+    sum_loop();
+    cpu->set_execution_mode(execution_mode::jit);
+
+    // A budget that ends partway through the loop, once it's been compiled
+    const auto result { cpu->run_for(200) };
+
+    BOOST_TEST((result.reason == stop_reason::budget));
+    BOOST_TEST(result.retired == 200u);
+    check_after_steps(200);
+
+    // Then the rest
+    const auto rest { cpu->run_for(Cpu::unlimited) };
+
+    BOOST_TEST((rest.reason == stop_reason::halt));
+    BOOST_TEST(rest.retired == 2 + 3 * 100 + 1 - 200u);
+    BOOST_TEST(cpu->get_register(2).value() == 5050);
+}
+
+BOOST_AUTO_TEST_CASE(every_mode_stops_at_budget)
+{
+    sum_loop();
+    check_after_steps(0);
+
+    for (auto mode : modes)
+    {
+        cpu->reset();
+        cpu->set_instruction_pointer(origin);
+        cpu->set_execution_mode(mode);
+
+        for (auto i = 0; i < 7; ++i)
+        {
+            BOOST_TEST(cpu->run_for(41).retired == 41u);
+        }
+
+        BOOST_TEST(cpu->get_register(1).value() == 100 - (7 * 41 - 2) / 3);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(run_until_stops_at_address)
+{
+    sum_loop();
+    cpu->set_execution_mode(execution_mode::jit);
+
+    // The BPS at the end of the loop, the first time through
+    const auto result { cpu->run_until(origin + 12) };
+
+    BOOST_TEST((result.reason == stop_reason::target));
+    BOOST_TEST(result.retired == 4u);
+    check_after_steps(4);
+
+    // The instruction after the loop
+    const auto after { cpu->run_until(origin + 15) };
+
+    BOOST_TEST((after.reason == stop_reason::target));
+    BOOST_TEST(after.retired == 2 + 3 * 100 - 4u);
+    check_after_steps(2 + 3 * 100 - 4);
+}
+
+BOOST_AUTO_TEST_CASE(run_until_condition)
+{
+    sum_loop();
+
+    const auto result { cpu->run_until([](const Cpu& c) { return c.get_register(2).value() >= 1000; }) };
+
+    // 100 + 99 + ... + 90 = 1045
+    BOOST_TEST((result.reason == stop_reason::target));
+    BOOST_TEST(cpu->get_register(2).value() == 1045);
+    check_after_steps(result.retired);
+}
+
+BOOST_AUTO_TEST_CASE(interrupts_stop_only_when_asked)
+{
+    program({
+        ldi(1, 1),
+        encode(0, 0, 0, 0, 0, 0),   // undefined
+        ldi(1, 2),
+        brk()
+    });
+
+    const auto stopped { cpu->run_for(100, true) };
+
+    BOOST_TEST((stopped.reason == stop_reason::interrupt));
+    BOOST_TEST(stopped.retired == 2u);
+    BOOST_TEST(cpu->get_instruction_pointer().value() == handler);
+
+    cpu->set_instruction_pointer(origin);
+    const auto through { cpu->run_for(100) };
+
+    // The handler is just a BRK
+    BOOST_TEST((through.reason == stop_reason::halt));
+    BOOST_TEST(through.retired == 3u);
+}
+
+BOOST_AUTO_TEST_CASE(host_breakpoints_stop_before_instruction)
+{
+    sum_loop();
+    cpu->set_execution_mode(execution_mode::jit);
+
+    // Plenty of breakpoints that are never reached
+    for (auto a = 3002; a < 6002; a += 3)
+    {
+        cpu->set_breakpoint(a);
+    }
+
+    // DEC, inside the loop
+    cpu->set_breakpoint(origin + 9);
+
+    const auto first { cpu->run_for(Cpu::unlimited) };
+
+    BOOST_TEST((first.reason == stop_reason::breakpoint));
+    BOOST_TEST(first.retired == 3u);
+    check_after_steps(3);
+
+    // Starting at a breakpoint runs past it
+    for (auto i = 0; i < 20; ++i)
+    {
+        const auto again { cpu->run_for(Cpu::unlimited) };
+
+        BOOST_TEST((again.reason == stop_reason::breakpoint));
+        BOOST_TEST(again.retired == 3u);
+    }
+
+    check_after_steps(3 * 20);
+
+    cpu->clear_breakpoint(origin + 9);
+    BOOST_TEST(!cpu->has_breakpoint(origin + 9));
+
+    const auto rest { cpu->run_for(Cpu::unlimited) };
+
+    BOOST_TEST((rest.reason == stop_reason::halt));
+    BOOST_TEST(cpu->get_register(2).value() == 5050);
+}
+
+BOOST_AUTO_TEST_CASE(debug_registers_work_in_blocks)
+{
+    program({
+        ldi(1, 100),
+        ldi(2, 0),
+        ldi(3, origin + 15),
+        ssr_debug(3, 1),
+        // loop:
+        add(1, 2),
+        dec(1),
+        bps(-6),
+        brk()
+    });
+
+    for (auto c : { reference.get(), cpu.get() })
+    {
+        c->set_flag(ternary::flags::trap, 1);
+    }
+
+    std::size_t steps { 1 };
+
+    while (!reference->step())
+    {
+        ++steps;
+    }
+
+    const auto result { cpu->run_for(Cpu::unlimited) };
+
+    // DR1 holds the address of the DEC
+    BOOST_TEST((result.reason == stop_reason::breakpoint));
+    BOOST_TEST(result.retired == steps);
+    BOOST_TEST(steps == 6u);
+    check_after_steps(0);
+}
+
+BOOST_AUTO_TEST_CASE(write_watchpoint_stops_after_store)
+{
+    program({
+        ldi(1, 40),
+        ldi(4, data),
+        // loop:
+        stw(1, 4),
+        inc(4, 3),
+        dec(1),
+        bps(-9),
+        brk()
+    });
+
+    // The 11th store
+    const auto id { cpu->add_watchpoint({ data + 30, data + 32, ternary::watch_write }) };
+
+    for (auto i = 0; i < 2 + 10 * 4 + 1; ++i)
+    {
+        reference->step();
+    }
+
+    for (auto mode : modes)
+    {
+        cpu->reset();
+        cpu->set_instruction_pointer(origin);
+        cpu->set_execution_mode(mode);
+
+        // The host's writes don't count
+        cpu->set_memory_word(data + 30, 0);
+
+        const auto result { cpu->run_for(Cpu::unlimited) };
+
+        BOOST_TEST((result.reason == stop_reason::watchpoint));
+        BOOST_TEST(result.retired == 2 + 10 * 4 + 1u);
+        BOOST_TEST(cpu->get_instruction_pointer().value() == origin + 9);
+        BOOST_TEST(cpu->get_register(1).value() == reference->get_register(1).value());
+
+        BOOST_TEST(cpu->watch_hits().size() == 1u);
+        const auto& hit { cpu->watch_hits().front() };
+
+        BOOST_TEST(hit.id == id);
+        BOOST_TEST((hit.kind == ternary::watch_write));
+        BOOST_TEST(hit.ip == origin + 6);
+        BOOST_TEST(hit.address == data + 30);
+        BOOST_TEST(hit.length == 3);
+        BOOST_TEST(hit.old_value == 0);
+        BOOST_TEST(hit.new_value == 30);
+    }
+
+    // Without the watchpoint, it runs to the end
+    cpu->remove_watchpoint(id);
+    BOOST_TEST((cpu->run_for(Cpu::unlimited).reason == stop_reason::halt));
+}
+
+BOOST_AUTO_TEST_CASE(watchpoint_callbacks_can_continue)
+{
+    program({
+        ldi(1, 20),
+        ldi(3, 5),
+        ldi(4, data),
+        // loop:
+        stw(3, 4),
+        ldw(5, 4),
+        dec(1),
+        bps(-9),
+        brk()
+    });
+
+    auto changes { 0 };
+    auto reads { 0 };
+
+    // Only the first store changes anything; watch its low hexad
+    cpu->add_watchpoint({ data, data, ternary::watch_change,
+        [&changes](const WatchHit& hit) { ++changes; return hit.old_value != 0; } });
+    cpu->add_watchpoint({ data, data + 2, ternary::watch_read,
+        [&reads](const WatchHit&) { ++reads; return false; } });
+
+    // Nothing else is watched
+    cpu->add_watchpoint({ data + 3, data + 30, ternary::watch_read | ternary::watch_write });
+
+    cpu->set_execution_mode(execution_mode::jit);
+    const auto result { cpu->run_for(Cpu::unlimited) };
+
+    BOOST_TEST((result.reason == stop_reason::halt));
+    BOOST_TEST(result.retired == 3 + 4 * 20 + 1u);
+    BOOST_TEST(changes == 1);
+    BOOST_TEST(reads == 20);
+    BOOST_TEST(cpu->get_register(5).value() == 5);
+}
+
+BOOST_AUTO_TEST_CASE(watchpoint_range_is_checked)
+{
+    BOOST_CHECK_THROW(cpu->add_watchpoint({ 10, 5 }), std::out_of_range);
+    BOOST_CHECK_THROW(cpu->add_watchpoint({ 0, 265721 }), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,255 @@
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cpu.hpp"
+#include "device.hpp"
+#include "scheduler.hpp"
+#include "timer.hpp"
+
+#include "test_program.hpp"
+
+using ternary::Cpu;
+using ternary::IntervalTimer;
+using ternary::InterruptController;
+using ternary::Scheduler;
+using ternary::execution_mode;
+
+using namespace test_program;
+
+namespace
+{
+    // A device with an event pending, which it cancels when it's
+    // destroyed, noting whether the event was still there
+    class Sleeper final : public ternary::Device
+    {
+        public:
+        explicit Sleeper(bool& found): found_(found) {}
+
+        ~Sleeper()
+        {
+            found_ = scheduler_->scheduled(wake_);
+            scheduler_->cancel(wake_);
+        }
+
+        std::string name() const override { return "sleeper"; }
+        ternary::PortRange ports() const override { return { 300, 1 }; }
+
+        void set_scheduler(Scheduler& scheduler) override
+        {
+            scheduler_ = &scheduler;
+            wake_ = scheduler.schedule(1000, [] {});
+        }
+
+        private:
+        bool& found_;
+        Scheduler* scheduler_ { nullptr };
+        Scheduler::event_id wake_ { 0 };
+    };
+}
+
+struct SchedulerFixture
+{
+    SchedulerFixture()
+    {
+        cpu->reset();
+        cpu->set_instruction_pointer(origin);
+    }
+
+    void program(int address, std::initializer_list<int> words)
+    {
+        load({ cpu.get() }, address, words);
+    }
+
+    // Start the timer from the guest, with the handler counting its
+    // interrupts in rE, and spin
+    void count_ticks(int interval, int mode)
+    {
+        const auto vector { InterruptController::first_vector + cpu->get_timer().line().number() };
+        cpu->set_memory_word(vector_table + 3 * vector, handler);
+
+        program(origin, {
+            ldi(1, interval),
+            out(1, IntervalTimer::base_port + 1),
+            ldi(1, mode),
+            out(1, IntervalTimer::base_port),
+            pfi(),
+            // spin:
+            inc(2, 1),
+            brs(-3)
+        });
+
+        program(handler, { inc(5, 1), lsr(3, 3), pfi(), bri(3) });
+    }
+
+    Scheduler scheduler {};
+
+    std::unique_ptr<Cpu> cpu { new Cpu() };
+
+    static constexpr int handler { 4998 };
+};
+
+BOOST_FIXTURE_TEST_SUITE(scheduler, SchedulerFixture)
+
+BOOST_AUTO_TEST_CASE(events_run_in_order)
+{
+    std::vector<int> ran;
+
+    BOOST_TEST(scheduler.next_deadline() == Scheduler::never);
+
+    scheduler.schedule(10, [&ran]() { ran.push_back(2); });
+    scheduler.schedule(5, [&ran]() { ran.push_back(1); });
+    scheduler.schedule(10, [&ran]() { ran.push_back(3); });
+    const auto cancelled { scheduler.schedule(7, [&ran]() { ran.push_back(0); }) };
+
+    BOOST_TEST(scheduler.next_deadline() == 5u);
+    BOOST_TEST(scheduler.until_next() == 5u);
+
+    scheduler.cancel(cancelled);
+    BOOST_TEST(!scheduler.scheduled(cancelled));
+    BOOST_TEST(scheduler.size() == 3u);
+
+    scheduler.advance(4);
+    BOOST_TEST(ran.empty());
+
+    scheduler.advance(1);
+    BOOST_TEST((ran == std::vector<int> { 1 }));
+
+    // Past the cancelled one, and both due at 10, in order
+    scheduler.advance(20);
+    BOOST_TEST((ran == std::vector<int> { 1, 2, 3 }));
+    BOOST_TEST(scheduler.now() == 25u);
+    BOOST_TEST(scheduler.next_deadline() == Scheduler::never);
+}
+
+BOOST_AUTO_TEST_CASE(events_can_schedule_more)
+{
+    auto count { 0 };
+    std::function<void()> again;
+
+    again = [&]() {
+        if (++count < 3)
+        {
+            scheduler.schedule(0, again);
+        }
+    };
+
+    scheduler.schedule(2, again);
+    scheduler.advance(2);
+    BOOST_TEST(count == 1);
+
+    // A delay of 0 still waits for the next instruction
+    scheduler.advance(1);
+    BOOST_TEST(count == 2);
+    scheduler.advance(1);
+    BOOST_TEST(count == 3);
+    BOOST_TEST(scheduler.size() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(devices_can_cancel_events_when_destroyed)
+{
+    auto found { false };
+    cpu->attach(std::unique_ptr<ternary::Device> { new Sleeper(found) });
+
+    // The CPU's scheduler is still there while its devices are destroyed
+    cpu.reset();
+    BOOST_TEST(found);
+}
+
+BOOST_AUTO_TEST_CASE(timer_counts_instructions)
+{
+    auto& timer { cpu->get_timer() };
+
+    timer.start(IntervalTimer::one_shot, 50);
+    BOOST_TEST(timer.read(IntervalTimer::base_port + 2) == 50);
+
+    cpu->run_for(20);
+    BOOST_TEST(timer.count() == 30);
+    BOOST_TEST(!cpu->interrupt_line(timer.line().number()));
+
+    // It runs out on time, even in the middle of a block
+    cpu->run_for(30);
+    BOOST_TEST(cpu->interrupt_line(timer.line().number()));
+    BOOST_TEST(timer.mode() == IntervalTimer::stopped);
+    BOOST_TEST(cpu->get_scheduler().size() == 0u);
+
+    // Stopping leaves nothing behind
+    timer.start(IntervalTimer::periodic, 10);
+    const auto saved { timer.save() };
+    timer.stop();
+    BOOST_TEST(cpu->get_scheduler().size() == 0u);
+
+    timer.restore(saved);
+    BOOST_TEST(timer.mode() == IntervalTimer::periodic);
+    BOOST_TEST(timer.count() == 10);
+}
+
+BOOST_AUTO_TEST_CASE(periodic_timer_interrupts_the_guest)
+{
+    count_ticks(100, IntervalTimer::periodic);
+
+    for (const auto mode : { execution_mode::step, execution_mode::block, execution_mode::jit })
+    {
+        cpu->reset();
+        cpu->set_instruction_pointer(origin);
+        cpu->set_execution_mode(mode);
+        cpu->set_reg(5, 0);
+
+        cpu->run_for(1050);
+
+        BOOST_TEST(cpu->get_register(5).value() == 10);
+        BOOST_TEST(cpu->get_timer().mode() == IntervalTimer::periodic);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(timer_started_in_a_block_counts_from_there)
+{
+    const auto& timer { cpu->get_timer() };
+
+    // The ninth instruction starts the timer, in the middle of a block
+    program(origin, {
+        inc(2, 1),
+        inc(2, 1),
+        inc(2, 1),
+        inc(2, 1),
+        inc(2, 1),
+        ldi(1, 8),
+        out(1, IntervalTimer::base_port + 1),
+        ldi(1, -1),
+        out(1, IntervalTimer::base_port),
+        // spin:
+        inc(2, 1),
+        brs(-3)
+    });
+
+    for (const auto mode : { execution_mode::step, execution_mode::block, execution_mode::jit })
+    {
+        cpu->reset();
+        cpu->set_instruction_pointer(origin);
+        cpu->set_execution_mode(mode);
+
+        cpu->run_for(12);
+        BOOST_TEST(timer.count() == 4);
+        BOOST_TEST(!cpu->interrupt_line(timer.line().number()));
+
+        cpu->run_for(3);
+        BOOST_TEST(!cpu->interrupt_line(timer.line().number()));
+        cpu->run_for(1);
+        BOOST_TEST(cpu->interrupt_line(timer.line().number()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(one_shot_timer_interrupts_once)
+{
+    count_ticks(100, IntervalTimer::one_shot);
+    cpu->set_reg(5, 0);
+
+    cpu->run_for(1000);
+
+    BOOST_TEST(cpu->get_register(5).value() == 1);
+    BOOST_TEST(cpu->get_timer().mode() == IntervalTimer::stopped);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,54 @@
 
 #include "ternary_math.hpp"
 
+namespace
+{
+    constexpr int hexad_max { 364 };
+    constexpr int word_max { 193710244 };
+
+    // Count the values in [lo, hi] (stepping by _stride_) where
+    // the fixed-width functions disagree with the generic ones.
+    template<std::size_t Width>
+    long fixed_width_mismatches(long lo, long hi, long stride = 1)
+    {
+        long mismatches { 0 };
+
+        for (auto v = lo; v <= hi; v += stride)
+        {
+            const auto value { static_cast<int>(v) };
+
+            mismatches += shift_right<Width>(value) != shift_right(value, Width);
+            mismatches += low_trits<Width>(value) != low_trits(value, Width);
+            mismatches += nth_trit<Width>(value) != nth_trit(value, Width);
+        }
+
+        return mismatches;
+    }
+
+    // Every value in the hexad range, plus a sweep across the word
+    // range and a window around each place-value boundary in it.
+    template<std::size_t Width>
+    long fixed_width_check()
+    {
+        auto mismatches { fixed_width_mismatches<Width>(-hexad_max, hexad_max) };
+
+        mismatches += fixed_width_mismatches<Width>(-word_max, word_max, 101);
+
+        for (auto p = 1u; p <= 18; ++p)
+        {
+            const long half { pow3<long>(p) / 2 };
+
+            mismatches += fixed_width_mismatches<Width>(half - 400, half + 400);
+            mismatches += fixed_width_mismatches<Width>(-half - 400, -half + 400);
+        }
+
+        mismatches += fixed_width_mismatches<Width>(word_max - 1000, word_max);
+        mismatches += fixed_width_mismatches<Width>(-word_max, -word_max + 1000);
+
+        return mismatches;
+    }
+}
+
 BOOST_AUTO_TEST_SUITE(ternary_math)
 
 BOOST_AUTO_TEST_CASE(abs_test)
@@ -75,4 +123,24 @@ BOOST_AUTO_TEST_CASE(low_trits_test)
     BOOST_TEST(low_trits(tc3, 5) == 52);
 }
 
+BOOST_AUTO_TEST_CASE(fixed_width_test)
+{
+    auto tc4 { 52 };    // +-0-+
+    BOOST_TEST(shift_right<1>(tc4) == 17);
+    BOOST_TEST(low_trits<3>(tc4) == -2);
+    BOOST_TEST(nth_trit<3>(tc4) == -1);
+    BOOST_TEST(nth_trit<0>(-1) == lowest_trit(-1));
+}
+
+BOOST_AUTO_TEST_CASE(fixed_width_matches_generic)
+{
+    BOOST_TEST(fixed_width_check<1>() == 0);
+    BOOST_TEST(fixed_width_check<3>() == 0);
+    BOOST_TEST(fixed_width_check<4>() == 0);
+    BOOST_TEST(fixed_width_check<6>() == 0);
+    BOOST_TEST(fixed_width_check<9>() == 0);
+    BOOST_TEST(fixed_width_check<12>() == 0);
+    BOOST_TEST(fixed_width_check<18>() == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
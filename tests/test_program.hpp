@@ -0,0 +1,84 @@
+#ifndef TRIREME_TEST_PROGRAM_HPP
+#define TRIREME_TEST_PROGRAM_HPP
+
+#include <initializer_list>
+
+#include "cpu.hpp"
+#include "opcode.hpp"
+#include "ternary_math.hpp"
+
+// Instruction encoders and a program loader for the tests that run
+// guest code
+namespace test_program
+{
+    // A word-aligned address well away from the boot vectors
+    constexpr int origin { -1 };
+
+    // The interrupt vector table that reset() points CR2 to (%00ww0n)
+    constexpr int vector_table { -204121 };
+
+    // Encode an instruction from its fields
+    inline int encode(int o, int m, int t, int x, int y, int z)
+    {
+        return ternary::Opcode { o, m, t, x, y, z }.value.value();
+    }
+
+    // LDI rX, imm
+    inline int ldi(int reg, int imm) { return encode(8, 0, 0, reg, shift_right(imm, 3), low_trits(imm, 3)); }
+    // MOV rX, rY (copies rY into rX)
+    inline int mov(int dst, int src) { return encode(8, -1, 0, 0, dst, src); }
+    // STW rX, [rY] / LDW rX, [rY]
+    inline int stw(int src, int addr) { return encode(-10, 9, 0, 0, src, addr); }
+    inline int ldw(int dst, int addr) { return encode(8, 9, 0, 0, addr, dst); }
+
+    // ADD rX, rY (adds rX to rY)
+    inline int add(int src, int dst) { return encode(4, 9, 0, src, dst, dst); }
+    // INC rX, imm / DEC rX
+    inline int inc(int reg, int imm) { return encode(4, 11, reg, 0, 0, imm); }
+    inline int dec(int reg) { return encode(4, -8, reg, 0, 0, 1); }
+    // MUI rX, imm (multiplies rX by imm)
+    inline int mui(int reg, int imm) { return encode(2, -7, reg, 0, shift_right(imm, 3), low_trits(imm, 3)); }
+    // CMI rX, imm
+    inline int cmi(int reg, int imm) { return encode(1, -8, 0, reg, shift_right(imm, 3), low_trits(imm, 3)); }
+    // SHR rX, places
+    inline int shr(int reg, int places) { return encode(1, -13, 0, reg, 0, places); }
+
+    // BPS disp, BZS disp, BRS disp
+    inline int bps(int disp) { return encode(13, 1, 0, 0, 0, disp); }
+    inline int bzs(int disp) { return encode(12, 1, 0, 0, 0, disp); }
+    inline int brs(int disp) { return encode(10, 1, 0, 0, 0, disp); }
+    // BRI rX
+    inline int bri(int reg) { return encode(10, 3, 0, reg, 0, 0); }
+    // CAL addr, RET
+    inline int cal(int addr) { return encode(10, 0, 0, 0, shift_right(addr, 3), low_trits(addr, 3)); }
+    inline int ret() { return encode(10, -13, 0, 0, 0, 0); }
+    inline int brk() { return encode(0, -12, 0, 0, 0, 0); }
+
+    // INT @port, rX and OUT rX, @port
+    inline int low_port(int port) { return low_trits(shift_right(port, 3), 3); }
+    inline int in(int port, int reg) { return encode(-8, 1, reg, shift_right(port, 6), low_port(port), low_trits(port, 3)); }
+    inline int out(int reg, int port) { return encode(-8, -1, reg, shift_right(port, 6), low_port(port), low_trits(port, 3)); }
+
+    // PFI, which sets the I flag, and ZFI, which clears it
+    inline int pfi() { return encode(-6, 1, 0, 0, 0, 8); }
+    inline int zfi() { return encode(-6, 0, 0, 0, 0, 8); }
+    // LSR rX, CRn and SSR rX, DRn
+    inline int lsr(int reg, int cr) { return encode(0, 1, 0, reg, 0, cr); }
+    inline int ssr_debug(int reg, int n) { return encode(0, -1, 0, reg, 0, -n); }
+
+    // Put a program in each CPU's memory, starting at an address
+    inline void load(std::initializer_list<ternary::Cpu*> cpus, int address, std::initializer_list<int> words)
+    {
+        for (auto w : words)
+        {
+            for (auto c : cpus)
+            {
+                c->set_memory_word(address, w);
+            }
+
+            address += 3;
+        }
+    }
+}
+
+#endif /* TRIREME_TEST_PROGRAM_HPP */
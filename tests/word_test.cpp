@@ -0,0 +1,214 @@
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "word.hpp"
+#include "ternary_math.hpp"
+
+using ternary::Word;
+
+namespace
+{
+    // Values at and around the edges of each hexad and the whole word,
+    // where carries come from, plus a few in between
+    std::vector<int> carry_cases()
+    {
+        const auto half_word { pow3(18) / 2 };
+        std::vector<int> cases { 0, 1, 42, 123456789, half_word, half_word - 1 };
+
+        for (auto power : { 6u, 12u })
+        {
+            const auto half { pow3(power) / 2 };
+
+            for (auto v : { half - 1, half })
+            {
+                // Alone, and with every trit above it set
+                cases.push_back(v);
+                cases.push_back(v + half_word - half);
+            }
+
+            cases.push_back(half + 1);
+        }
+
+        // Everything, negated as well
+        const auto count { cases.size() };
+
+        for (auto i = 0u; i < count; ++i)
+        {
+            cases.push_back(-cases[i]);
+        }
+
+        return cases;
+    }
+}
+
+struct WordFixture
+{
+    WordFixture() = default;
+    ~WordFixture() = default;
+
+    // Identifiable pattern: +-0-+
+    Word tritPattern { 52 };
+
+    // Only the highest trit is set
+    Word highTrit { pow3(17) };
+
+    Word largeNegative { -123456789 };
+};
+
+BOOST_FIXTURE_TEST_SUITE(word, WordFixture)
+
+    BOOST_AUTO_TEST_SUITE(word_arithmetic_functions)
+
+    BOOST_AUTO_TEST_CASE(add_and_subtract)
+    {
+        auto r1 { add(tritPattern, largeNegative) };
+        BOOST_TEST(r1.first.value() == -123456737);
+        BOOST_TEST(r1.second == 0);
+
+        auto r2 { sub(largeNegative, highTrit) };
+        BOOST_TEST(r2.first.value() == -123456789 - pow3(17) + pow3(18));
+        BOOST_TEST(r2.second == -1);
+
+        auto r3 { add(ternary::MAX_WORD, 1) };
+        BOOST_TEST(r3.first.value() == ternary::MIN_WORD.value());
+        BOOST_TEST(r3.second == 1);
+
+        // Immediates outside the word range wrap first
+        auto r4 { add(tritPattern, pow3(18) + 1) };
+        BOOST_TEST(r4.first.value() == 53);
+        BOOST_TEST(r4.second == 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(add_matches_hexad_arithmetic)
+    {
+        const auto range { static_cast<long long>(pow3(18)) };
+
+        for (auto l : carry_cases())
+        {
+            for (auto r : carry_cases())
+            {
+                const Word lhs { l };
+                const Word rhs { r };
+
+                // Exact result: the sum wrapped into range, with the carry
+                const auto sum { static_cast<long long>(l) + r };
+                const auto carry { shift_right(sum, 18) };
+                const auto expected { sum - carry * range };
+
+                const auto a { add(lhs, rhs) };
+                const auto ah { add_by_hexads(lhs, rhs) };
+                BOOST_TEST(a.first.value() == expected);
+                BOOST_TEST(a.second == carry);
+                BOOST_TEST(ah.first.value() == expected);
+                BOOST_TEST(ah.second == carry);
+                BOOST_TEST(add(lhs, r).first.value() == expected);
+
+                const auto s { sub(lhs, rhs) };
+                const auto sh { sub_by_hexads(lhs, rhs) };
+                BOOST_TEST(s.first.value() == sh.first.value());
+                BOOST_TEST(s.second == sh.second);
+                BOOST_TEST(sub(lhs, r).second == sh.second);
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_SUITE_END()
+
+    BOOST_AUTO_TEST_SUITE(word_shift_functions)
+
+    BOOST_AUTO_TEST_CASE(shift_left)
+    {
+        auto r1 { shl(tritPattern, 1) };
+        BOOST_TEST(r1.first.value() == 156);
+        BOOST_TEST(r1.second == 0);
+
+        // The last trit shifted out is the carry
+        auto r2 { shl(highTrit, 1) };
+        BOOST_TEST(r2.first.value() == 0);
+        BOOST_TEST(r2.second == 1);
+
+        auto r3 { shl(tritPattern, 18) };
+        BOOST_TEST(r3.first.value() == 0);
+        BOOST_TEST(r3.second == 1);
+
+        auto r4 { shl(tritPattern, 19) };
+        BOOST_TEST(r4.first.value() == 0);
+        BOOST_TEST(r4.second == 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(shift_right)
+    {
+        auto r1 { shr(tritPattern, 2) };
+        BOOST_TEST(r1.first.value() == 6);
+        BOOST_TEST(r1.second == -1);
+
+        auto r2 { shr(highTrit, 17) };
+        BOOST_TEST(r2.first.value() == 1);
+        BOOST_TEST(r2.second == 0);
+
+        auto r3 { shr(highTrit, 18) };
+        BOOST_TEST(r3.first.value() == 0);
+        BOOST_TEST(r3.second == 1);
+    }
+
+    BOOST_AUTO_TEST_CASE(negative_places_are_out_of_range)
+    {
+        BOOST_TEST(shl(largeNegative, -4).first.value() == 0);
+        BOOST_TEST(shr(largeNegative, -4).first.value() == 0);
+        BOOST_TEST(rol(largeNegative, -4).first.value() == 0);
+        BOOST_TEST(ror(largeNegative, -4).first.value() == 0);
+        BOOST_TEST(rcl(largeNegative, 1, -4).first.value() == 0);
+        BOOST_TEST(rcr(largeNegative, 1, -4).second == 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(rotate)
+    {
+        auto r1 { rol(highTrit, 1) };
+        BOOST_TEST(r1.first.value() == 1);
+        BOOST_TEST(r1.second == 0);
+
+        auto r2 { ror(Word { 1 }, 1) };
+        BOOST_TEST(r2.first.value() == highTrit.value());
+
+        for (auto p = 0; p <= 18; ++p)
+        {
+            BOOST_TEST(ror(rol(largeNegative, p).first, p).first.value() == largeNegative.value());
+        }
+
+        BOOST_TEST(rol(largeNegative, 18).first.value() == largeNegative.value());
+    }
+
+    BOOST_AUTO_TEST_CASE(rotate_through_carry)
+    {
+        // The word rotates out into the carry...
+        auto r1 { rcl(highTrit, 0, 1) };
+        BOOST_TEST(r1.first.value() == 0);
+        BOOST_TEST(r1.second == 1);
+
+        auto r2 { rcr(tritPattern, 0, 1) };
+        BOOST_TEST(r2.first.value() == 17);
+        BOOST_TEST(r2.second == 1);
+
+        // ...but the carry passed in doesn't rotate into the word
+        auto r3 { rcl(Word { 0 }, 1, 1) };
+        BOOST_TEST(r3.first.value() == 0);
+        BOOST_TEST(r3.second == 0);
+
+        auto r4 { rcr(Word { 0 }, -1, 1) };
+        BOOST_TEST(r4.first.value() == 0);
+        BOOST_TEST(r4.second == 0);
+
+        // No places leaves the carry alone, and 19 is a full rotation
+        auto r5 { rcl(largeNegative, -1, 0) };
+        BOOST_TEST(r5.first.value() == largeNegative.value());
+        BOOST_TEST(r5.second == -1);
+
+        auto r6 { rcr(largeNegative, -1, 19) };
+        BOOST_TEST(r6.first.value() == largeNegative.value());
+        BOOST_TEST(r6.second == 0);
+    }
+
+    BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()